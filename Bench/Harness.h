@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#   define MATH_BENCH_TSC 1
+#endif
+
+// Minimal self-contained benchmark harness. Each case is timed in repeated batches; the fastest batch is reported.
+// Cycles come from the time-stamp counter, i.e. reference cycles at the nominal clock, not core cycles.
+namespace Bench {
+    template <class T>
+    inline void DoNotOptimize(T const& value) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static volatile const void* sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    inline std::uint64_t Cycles() noexcept {
+#if defined(MATH_BENCH_TSC)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    struct Result {
+        std::string Name;
+        double NsPerOp;
+        double OpsPerCycle;
+        std::uint64_t Ops;
+    };
+
+    class Runner {
+    public:
+        Runner(int argc, char** argv) {
+            for (auto i = 1; i<argc; ++i) {
+                if (!std::strcmp(argv[i], "--json") && i+1<argc) _Json = argv[++i];
+                else if (!std::strcmp(argv[i], "--filter") && i+1<argc) _Filter = argv[++i];
+                else if (!std::strcmp(argv[i], "--min-time") && i+1<argc) _MinTime = std::atof(argv[++i]);
+            }
+        }
+
+        // fn performs opsPerCall operations per invocation
+        template <class F>
+        void Run(const std::string& name, std::uint64_t opsPerCall, F&& fn) {
+            if (!_Filter.empty() && name.find(_Filter)==std::string::npos) return;
+            using Clock = std::chrono::steady_clock;
+            std::uint64_t calls = 1;
+            for (;;) {
+                const auto start = Clock::now();
+                for (auto i = 0u; i<calls; ++i) fn();
+                const auto elapsed = std::chrono::duration<double>(Clock::now()-start).count();
+                if (elapsed>=_MinTime/Repeats || calls>=(1ull << 40u)) break;
+                calls *= 2;
+            }
+            auto bestNs = 1e300, bestCycles = 1e300;
+            for (auto r = 0; r<Repeats; ++r) {
+                const auto start = Clock::now();
+                const auto c0 = Cycles();
+                for (auto i = 0u; i<calls; ++i) fn();
+                const auto c1 = Cycles();
+                const auto ns = std::chrono::duration<double, std::nano>(Clock::now()-start).count();
+                bestNs = std::min(bestNs, ns);
+                bestCycles = std::min(bestCycles, static_cast<double>(c1-c0));
+            }
+            const auto ops = static_cast<double>(calls*opsPerCall);
+            Result res{name, bestNs/ops, bestCycles>0 ? ops/bestCycles : 0.0, calls*opsPerCall};
+            std::printf("%-40s %10.3f ns/op %8.3f ops/cycle\n", res.Name.c_str(), res.NsPerOp, res.OpsPerCycle);
+            _Results.push_back(std::move(res));
+        }
+
+        int Finish() const {
+            if (_Json.empty()) return 0;
+            auto file = std::fopen(_Json.c_str(), "w");
+            if (!file) {
+                std::fprintf(stderr, "cannot write %s\n", _Json.c_str());
+                return 1;
+            }
+            std::fprintf(file, "{\n  \"benchmarks\": [\n");
+            for (auto i = 0u; i<_Results.size(); ++i) {
+                const auto& r = _Results[i];
+                std::fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.6f, \"ops_per_cycle\": %.6f, \"ops\": %llu}%s\n",
+                        r.Name.c_str(), r.NsPerOp, r.OpsPerCycle, static_cast<unsigned long long>(r.Ops),
+                        i+1<_Results.size() ? "," : "");
+            }
+            std::fprintf(file, "  ]\n}\n");
+            std::fclose(file);
+            return 0;
+        }
+    private:
+        static constexpr int Repeats = 5;
+        std::string _Json, _Filter;
+        double _MinTime = 0.05;
+        std::vector<Result> _Results;
+    };
+}
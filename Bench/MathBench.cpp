@@ -0,0 +1,162 @@
+#include <string>
+#include <memory>
+#include "Harness.h"
+#include "Math/Matrix.h"
+
+using namespace Math;
+
+namespace {
+    constexpr auto Batch = 64u;
+
+    template <class T>
+    T Operand(unsigned seed) noexcept { return static_cast<T>(1+(seed*2654435761u >> 28u)%3); }
+
+    template <size_t D, class T>
+    Vec<D, T> MakeVec(unsigned seed) noexcept {
+        Vec<D, T> ret{};
+        for (auto i = 0u; i<D; ++i) ret.Data[i] = Operand<T>(seed*7+i);
+        return ret;
+    }
+
+    template <class T, int R, int C>
+    Mat<T, R, C> MakeMat(unsigned seed) noexcept {
+        Mat<T, R, C> ret{};
+        for (auto i = 0; i<R; ++i)
+            for (auto j = 0; j<C; ++j) ret(i, j) = Operand<T>(seed*31+i*C+j);
+        return ret;
+    }
+
+    std::string Shape(int r, int c) { return std::to_string(r)+std::to_string(c); }
+
+    template <size_t D, class T>
+    void VecSuite(Bench::Runner& run, const std::string& type) {
+        Vec<D, T> a[Batch], b[Batch], out[Batch];
+        T dot[Batch];
+        for (auto i = 0u; i<Batch; ++i) {
+            a[i] = MakeVec<D, T>(i);
+            b[i] = MakeVec<D, T>(i+Batch);
+        }
+        const auto s = Operand<T>(5);
+        const auto name = "Vec"+std::to_string(D)+type+".";
+        run.Run(name+"Add", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) out[i] = a[i]+b[i];
+            Bench::DoNotOptimize(out);
+        });
+        run.Run(name+"Scale", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) out[i] = a[i]*s;
+            Bench::DoNotOptimize(out);
+        });
+        run.Run(name+"Dot", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) dot[i] = a[i].Dot(b[i]);
+            Bench::DoNotOptimize(dot);
+        });
+        if constexpr (D==3) {
+            run.Run(name+"Cross", Batch, [&] {
+                for (auto i = 0u; i<Batch; ++i) out[i] = a[i]*b[i];
+                Bench::DoNotOptimize(out);
+            });
+        }
+    }
+
+    template <class T, int R, int C, int Cr>
+    void MatMulCase(Bench::Runner& run, const std::string& type) {
+        Mat<T, R, C> a[Batch];
+        Mat<T, C, Cr> b[Batch];
+        Mat<T, R, Cr> out[Batch];
+        for (auto i = 0u; i<Batch; ++i) {
+            a[i] = MakeMat<T, R, C>(i);
+            b[i] = MakeMat<T, C, Cr>(i+Batch);
+        }
+        run.Run("Mat"+Shape(R, C)+type+".MulMat"+Shape(C, Cr), Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) out[i] = a[i]*b[i];
+            Bench::DoNotOptimize(out);
+        });
+    }
+
+    template <class T, int R, int C>
+    void MatSuite(Bench::Runner& run, const std::string& type) {
+        Mat<T, R, C> a[Batch], b[Batch], out[Batch];
+        Vec<C, T> v[Batch];
+        Vec<R, T> l[Batch], mv[Batch];
+        Vec<C, T> vm[Batch];
+        for (auto i = 0u; i<Batch; ++i) {
+            a[i] = MakeMat<T, R, C>(i);
+            b[i] = MakeMat<T, R, C>(i+Batch);
+            v[i] = MakeVec<C, T>(i);
+            l[i] = MakeVec<R, T>(i+Batch);
+        }
+        const auto s = Operand<T>(5);
+        const auto name = "Mat"+Shape(R, C)+type+".";
+        run.Run(name+"Add", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) out[i] = a[i]+b[i];
+            Bench::DoNotOptimize(out);
+        });
+        run.Run(name+"Scale", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) out[i] = a[i]*s;
+            Bench::DoNotOptimize(out);
+        });
+        run.Run(name+"MulVec", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) mv[i] = a[i]*v[i];
+            Bench::DoNotOptimize(mv);
+        });
+        run.Run(name+"VecMul", Batch, [&] {
+            for (auto i = 0u; i<Batch; ++i) vm[i] = l[i]*a[i];
+            Bench::DoNotOptimize(vm);
+        });
+        if constexpr (R>4 || C>4) {
+            MatMulCase<T, R, C, C>(run, type);
+        }
+        else {
+            MatMulCase<T, R, C, 2>(run, type);
+            MatMulCase<T, R, C, 3>(run, type);
+            MatMulCase<T, R, C, 4>(run, type);
+        }
+    }
+
+    // one product per call through the blocked Gemm
+    template <class T, int N>
+    void LargeMatMulCase(Bench::Runner& run, const std::string& type) {
+        const auto a = std::make_unique<Mat<T, N, N>>(MakeMat<T, N, N>(1));
+        const auto b = std::make_unique<Mat<T, N, N>>(MakeMat<T, N, N>(2));
+        const auto out = std::make_unique<Mat<T, N, N>>();
+        run.Run("Mat"+std::to_string(N)+type+".Gemm", 1, [&] {
+            *out = Gemm(*a, *b);
+            Bench::DoNotOptimize(*out);
+        });
+    }
+
+    template <class T>
+    void TypeSuite(Bench::Runner& run, const std::string& type) {
+        VecSuite<2, T>(run, type);
+        VecSuite<3, T>(run, type);
+        VecSuite<4, T>(run, type);
+        VecSuite<8, T>(run, type);
+        MatSuite<T, 2, 2>(run, type);
+        MatSuite<T, 2, 3>(run, type);
+        MatSuite<T, 2, 4>(run, type);
+        MatSuite<T, 3, 2>(run, type);
+        MatSuite<T, 3, 3>(run, type);
+        MatSuite<T, 3, 4>(run, type);
+        MatSuite<T, 4, 2>(run, type);
+        MatSuite<T, 4, 3>(run, type);
+        MatSuite<T, 4, 4>(run, type);
+        MatSuite<T, 8, 8>(run, type);
+    }
+}
+
+// usage: MathBench [--filter <substring>] [--json <file>] [--min-time <seconds>]
+int main(int argc, char** argv) {
+    Bench::Runner run(argc, argv);
+    TypeSuite<int>(run, "I");
+    TypeSuite<int8_t>(run, "B");
+    TypeSuite<int16_t>(run, "S");
+    TypeSuite<int32_t>(run, "L");
+    TypeSuite<int64_t>(run, "LL");
+    TypeSuite<float>(run, "F");
+    TypeSuite<double>(run, "D");
+    TypeSuite<long double>(run, "ED");
+    LargeMatMulCase<float, 64>(run, "F");
+    LargeMatMulCase<float, 256>(run, "F");
+    LargeMatMulCase<double, 256>(run, "D");
+    return run.Finish();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <limits>
+#include <algorithm>
+#include "Vector.h"
+
+namespace Math {
+    // Axis-aligned box with inclusive corners. A default-constructed box is empty (Min > Max on every axis),
+    // so Include and Merge can grow it from nothing.
+    template <class T>
+    struct AABB {
+        constexpr AABB() noexcept
+                :Min(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()),
+                 Max(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest()) { }
+        constexpr AABB(const Vec3<T>& min, const Vec3<T>& max) noexcept
+                :Min(min), Max(max) { }
+        constexpr explicit AABB(const Vec3<T>& point) noexcept
+                :Min(point), Max(point) { }
+
+        constexpr bool Empty() const noexcept {
+            return Min.Data[0]>Max.Data[0] || Min.Data[1]>Max.Data[1] || Min.Data[2]>Max.Data[2];
+        }
+        constexpr Vec3<T> Size() const noexcept { return Max-Min; }
+        constexpr Vec3<T> Center() const noexcept { return (Min+Max)/T(2); }
+
+        constexpr auto& Include(const Vec3<T>& point) noexcept {
+            for (auto a = 0; a<3; ++a) {
+                Min.Data[a] = std::min(Min.Data[a], point.Data[a]);
+                Max.Data[a] = std::max(Max.Data[a], point.Data[a]);
+            }
+            return *this;
+        }
+        constexpr auto& Merge(const AABB& box) noexcept {
+            for (auto a = 0; a<3; ++a) {
+                Min.Data[a] = std::min(Min.Data[a], box.Min.Data[a]);
+                Max.Data[a] = std::max(Max.Data[a], box.Max.Data[a]);
+            }
+            return *this;
+        }
+        // shrinks to the common part; the result is empty when the boxes are disjoint
+        constexpr auto& Intersect(const AABB& box) noexcept {
+            for (auto a = 0; a<3; ++a) {
+                Min.Data[a] = std::max(Min.Data[a], box.Min.Data[a]);
+                Max.Data[a] = std::min(Max.Data[a], box.Max.Data[a]);
+            }
+            return *this;
+        }
+        constexpr auto& Expand(const Vec3<T>& delta) noexcept {
+            for (auto a = 0; a<3; ++a) {
+                Min.Data[a] -= delta.Data[a];
+                Max.Data[a] += delta.Data[a];
+            }
+            return *this;
+        }
+
+        constexpr bool Overlaps(const AABB& box) const noexcept {
+            for (auto a = 0; a<3; ++a)
+                if (Min.Data[a]>box.Max.Data[a] || box.Min.Data[a]>Max.Data[a]) return false;
+            return true;
+        }
+        constexpr bool Contains(const Vec3<T>& point) const noexcept {
+            for (auto a = 0; a<3; ++a)
+                if (point.Data[a]<Min.Data[a] || point.Data[a]>Max.Data[a]) return false;
+            return true;
+        }
+        constexpr bool Contains(const AABB& box) const noexcept {
+            for (auto a = 0; a<3; ++a)
+                if (box.Min.Data[a]<Min.Data[a] || box.Max.Data[a]>Max.Data[a]) return false;
+            return true;
+        }
+
+        // 0 for an empty box
+        constexpr T SurfaceArea() const noexcept {
+            if (Empty()) return T(0);
+            const auto x = Extent(0), y = Extent(1), z = Extent(2);
+            return T(2)*(x*y+y*z+z*x);
+        }
+        constexpr T Volume() const noexcept { return Empty() ? T(0) : Extent(0)*Extent(1)*Extent(2); }
+        constexpr T Extent(int axis) const noexcept { return Max.Data[axis]-Min.Data[axis]; }
+        // index of the longest axis
+        constexpr int MajorAxis() const noexcept {
+            const auto x = Extent(0), y = Extent(1), z = Extent(2);
+            return x>=y ? (x>=z ? 0 : 2) : (y>=z ? 1 : 2);
+        }
+
+        constexpr bool operator==(const AABB& r) const noexcept { return Min==r.Min && Max==r.Max; }
+        constexpr bool operator!=(const AABB& r) const noexcept { return !(*this==r); }
+
+        Vec3<T> Min, Max;
+    };
+
+    template <class T>
+    constexpr AABB<T> Merge(AABB<T> a, const AABB<T>& b) noexcept { return a.Merge(b); }
+    template <class T>
+    constexpr AABB<T> Intersect(AABB<T> a, const AABB<T>& b) noexcept { return a.Intersect(b); }
+
+    using AABBI = AABB<int>;
+    using AABBF = AABB<float>;
+    using AABBD = AABB<double>;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <span>
+#include <algorithm>
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "Transform.h"
+#include "SIMD/CPU.h"
+
+namespace Math {
+    // Affine transform [L|t] stored as the top three rows of a 4x4 matrix whose implied bottom row is 0 0 0 1.
+    // Column-vector convention like Mat4: TransformPoint(p) == L * p + t, and (a * b) applies b first, then a.
+    template <class T>
+    class Affine3 {
+    public:
+        using DataType = T;
+
+        constexpr Affine3() noexcept
+                :_Stg(T(1), T(0), T(0), T(0), T(0), T(1), T(0), T(0), T(0), T(0), T(1), T(0)) { }
+        constexpr explicit Affine3(const Mat<T, 3, 4>& m) noexcept
+                :_Stg(m) { }
+        // drops the bottom row, which must be 0 0 0 1
+        constexpr explicit Affine3(const Mat<T, 4, 4>& m) noexcept
+                :_Stg(m[0], m[1], m[2]) { }
+        constexpr Affine3(const Mat<T, 3, 3>& linear, const Vec3<T>& translation) noexcept
+                :_Stg(linear(0, 0), linear(0, 1), linear(0, 2), translation.Data[0],
+                      linear(1, 0), linear(1, 1), linear(1, 2), translation.Data[1],
+                      linear(2, 0), linear(2, 1), linear(2, 2), translation.Data[2]) { }
+
+        constexpr static Affine3 Identity() noexcept { return {}; }
+        constexpr static Affine3 FromTranslation(const Vec3<T>& t) noexcept {
+            Affine3 ret;
+            ret.SetTranslation(t);
+            return ret;
+        }
+        constexpr static Affine3 FromScale(const Vec3<T>& s) noexcept {
+            return Affine3(Mat<T, 3, 4>(s.Data[0], T(0), T(0), T(0),
+                                        T(0), s.Data[1], T(0), T(0),
+                                        T(0), T(0), s.Data[2], T(0)));
+        }
+        constexpr static Affine3 FromRotation(const Quat<T>& q) noexcept { return {q.ToMat3(), Vec3<T>()}; }
+        // translate * rotate * scale: scales first, then rotates, then translates
+        constexpr static Affine3 FromTRS(const Vec3<T>& t, const Quat<T>& r, const Vec3<T>& s) noexcept {
+            auto m = r.ToMat3();
+            for (auto i = 0; i<3; ++i) {
+                m(i, 0) *= s.Data[0];
+                m(i, 1) *= s.Data[1];
+                m(i, 2) *= s.Data[2];
+            }
+            return {m, t};
+        }
+
+        constexpr T& operator()(int row, int col) noexcept { return _Stg[row].Data[col]; }
+        constexpr const T& operator()(int row, int col) const noexcept { return _Stg[row].Data[col]; }
+        constexpr const Mat<T, 3, 4>& AsMat34() const noexcept { return _Stg; }
+        constexpr Mat<T, 4, 4> ToMat4() const noexcept {
+            return {_Stg[0], _Stg[1], _Stg[2], Vec4<T>(T(0), T(0), T(0), T(1))};
+        }
+        constexpr Mat<T, 3, 3> Linear() const noexcept {
+            const auto& m = *this;
+            return {m(0, 0), m(0, 1), m(0, 2), m(1, 0), m(1, 1), m(1, 2), m(2, 0), m(2, 1), m(2, 2)};
+        }
+        constexpr Vec3<T> Translation() const noexcept {
+            return Vec3<T>(_Stg[0].Data[3], _Stg[1].Data[3], _Stg[2].Data[3]);
+        }
+        constexpr void SetTranslation(const Vec3<T>& t) noexcept {
+            for (auto i = 0; i<3; ++i) _Stg[i].Data[3] = t.Data[i];
+        }
+
+        constexpr bool operator==(const Affine3& r) const noexcept {
+            for (auto i = 0; i<3; ++i)
+                if (!(_Stg[i]==r._Stg[i])) return false;
+            return true;
+        }
+
+        // 36 multiplies and 27 adds against 64 and 48 for the equivalent Mat4 product
+        constexpr Affine3 operator*(const Affine3& r) const noexcept {
+            const auto& a = *this;
+            Affine3 ret;
+            for (auto i = 0; i<3; ++i) {
+                for (auto j = 0; j<4; ++j) ret(i, j) = a(i, 0)*r(0, j)+a(i, 1)*r(1, j)+a(i, 2)*r(2, j);
+                ret(i, 3) += a(i, 3);
+            }
+            return ret;
+        }
+        constexpr Affine3& operator*=(const Affine3& r) noexcept { return (*this = *this*r); }
+
+        constexpr Vec3<T> TransformPoint(const Vec3<T>& p) const noexcept {
+            const auto& m = *this;
+            return Vec3<T>(m(0, 0)*p.Data[0]+m(0, 1)*p.Data[1]+m(0, 2)*p.Data[2]+m(0, 3),
+                           m(1, 0)*p.Data[0]+m(1, 1)*p.Data[1]+m(1, 2)*p.Data[2]+m(1, 3),
+                           m(2, 0)*p.Data[0]+m(2, 1)*p.Data[1]+m(2, 2)*p.Data[2]+m(2, 3));
+        }
+        constexpr Vec3<T> TransformVector(const Vec3<T>& v) const noexcept {
+            const auto& m = *this;
+            return Vec3<T>(m(0, 0)*v.Data[0]+m(0, 1)*v.Data[1]+m(0, 2)*v.Data[2],
+                           m(1, 0)*v.Data[0]+m(1, 1)*v.Data[1]+m(1, 2)*v.Data[2],
+                           m(2, 0)*v.Data[0]+m(2, 1)*v.Data[1]+m(2, 2)*v.Data[2]);
+        }
+
+        constexpr T Determinant() const noexcept {
+            const auto& m = *this;
+            return m(0, 0)*(m(1, 1)*m(2, 2)-m(1, 2)*m(2, 1))+m(0, 1)*(m(1, 2)*m(2, 0)-m(1, 0)*m(2, 2))+
+                   m(0, 2)*(m(1, 0)*m(2, 1)-m(1, 1)*m(2, 0));
+        }
+        // [L^-1 | -L^-1 t]; singular transforms yield non-finite entries
+        constexpr Affine3 Inverse() const noexcept {
+            const auto& m = *this;
+            const T i00 = m(1, 1)*m(2, 2)-m(1, 2)*m(2, 1), i01 = m(0, 2)*m(2, 1)-m(0, 1)*m(2, 2),
+                    i02 = m(0, 1)*m(1, 2)-m(0, 2)*m(1, 1);
+            const T i10 = m(1, 2)*m(2, 0)-m(1, 0)*m(2, 2), i11 = m(0, 0)*m(2, 2)-m(0, 2)*m(2, 0),
+                    i12 = m(0, 2)*m(1, 0)-m(0, 0)*m(1, 2);
+            const T i20 = m(1, 0)*m(2, 1)-m(1, 1)*m(2, 0), i21 = m(0, 1)*m(2, 0)-m(0, 0)*m(2, 1),
+                    i22 = m(0, 0)*m(1, 1)-m(0, 1)*m(1, 0);
+            const T inv = T(1)/(m(0, 0)*i00+m(0, 1)*i10+m(0, 2)*i20);
+            const T tx = m(0, 3), ty = m(1, 3), tz = m(2, 3);
+            return Affine3(Mat<T, 3, 4>(
+                    i00*inv, i01*inv, i02*inv, -(i00*tx+i01*ty+i02*tz)*inv,
+                    i10*inv, i11*inv, i12*inv, -(i10*tx+i11*ty+i12*tz)*inv,
+                    i20*inv, i21*inv, i22*inv, -(i20*tx+i21*ty+i22*tz)*inv));
+        }
+    private:
+        Mat<T, 3, 4> _Stg;
+    };
+
+    using Affine3F = Affine3<float>;
+    using Affine3D = Affine3<double>;
+
+    namespace SIMD {
+        // out[i] = l[i * lStride] * r[i] over 12-float row-major transforms; lStride is 0 or 12
+        using ComposeAffineKernel = void (*)(const float*, size_t, const float*, float*, size_t) noexcept;
+
+        // r is copied so out may alias it; each row of l is read before that row of out is written. Staging the
+        // result in a local array instead makes GCC 12 -march=native emit a misaligned vmovdqa.
+        inline void ComposeAffineScalar(const float* l, size_t lStride, const float* r, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, l += lStride, r += 12, out += 12) {
+                float b[12];
+                std::copy_n(r, 12, b);
+                for (auto row = 0; row<3; ++row) {
+                    const float a0 = l[4*row], a1 = l[4*row+1], a2 = l[4*row+2], a3 = l[4*row+3];
+                    for (auto c = 0; c<4; ++c) out[4*row+c] = a0*b[c]+a1*b[4+c]+a2*b[8+c];
+                    out[4*row+3] += a3;
+                }
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        // row i of l * r is l(i, 0) * r0 + l(i, 1) * r1 + l(i, 2) * r2 + (0, 0, 0, l(i, 3))
+        inline void ComposeAffineSSE(const float* l, size_t lStride, const float* r, float* out, size_t n) noexcept {
+            const auto w = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+            for (auto i = size_t(0); i<n; ++i, l += lStride, r += 12, out += 12) {
+                const auto r0 = _mm_loadu_ps(r), r1 = _mm_loadu_ps(r+4), r2 = _mm_loadu_ps(r+8);
+                __m128 o[3];
+                for (auto row = 0; row<3; ++row) {
+                    const auto a = _mm_loadu_ps(l+4*row);
+                    o[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, 0x00), r0),
+                                                   _mm_mul_ps(_mm_shuffle_ps(a, a, 0x55), r1)),
+                                        _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, 0xAA), r2), _mm_and_ps(a, w)));
+                }
+                for (auto row = 0; row<3; ++row) _mm_storeu_ps(out+4*row, o[row]);
+            }
+        }
+
+        // rows 0 and 1 share one register, row 2 takes the low half of another
+        MATH_TARGET("avx2,fma")
+        inline void ComposeAffineAVX2(const float* l, size_t lStride, const float* r, float* out, size_t n) noexcept {
+            const auto w = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+            for (auto i = size_t(0); i<n; ++i, l += lStride, r += 12, out += 12) {
+                const auto r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r));
+                const auto r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r+4));
+                const auto r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r+8));
+                const auto a01 = _mm256_loadu_ps(l);
+                const auto a2 = _mm256_castps128_ps256(_mm_loadu_ps(l+8));
+                auto o01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0x00), r0, _mm256_and_ps(a01, w));
+                auto o2 = _mm256_fmadd_ps(_mm256_permute_ps(a2, 0x00), r0, _mm256_and_ps(a2, w));
+                o01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0x55), r1, o01);
+                o2 = _mm256_fmadd_ps(_mm256_permute_ps(a2, 0x55), r1, o2);
+                o01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xAA), r2, o01);
+                o2 = _mm256_fmadd_ps(_mm256_permute_ps(a2, 0xAA), r2, o2);
+                _mm256_storeu_ps(out, o01);
+                _mm_storeu_ps(out+8, _mm256_castps256_ps128(o2));
+            }
+        }
+#endif
+
+        inline ComposeAffineKernel SelectComposeAffine() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX2 && cpu.FMA) return &ComposeAffineAVX2;
+            return &ComposeAffineSSE;
+#else
+            return &ComposeAffineScalar;
+#endif
+        }
+    }
+
+    // Batched composition, out[i] = l[i] * r[i] over min(l.size(), r.size(), out.size()) elements. out may be the same
+    // span as l or r; otherwise it must not overlap them.
+    inline void Compose(std::span<const Affine3F> l, std::span<const Affine3F> r, std::span<Affine3F> out) noexcept {
+        static const auto kernel = SIMD::SelectComposeAffine();
+        kernel(reinterpret_cast<const float*>(l.data()), 12, reinterpret_cast<const float*>(r.data()),
+               reinterpret_cast<float*>(out.data()), std::min({l.size(), r.size(), out.size()}));
+    }
+    // out[i] = l * r[i], e.g. one parent with many children
+    inline void Compose(const Affine3F& l, std::span<const Affine3F> r, std::span<Affine3F> out) noexcept {
+        static const auto kernel = SIMD::SelectComposeAffine();
+        const auto copy = l;
+        kernel(reinterpret_cast<const float*>(&copy), 0, reinterpret_cast<const float*>(r.data()),
+               reinterpret_cast<float*>(out.data()), std::min(r.size(), out.size()));
+    }
+
+    template <class T>
+    void Compose(std::span<const Affine3<T>> l, std::span<const Affine3<T>> r, std::span<Affine3<T>> out) noexcept {
+        for (auto i = size_t(0); i<std::min({l.size(), r.size(), out.size()}); ++i) out[i] = l[i]*r[i];
+    }
+    template <class T>
+    void Compose(const Affine3<T>& l, std::span<const Affine3<T>> r, std::span<Affine3<T>> out) noexcept {
+        const auto copy = l;
+        for (auto i = size_t(0); i<std::min(r.size(), out.size()); ++i) out[i] = copy*r[i];
+    }
+
+    // The batched Transform.h kernels with the implied bottom row
+    inline void TransformPoints(const Affine3F& m, std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        TransformPoints(m.ToMat4(), in, out);
+    }
+    inline void TransformVectors(const Affine3F& m, std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        TransformVectors(m.ToMat4(), in, out);
+    }
+}
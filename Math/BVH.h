@@ -0,0 +1,379 @@
+#pragma once
+
+#include <span>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "AABB.h"
+#include "Parallel.h"
+
+namespace Math {
+    // Flattened BVH node. Interior nodes (Count == 0) keep their two children at Offset and Offset+1;
+    // leaves own Count primitives starting at Offset in BVH::Indices().
+    struct alignas(32) BVHNode {
+        Vec3F Min;
+        uint32_t Offset;
+        Vec3F Max;
+        uint32_t Count;
+
+        bool Leaf() const noexcept { return Count!=0; }
+        AABBF Bounds() const noexcept { return {Min, Max}; }
+    };
+    static_assert(sizeof(BVHNode)==32, "BVHNode must stay 32 bytes");
+
+    struct BVHHit {
+        uint32_t Index = ~0u;
+        float T = std::numeric_limits<float>::infinity();
+        explicit operator bool() const noexcept { return Index!=~0u; }
+    };
+
+    // Bounding volume hierarchy over a fixed array of boxes, identified by their index in that array.
+    // Build uses 16-bin SAH splits along the widest axis of each node's centres. It processes the tree one level at
+    // a time, with every node of a level in parallel on the default thread pool, and the result does not depend on
+    // the thread count. Children always follow their parent in the node array, so Refit can update moved boxes with
+    // one reverse pass instead of a rebuild.
+    class BVH {
+    public:
+        BVH() noexcept = default;
+        explicit BVH(std::span<const AABBF> bounds, uint32_t maxLeafSize = 4) { Build(bounds, maxLeafSize); }
+
+        bool Empty() const noexcept { return _Nodes.empty(); }
+        // number of primitives
+        size_t Size() const noexcept { return _Indices.size(); }
+        std::span<const BVHNode> Nodes() const noexcept { return _Nodes; }
+        std::span<const uint32_t> Indices() const noexcept { return _Indices; }
+        AABBF Bounds() const noexcept { return _Nodes.empty() ? AABBF() : _Nodes[0].Bounds(); }
+
+        void Clear() noexcept {
+            _Nodes.clear();
+            _Indices.clear();
+            _Bounds.clear();
+        }
+
+        void Build(std::span<const AABBF> bounds, uint32_t maxLeafSize = 4) {
+            Clear();
+            const auto count = uint32_t(bounds.size());
+            if (!count) return;
+            maxLeafSize = std::max(maxLeafSize, 1u);
+            // the builder partitions copies of the boxes so every pass over a node reads memory in order
+            std::vector<Prim> prims(count);
+            Parallel::For(0, count, Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i)
+                    prims[i] = {bounds[i], uint32_t(i)};
+            });
+            _Nodes.reserve(size_t(2)*count);
+            _Nodes.emplace_back();
+            Builder builder{prims, maxLeafSize};
+            std::vector<Task> level{builder.Root(count)}, next;
+            std::vector<Split> splits;
+            while (!level.empty()) {
+                splits.resize(level.size());
+                Parallel::DefaultPool().For(level.size(), [&](size_t i) { splits[i] = builder.Plan(level[i]); });
+                next.clear();
+                for (auto i = size_t(0); i<level.size(); ++i) {
+                    const auto& t = level[i];
+                    const auto& s = splits[i];
+                    auto& node = _Nodes[t.Node];
+                    node.Min = t.Bounds.Min;
+                    node.Max = t.Bounds.Max;
+                    if (s.Left==0) {
+                        node.Offset = t.First;
+                        node.Count = t.Count;
+                        continue;
+                    }
+                    const auto child = uint32_t(_Nodes.size());
+                    node.Offset = child;
+                    node.Count = 0;
+                    _Nodes.emplace_back();
+                    _Nodes.emplace_back();
+                    next.push_back({child, t.First, s.Left, t.Depth+1, s.Bounds[0], s.Centres[0]});
+                    next.push_back({child+1, t.First+s.Left, t.Count-s.Left, t.Depth+1, s.Bounds[1], s.Centres[1]});
+                }
+                level.swap(next);
+            }
+            _Indices.resize(count);
+            _Bounds.resize(count);
+            Parallel::For(0, count, Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i) {
+                    _Indices[i] = prims[i].Index;
+                    _Bounds[i] = prims[i].Bounds;
+                }
+            });
+        }
+
+        // Updates every node for new primitive bounds, given in the same order and number as at Build.
+        // Tree quality degrades as objects drift from their build positions; rebuild when queries slow down.
+        void Refit(std::span<const AABBF> bounds) {
+            if (_Nodes.empty() || bounds.size()!=_Indices.size()) return;
+            Parallel::For(0, _Indices.size(), Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i) _Bounds[i] = bounds[_Indices[i]];
+            });
+            Parallel::For(0, _Nodes.size(), Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i) {
+                    auto& node = _Nodes[i];
+                    if (!node.Leaf()) continue;
+                    AABBF box;
+                    for (auto p = node.Offset; p<node.Offset+node.Count; ++p) box.Merge(_Bounds[p]);
+                    node.Min = box.Min;
+                    node.Max = box.Max;
+                }
+            });
+            for (auto i = _Nodes.size(); i-->0;) {
+                auto& node = _Nodes[i];
+                if (node.Leaf()) continue;
+                const auto box = Merge(_Nodes[node.Offset].Bounds(), _Nodes[node.Offset+1].Bounds());
+                node.Min = box.Min;
+                node.Max = box.Max;
+            }
+        }
+
+        // Calls fn(index) for every primitive whose box overlaps box
+        template <class F>
+        void ForEachOverlap(const AABBF& box, F&& fn) const {
+            if (_Nodes.empty()) return;
+            uint32_t stack[StackSize];
+            auto top = 0u;
+            stack[top++] = 0;
+            while (top) {
+                const auto& node = _Nodes[stack[--top]];
+                if (!box.Overlaps(node.Bounds())) continue;
+                if (node.Leaf()) {
+                    for (auto p = node.Offset; p<node.Offset+node.Count; ++p)
+                        if (box.Overlaps(_Bounds[p])) fn(_Indices[p]);
+                }
+                else {
+                    stack[top++] = node.Offset+1;
+                    stack[top++] = node.Offset;
+                }
+            }
+        }
+
+        // Calls fn(index, tEnter) for every primitive whose box the ray origin + t * dir enters within [0, tMax].
+        // fn returns the new tMax (its exact hit distance, or the tMax it was given to keep everything); boxes
+        // beyond it are skipped. The nearer child is visited first, so an early small tMax prunes most of the tree.
+        template <class F>
+        void ForEachHit(const Vec3F& origin, const Vec3F& dir, float tMax, F&& fn) const {
+            if (_Nodes.empty()) return;
+            const Slab ray(origin, dir);
+            uint32_t stack[StackSize];
+            auto top = 0u;
+            float t;
+            if (!ray.Hit(_Nodes[0].Min, _Nodes[0].Max, tMax, t)) return;
+            stack[top++] = 0;
+            while (top) {
+                const auto& node = _Nodes[stack[--top]];
+                if (node.Leaf()) {
+                    for (auto p = node.Offset; p<node.Offset+node.Count; ++p)
+                        if (ray.Hit(_Bounds[p].Min, _Bounds[p].Max, tMax, t)) tMax = std::min(tMax, float(fn(_Indices[p], t)));
+                    continue;
+                }
+                const auto& l = _Nodes[node.Offset];
+                const auto& r = _Nodes[node.Offset+1];
+                float tl, tr;
+                const auto hl = ray.Hit(l.Min, l.Max, tMax, tl), hr = ray.Hit(r.Min, r.Max, tMax, tr);
+                if (hl && hr) {
+                    const auto nearLeft = tl<=tr;
+                    stack[top++] = nearLeft ? node.Offset+1 : node.Offset;
+                    stack[top++] = nearLeft ? node.Offset : node.Offset+1;
+                }
+                else if (hl) stack[top++] = node.Offset;
+                else if (hr) stack[top++] = node.Offset+1;
+            }
+        }
+
+        // nearest primitive box entered by the ray within [0, tMax]; a ray starting inside a box hits it at 0
+        BVHHit Raycast(const Vec3F& origin, const Vec3F& dir, float tMax = std::numeric_limits<float>::infinity()) const {
+            BVHHit hit;
+            ForEachHit(origin, dir, tMax, [&hit](uint32_t index, float t) noexcept {
+                if (t<hit.T) hit = {index, t};
+                return hit.T;
+            });
+            return hit;
+        }
+    private:
+        static constexpr uint32_t Bins = 16;
+        static constexpr uint32_t SAHMaxDepth = 40;
+        // SAH depth cap plus median splits below it stay under this for up to 2^32 primitives
+        static constexpr uint32_t StackSize = SAHMaxDepth+40;
+        static constexpr size_t Grain = 16384;
+
+        struct alignas(16) Prim {
+            AABBF Bounds;
+            uint32_t Index;
+
+            // doubled centre; only relative positions matter for binning
+            float Centre(int axis) const noexcept { return Bounds.Min.Data[axis]+Bounds.Max.Data[axis]; }
+            Vec3F Centre() const noexcept { return Bounds.Min+Bounds.Max; }
+        };
+
+        struct Task {
+            uint32_t Node, First, Count, Depth;
+            AABBF Bounds, Centres;
+        };
+
+        // Left == 0 makes a leaf
+        struct Split {
+            uint32_t Left = 0;
+            AABBF Bounds[2], Centres[2];
+        };
+
+        struct Bin {
+            AABBF Bounds;
+            uint32_t Count = 0;
+
+            void Add(const Bin& b) noexcept {
+                Bounds.Merge(b.Bounds);
+                Count += b.Count;
+            }
+        };
+
+        struct Extent {
+            AABBF Bounds, Centres;
+
+            void Add(const Extent& e) noexcept {
+                Bounds.Merge(e.Bounds);
+                Centres.Merge(e.Centres);
+            }
+        };
+
+        struct BinSet {
+            Bin Bins[BVH::Bins];
+
+            void Add(const BinSet& b) noexcept { for (auto i = 0u; i<BVH::Bins; ++i) Bins[i].Add(b.Bins[i]); }
+        };
+
+        class Builder {
+        public:
+            Builder(std::vector<Prim>& prims, uint32_t maxLeaf) noexcept : _Prims(prims), _MaxLeaf(maxLeaf) { }
+
+            Task Root(uint32_t count) const {
+                Extent total;
+                ForChunks(0, count, [&](uint32_t b, uint32_t e, Extent& acc) {
+                    for (auto i = b; i<e; ++i) {
+                        acc.Bounds.Merge(_Prims[i].Bounds);
+                        acc.Centres.Include(_Prims[i].Centre());
+                    }
+                }, total);
+                return {0, 0, count, 0, total.Bounds, total.Centres};
+            }
+
+            // Picks the split of a node and partitions its range accordingly. Nodes above the leaf size always split,
+            // at the cheapest of the 15 bin boundaries along the widest centre axis by count * surface area.
+            Split Plan(const Task& t) const {
+                Split ret;
+                if (t.Count<=_MaxLeaf) return ret;
+                const auto axis = t.Centres.MajorAxis();
+                const auto extent = t.Centres.Extent(axis);
+                if (t.Depth>=SAHMaxDepth || !(extent>0.0f)) return Median(t, axis);
+                const auto origin = t.Centres.Min.Data[axis], scale = float(Bins)/extent;
+                const auto binOf = [=](const Prim& p) noexcept {
+                    return std::min(Bins-1, uint32_t((p.Centre(axis)-origin)*scale));
+                };
+                BinSet bins;
+                ForChunks(t.First, t.First+t.Count, [&](uint32_t b, uint32_t e, BinSet& acc) {
+                    for (auto i = b; i<e; ++i) {
+                        const auto& p = _Prims[i];
+                        auto& bin = acc.Bins[binOf(p)];
+                        bin.Bounds.Merge(p.Bounds);
+                        ++bin.Count;
+                    }
+                }, bins);
+                // sweep from the right, then from the left, costing count * area on both sides
+                float rightCost[Bins];
+                Bin right;
+                for (auto b = Bins-1; b>0; --b) {
+                    right.Add(bins.Bins[b]);
+                    rightCost[b] = float(right.Count)*right.Bounds.SurfaceArea();
+                }
+                auto bestCost = std::numeric_limits<float>::max();
+                auto bestBin = 0u;
+                Bin left;
+                for (auto b = 1u; b<Bins; ++b) {
+                    left.Add(bins.Bins[b-1]);
+                    if (!left.Count || left.Count==t.Count) continue;
+                    const auto cost = float(left.Count)*left.Bounds.SurfaceArea()+rightCost[b];
+                    if (cost<bestCost) bestCost = cost, bestBin = b;
+                }
+                if (!bestBin) return Median(t, axis);
+                for (auto b = 0u; b<Bins; ++b) {
+                    ret.Bounds[b<bestBin ? 0 : 1].Merge(bins.Bins[b].Bounds);
+                    if (b<bestBin) ret.Left += bins.Bins[b].Count;
+                }
+                const auto begin = _Prims.begin()+t.First;
+                std::partition(begin, begin+t.Count, [&](const Prim& p) { return binOf(p)<bestBin; });
+                for (auto i = 0u; i<t.Count; ++i) ret.Centres[i<ret.Left ? 0 : 1].Include(begin[i].Centre());
+                return ret;
+            }
+        private:
+            // object median along the widest centre axis; bounds both halves with a pass over them
+            Split Median(const Task& t, int axis) const {
+                Split ret;
+                const auto begin = _Prims.begin()+t.First;
+                ret.Left = t.Count/2;
+                std::nth_element(begin, begin+ret.Left, begin+t.Count, [axis](const Prim& l, const Prim& r) {
+                    return l.Centre(axis)<r.Centre(axis);
+                });
+                for (auto i = 0u; i<t.Count; ++i) {
+                    const auto side = i<ret.Left ? 0 : 1;
+                    ret.Bounds[side].Merge(begin[i].Bounds);
+                    ret.Centres[side].Include(begin[i].Centre());
+                }
+                return ret;
+            }
+
+            // Runs fn(begin, end, acc) over chunks of [first, last) and merges the per-chunk accumulators into acc
+            // in chunk order. Large ranges are split across the default pool; inside a parallel level the pool is
+            // busy and the chunks simply run on the calling thread.
+            template <class F, class A>
+            static void ForChunks(uint32_t first, uint32_t last, F&& fn, A& acc) {
+                const auto count = last-first;
+                const auto chunks = std::min<size_t>(count/Grain, Parallel::DefaultPool().Concurrency()*2);
+                if (chunks<2) {
+                    fn(first, last, acc);
+                    return;
+                }
+                std::vector<A> partial(chunks);
+                const auto step = uint32_t((count+chunks-1)/chunks);
+                Parallel::DefaultPool().For(chunks, [&](size_t c) {
+                    const auto b = first+uint32_t(c)*step;
+                    fn(b, std::min(last, b+step), partial[c]);
+                });
+                for (auto& p : partial) acc.Add(p);
+            }
+
+            std::vector<Prim>& _Prims;
+            uint32_t _MaxLeaf;
+        };
+
+        // ray prepared for slab tests; axes with a zero direction produce NaNs that the min/max order ignores
+        class Slab {
+        public:
+            Slab(const Vec3F& origin, const Vec3F& dir) noexcept {
+                for (auto a = 0; a<3; ++a) {
+                    _Origin[a] = origin.Data[a];
+                    _Inverse[a] = 1.0f/dir.Data[a];
+                }
+            }
+
+            bool Hit(const Vec3F& min, const Vec3F& max, float tMax, float& tEnter) const noexcept {
+                auto t0 = 0.0f, t1 = tMax;
+                for (auto a = 0; a<3; ++a) {
+                    auto n = (min.Data[a]-_Origin[a])*_Inverse[a], f = (max.Data[a]-_Origin[a])*_Inverse[a];
+                    if (n>f) std::swap(n, f);
+                    t0 = std::max(t0, n);
+                    t1 = std::min(t1, f);
+                }
+                tEnter = t0;
+                return t0<=t1;
+            }
+        private:
+            float _Origin[3], _Inverse[3];
+        };
+
+        std::vector<BVHNode> _Nodes;
+        std::vector<uint32_t> _Indices;
+        // primitive boxes in leaf order, _Bounds[i] belongs to _Indices[i]
+        std::vector<AABBF> _Bounds;
+    };
+}
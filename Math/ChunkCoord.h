@@ -0,0 +1,157 @@
+#pragma once
+
+#include <span>
+#include <algorithm>
+#include "Vector.h"
+#include "SIMD/CPU.h"
+#include "SIMD/I32x8.h"
+
+// Splitting integer world coordinates into chunk and local coordinates for chunks of 2^shift cells per axis:
+//   FloorDivPow2(v, s)   floor(v / 2^s), an arithmetic shift
+//   ModPow2(v, s)        v - FloorDivPow2(v, s) * 2^s, always in [0, 2^s)
+// Both round towards negative infinity, so -1 lies in chunk -1 at local 2^s - 1. Shifts must be in [0, 31).
+// The span overloads over Vec3I pick an AVX2 kernel once per process where the CPU has it, otherwise they run eight
+// records at a time through SIMD::I32x8 at the build's SIMD level; in and out may be the same span, otherwise they
+// must not overlap, and min(in.size(), out.size()) elements are written.
+namespace Math {
+    template <size_t D>
+    constexpr Vec<D, int> FloorDivPow2(const Vec<D, int>& v, const Vec<D, int>& shift) noexcept {
+        Vec<D, int> ret{VectorUninitialized};
+        for (auto i = size_t(0); i<D; ++i) ret.Data[i] = v.Data[i] >> shift.Data[i];
+        return ret;
+    }
+    template <size_t D>
+    constexpr Vec<D, int> FloorDivPow2(const Vec<D, int>& v, int shift) noexcept {
+        Vec<D, int> ret{VectorUninitialized};
+        for (auto i = size_t(0); i<D; ++i) ret.Data[i] = v.Data[i] >> shift;
+        return ret;
+    }
+    template <size_t D>
+    constexpr Vec<D, int> ModPow2(const Vec<D, int>& v, const Vec<D, int>& shift) noexcept {
+        Vec<D, int> ret{VectorUninitialized};
+        for (auto i = size_t(0); i<D; ++i) ret.Data[i] = v.Data[i] & ((1 << shift.Data[i])-1);
+        return ret;
+    }
+    template <size_t D>
+    constexpr Vec<D, int> ModPow2(const Vec<D, int>& v, int shift) noexcept {
+        Vec<D, int> ret{VectorUninitialized};
+        for (auto i = size_t(0); i<D; ++i) ret.Data[i] = v.Data[i] & ((1 << shift)-1);
+        return ret;
+    }
+
+    struct ChunkLocal {
+        Vec3I Chunk, Local;
+    };
+    constexpr ChunkLocal SplitChunkLocal(const Vec3I& world, const Vec3I& shift) noexcept {
+        return {FloorDivPow2(world, shift), ModPow2(world, shift)};
+    }
+    constexpr ChunkLocal SplitChunkLocal(const Vec3I& world, int shift) noexcept {
+        return {FloorDivPow2(world, shift), ModPow2(world, shift)};
+    }
+
+    namespace SIMD {
+        // n records of three ints; a null chunk or local skips that output
+        using ChunkSplitKernel = void (*)(const int* in, const Vec3I& shift, int* chunk, int* local, size_t n) noexcept;
+
+        inline void ChunkSplitScalar(const int* in, const Vec3I& shift, int* chunk, int* local, size_t n) noexcept {
+            const auto mask = Vec3I((1 << shift.X)-1, (1 << shift.Y)-1, (1 << shift.Z)-1);
+            for (auto i = size_t(0); i<n*3; i += 3)
+                for (auto a = 0; a<3; ++a) {
+                    const auto v = in[i+a];
+                    if (chunk) chunk[i+a] = v >> shift.Data[a];
+                    if (local) local[i+a] = v & mask.Data[a];
+                }
+        }
+
+        // Eight records per step: Load3 splits them into one register per axis, so every axis is a uniform shift
+        // and mask. I32x8 compiles to AVX2, an SSE2 pair or scalar lanes, following the build's SIMD level.
+        inline void ChunkSplitI32x8(const int* in, const Vec3I& shift, int* chunk, int* local, size_t n) noexcept {
+            const I32x8 mask[3] = {I32x8::Broadcast((1 << shift.X)-1), I32x8::Broadcast((1 << shift.Y)-1),
+                                   I32x8::Broadcast((1 << shift.Z)-1)};
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8, in += 24) {
+                I32x8 v[3];
+                I32x8::Load3(in, v[0], v[1], v[2]);
+                if (chunk) {
+                    I32x8::Store3(chunk, v[0] >> shift.X, v[1] >> shift.Y, v[2] >> shift.Z);
+                    chunk += 24;
+                }
+                if (local) {
+                    I32x8::Store3(local, v[0] & mask[0], v[1] & mask[1], v[2] & mask[2]);
+                    local += 24;
+                }
+            }
+            ChunkSplitScalar(in, shift, chunk, local, n-i);
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        // Eight records are three registers in memory order; lane l of register r holds axis (r * 8 + l) % 3, so
+        // the per-lane shift of srav takes the place of the Load3 shuffles
+        MATH_TARGET("avx2")
+        inline void ChunkSplitAVX2(const int* in, const Vec3I& shift, int* chunk, int* local, size_t n) noexcept {
+            __m256i counts[3], mask[3];
+            for (auto r = 0; r<3; ++r) {
+                alignas(32) int c[8], m[8];
+                for (auto l = 0; l<8; ++l) {
+                    c[l] = shift.Data[(r*8+l)%3];
+                    m[l] = (1 << c[l])-1;
+                }
+                counts[r] = _mm256_load_si256(reinterpret_cast<const __m256i*>(c));
+                mask[r] = _mm256_load_si256(reinterpret_cast<const __m256i*>(m));
+            }
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8, in += 24) {
+                __m256i v[3];
+                for (auto r = 0; r<3; ++r) v[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in+r*8));
+                if (chunk) {
+                    for (auto r = 0; r<3; ++r)
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(chunk+r*8), _mm256_srav_epi32(v[r], counts[r]));
+                    chunk += 24;
+                }
+                if (local) {
+                    for (auto r = 0; r<3; ++r)
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(local+r*8), _mm256_and_si256(v[r], mask[r]));
+                    local += 24;
+                }
+            }
+            ChunkSplitScalar(in, shift, chunk, local, n-i);
+        }
+#endif
+
+        inline ChunkSplitKernel SelectChunkSplit() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2) return &ChunkSplitAVX2;
+#endif
+            return &ChunkSplitI32x8;
+        }
+
+        inline void ChunkSplit(std::span<const Vec3I> in, const Vec3I& shift, Vec3I* chunk, Vec3I* local, size_t n) noexcept {
+            static const auto kernel = SelectChunkSplit();
+            kernel(reinterpret_cast<const int*>(in.data()), shift, reinterpret_cast<int*>(chunk),
+                   reinterpret_cast<int*>(local), n);
+        }
+    }
+
+    inline void FloorDivPow2(std::span<const Vec3I> in, const Vec3I& shift, std::span<Vec3I> out) noexcept {
+        SIMD::ChunkSplit(in, shift, out.data(), nullptr, std::min(in.size(), out.size()));
+    }
+    inline void FloorDivPow2(std::span<const Vec3I> in, int shift, std::span<Vec3I> out) noexcept {
+        FloorDivPow2(in, Vec3I(shift, shift, shift), out);
+    }
+    inline void ModPow2(std::span<const Vec3I> in, const Vec3I& shift, std::span<Vec3I> out) noexcept {
+        SIMD::ChunkSplit(in, shift, nullptr, out.data(), std::min(in.size(), out.size()));
+    }
+    inline void ModPow2(std::span<const Vec3I> in, int shift, std::span<Vec3I> out) noexcept {
+        ModPow2(in, Vec3I(shift, shift, shift), out);
+    }
+    // chunk and local must not overlap each other; either may be the same span as world
+    inline void SplitChunkLocal(std::span<const Vec3I> world, const Vec3I& shift, std::span<Vec3I> chunk,
+                                std::span<Vec3I> local) noexcept {
+        SIMD::ChunkSplit(world, shift, chunk.data(), local.data(),
+                         std::min({world.size(), chunk.size(), local.size()}));
+    }
+    inline void SplitChunkLocal(std::span<const Vec3I> world, int shift, std::span<Vec3I> chunk,
+                                std::span<Vec3I> local) noexcept {
+        SplitChunkLocal(world, Vec3I(shift, shift, shift), chunk, local);
+    }
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "Morton.h"
+
+// Streaming compression for arrays of vectors and matrices.
+//   MortonDelta*    Vec2I / Vec3I as zigzag varint deltas of consecutive Morton codes; lossless for coordinates the
+//                   codes keep (Vec3I: [-2^20, 2^20) per axis, Vec2I: all), smallest on Morton-sorted input
+//   XorDelta*       any float aggregate (float, Vec3F, Vec4F, Mat4F, ...), lossless: each component is XORed with
+//                   the same component of the previous element and only its low nonzero bytes are stored
+//   QuantizedDelta* any float aggregate rounded to multiples of a step, as zigzag varint deltas of the step counts
+// Encoders and decoders keep the previous element between calls, so an array can go through any sequence of
+// fixed-size buffers. Encode writes whole elements while they fit and returns the elements read and bytes written;
+// Decode reads whole elements while they are complete and returns the bytes read and elements written. Bytes of an
+// incomplete trailing element are left for the caller to pass again, in front of the following data. An element
+// never takes more than MaxElementSize bytes, so a decoder making no progress with that much input is reading
+// corrupt data. Reset() restarts a stream.
+namespace Math::Codec {
+    struct Progress {
+        size_t Read, Written;
+    };
+
+    constexpr uint64_t ZigZag(int64_t v) noexcept { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+    constexpr int64_t UnZigZag(uint64_t v) noexcept { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+    inline constexpr size_t MaxVarintSize = 10;
+
+    constexpr size_t VarintSize(uint64_t v) noexcept { return (size_t(std::bit_width(v | 1))+6)/7; }
+
+    // LEB128, 7 bits per byte from the low end; returns the bytes written
+    constexpr size_t PutVarint(uint64_t v, uint8_t* out) noexcept {
+        auto n = size_t(0);
+        for (; v>=0x80; v >>= 7) out[n++] = uint8_t(v | 0x80);
+        out[n++] = uint8_t(v);
+        return n;
+    }
+
+    // returns the bytes read, or 0 when in holds no complete varint or a malformed one
+    constexpr size_t GetVarint(const uint8_t* in, size_t size, uint64_t& v) noexcept {
+        uint64_t ret = 0;
+        for (auto i = size_t(0); i<std::min(size, MaxVarintSize); ++i) {
+            ret |= uint64_t(in[i] & 0x7F) << (7*i);
+            if (!(in[i] & 0x80)) {
+                v = ret;
+                return i+1;
+            }
+        }
+        return 0;
+    }
+
+    // Sorts into Morton order; coordinates must be within the range the Morton codes keep
+    inline void MortonSort(std::span<Vec3I> v) {
+        std::vector<uint64_t> codes(v.size());
+        Morton::Encode3(v, codes);
+        std::sort(codes.begin(), codes.end());
+        Morton::Decode3(codes, v);
+    }
+    inline void MortonSort(std::span<Vec2I> v) {
+        std::vector<uint64_t> codes(v.size());
+        Morton::Encode2(v, codes);
+        std::sort(codes.begin(), codes.end());
+        Morton::Decode2(codes, v);
+    }
+
+    template <class V>
+    class MortonDeltaEncoder {
+        static_assert(std::is_same_v<V, Vec3I> || std::is_same_v<V, Vec2I>);
+    public:
+        static constexpr size_t MaxElementSize = MaxVarintSize;
+
+        Progress Encode(std::span<const V> in, std::span<uint8_t> out) noexcept {
+            Progress ret{0, 0};
+            uint64_t codes[Batch];
+            while (ret.Read<in.size()) {
+                const auto n = std::min(in.size()-ret.Read, Batch);
+                if constexpr (std::is_same_v<V, Vec3I>) Morton::Encode3(in.subspan(ret.Read, n), codes);
+                else Morton::Encode2(in.subspan(ret.Read, n), codes);
+                for (auto i = size_t(0); i<n; ++i) {
+                    const auto v = ZigZag(int64_t(codes[i]-_Prev));
+                    const auto room = out.size()-ret.Written;
+                    if (room<MaxVarintSize && room<VarintSize(v)) return ret;
+                    ret.Written += PutVarint(v, out.data()+ret.Written);
+                    _Prev = codes[i];
+                    ++ret.Read;
+                }
+            }
+            return ret;
+        }
+        void Reset() noexcept { _Prev = 0; }
+    private:
+        static constexpr size_t Batch = 256;
+        uint64_t _Prev = 0;
+    };
+
+    template <class V>
+    class MortonDeltaDecoder {
+        static_assert(std::is_same_v<V, Vec3I> || std::is_same_v<V, Vec2I>);
+    public:
+        static constexpr size_t MaxElementSize = MaxVarintSize;
+
+        Progress Decode(std::span<const uint8_t> in, std::span<V> out) noexcept {
+            Progress ret{0, 0};
+            uint64_t codes[Batch];
+            while (ret.Written<out.size()) {
+                const auto want = std::min(out.size()-ret.Written, Batch);
+                auto n = size_t(0);
+                for (uint64_t v; n<want; ++n) {
+                    const auto used = GetVarint(in.data()+ret.Read, in.size()-ret.Read, v);
+                    if (!used) break;
+                    ret.Read += used;
+                    _Prev += uint64_t(UnZigZag(v));
+                    codes[n] = _Prev;
+                }
+                if constexpr (std::is_same_v<V, Vec3I>) Morton::Decode3(std::span<const uint64_t>(codes, n), out.subspan(ret.Written, n));
+                else Morton::Decode2(std::span<const uint64_t>(codes, n), out.subspan(ret.Written, n));
+                ret.Written += n;
+                if (n<want) break;
+            }
+            return ret;
+        }
+        void Reset() noexcept { _Prev = 0; }
+    private:
+        static constexpr size_t Batch = 256;
+        uint64_t _Prev = 0;
+    };
+
+    // V is read and written as sizeof(V) / 4 consecutive floats
+    template <class V>
+    inline constexpr size_t FloatComponents = sizeof(V)/sizeof(float);
+
+    template <class V>
+    inline constexpr bool IsFloatAggregate = std::is_trivially_copyable_v<V> && sizeof(V)%sizeof(float)==0;
+
+    namespace Detail {
+        // 2-bit length codes, four components per control byte
+        inline constexpr uint8_t XorBytes[4] = {0, 2, 3, 4};
+
+        constexpr uint32_t XorCode(uint32_t x) noexcept { return x==0 ? 0 : (x<0x10000u ? 1 : (x<0x1000000u ? 2 : 3)); }
+    }
+
+    template <class V>
+    class XorDeltaEncoder {
+        static_assert(IsFloatAggregate<V>);
+        static constexpr size_t N = FloatComponents<V>, Control = (N+3)/4;
+    public:
+        static constexpr size_t MaxElementSize = Control+N*4;
+
+        Progress Encode(std::span<const V> in, std::span<uint8_t> out) noexcept {
+            Progress ret{0, 0};
+            for (; ret.Read<in.size(); ++ret.Read) {
+                uint32_t cur[N], x[N];
+                uint8_t control[Control]{};
+                std::memcpy(cur, &in[ret.Read], sizeof(cur));
+                auto size = Control;
+                for (auto k = size_t(0); k<N; ++k) {
+                    x[k] = cur[k] ^ _Prev[k];
+                    const auto code = Detail::XorCode(x[k]);
+                    control[k/4] |= uint8_t(code << (2*(k%4)));
+                    size += Detail::XorBytes[code];
+                }
+                if (out.size()-ret.Written<size) break;
+                auto p = out.data()+ret.Written;
+                std::memcpy(p, control, Control);
+                p += Control;
+                for (auto k = size_t(0); k<N; ++k)
+                    for (auto b = 0; b<Detail::XorBytes[Detail::XorCode(x[k])]; ++b) *p++ = uint8_t(x[k] >> (8*b));
+                std::memcpy(_Prev, cur, sizeof(cur));
+                ret.Written += size;
+            }
+            return ret;
+        }
+        void Reset() noexcept { std::fill(std::begin(_Prev), std::end(_Prev), 0u); }
+    private:
+        uint32_t _Prev[N]{};
+    };
+
+    template <class V>
+    class XorDeltaDecoder {
+        static_assert(IsFloatAggregate<V>);
+        static constexpr size_t N = FloatComponents<V>, Control = (N+3)/4;
+    public:
+        static constexpr size_t MaxElementSize = Control+N*4;
+
+        Progress Decode(std::span<const uint8_t> in, std::span<V> out) noexcept {
+            Progress ret{0, 0};
+            for (; ret.Written<out.size(); ++ret.Written) {
+                const auto avail = in.size()-ret.Read;
+                if (avail<Control) break;
+                auto p = in.data()+ret.Read;
+                auto size = Control;
+                for (auto k = size_t(0); k<N; ++k) size += Detail::XorBytes[(p[k/4] >> (2*(k%4))) & 3];
+                if (avail<size) break;
+                const auto control = p;
+                p += Control;
+                for (auto k = size_t(0); k<N; ++k) {
+                    uint32_t x = 0;
+                    for (auto b = 0; b<Detail::XorBytes[(control[k/4] >> (2*(k%4))) & 3]; ++b) x |= uint32_t(*p++) << (8*b);
+                    _Prev[k] ^= x;
+                }
+                std::memcpy(&out[ret.Written], _Prev, sizeof(_Prev));
+                ret.Read += size;
+            }
+            return ret;
+        }
+        void Reset() noexcept { std::fill(std::begin(_Prev), std::end(_Prev), 0u); }
+    private:
+        uint32_t _Prev[N]{};
+    };
+
+    // Components are stored as round(x / step); they must be finite with |x / step| < 2^62
+    template <class V>
+    class QuantizedDeltaEncoder {
+        static_assert(IsFloatAggregate<V>);
+        static constexpr size_t N = FloatComponents<V>;
+    public:
+        static constexpr size_t MaxElementSize = N*MaxVarintSize;
+
+        explicit QuantizedDeltaEncoder(float step) noexcept
+                :_InvStep(1.0/double(step)) { }
+
+        Progress Encode(std::span<const V> in, std::span<uint8_t> out) noexcept {
+            Progress ret{0, 0};
+            for (; ret.Read<in.size(); ++ret.Read) {
+                float f[N];
+                int64_t q[N];
+                uint64_t z[N];
+                std::memcpy(f, &in[ret.Read], sizeof(f));
+                auto size = size_t(0);
+                for (auto k = size_t(0); k<N; ++k) {
+                    q[k] = std::llrint(double(f[k])*_InvStep);
+                    z[k] = ZigZag(int64_t(uint64_t(q[k])-uint64_t(_Prev[k])));
+                    size += VarintSize(z[k]);
+                }
+                if (out.size()-ret.Written<size) break;
+                for (auto k = size_t(0); k<N; ++k) ret.Written += PutVarint(z[k], out.data()+ret.Written);
+                std::memcpy(_Prev, q, sizeof(q));
+            }
+            return ret;
+        }
+        void Reset() noexcept { std::fill(std::begin(_Prev), std::end(_Prev), int64_t(0)); }
+    private:
+        double _InvStep;
+        int64_t _Prev[N]{};
+    };
+
+    template <class V>
+    class QuantizedDeltaDecoder {
+        static_assert(IsFloatAggregate<V>);
+        static constexpr size_t N = FloatComponents<V>;
+    public:
+        static constexpr size_t MaxElementSize = N*MaxVarintSize;
+
+        explicit QuantizedDeltaDecoder(float step) noexcept
+                :_Step(step) { }
+
+        Progress Decode(std::span<const uint8_t> in, std::span<V> out) noexcept {
+            Progress ret{0, 0};
+            for (; ret.Written<out.size(); ++ret.Written) {
+                int64_t q[N];
+                auto read = ret.Read;
+                auto k = size_t(0);
+                for (uint64_t z; k<N; ++k) {
+                    const auto used = GetVarint(in.data()+read, in.size()-read, z);
+                    if (!used) break;
+                    read += used;
+                    q[k] = int64_t(uint64_t(_Prev[k])+uint64_t(UnZigZag(z)));
+                }
+                if (k<N) break;
+                float f[N];
+                for (k = 0; k<N; ++k) f[k] = float(double(q[k])*_Step);
+                std::memcpy(&out[ret.Written], f, sizeof(f));
+                std::memcpy(_Prev, q, sizeof(q));
+                ret.Read = read;
+            }
+            return ret;
+        }
+        void Reset() noexcept { std::fill(std::begin(_Prev), std::end(_Prev), int64_t(0)); }
+    private:
+        double _Step;
+        int64_t _Prev[N]{};
+    };
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <functional>
+#include "Matrix.h"
+
+// Opt-in expression templates for element-wise Vec/Mat arithmetic.
+// Lazy(x) wraps a vector or matrix by reference; +, -, unary -, scalar * and / on wrapped operands build an
+// expression tree instead of temporaries, and Transpose() yields a view. Nothing is computed until the tree is
+// converted to its value type, passed to Evaluate() or written with Assign(), which run one fused loop.
+// Expressions hold references: they must not outlive the operands they were built from.
+namespace Math {
+    namespace Expr {
+        template <class T>
+        struct Shape;
+
+        template <size_t D, class T>
+        struct Shape<Vec<D, T>> {
+            static constexpr int Rows = 1, Cols = int(D);
+            using DataType = T;
+            static T& At(Vec<D, T>& v, int, int j) noexcept { return v.Data[j]; }
+            static const T& At(const Vec<D, T>& v, int, int j) noexcept { return v.Data[j]; }
+        };
+
+        template <class T, int R, int C>
+        struct Shape<Mat<T, R, C>> {
+            static constexpr int Rows = R, Cols = C;
+            using DataType = T;
+            static T& At(Mat<T, R, C>& m, int i, int j) noexcept { return m[i].Data[j]; }
+            static const T& At(const Mat<T, R, C>& m, int i, int j) noexcept { return m[i].Data[j]; }
+        };
+
+        template <class E>
+        class TransposeView;
+
+        // CRTP base of every node. Derived types provide Rows, Cols, ValueType, At(i, j) and
+        // Overlaps(p, q, transposedOnly), which reports whether the node reads [p, q) at all, or only
+        // through a transposed view when transposedOnly is set.
+        template <class E>
+        struct Node {
+            const E& Self() const noexcept { return static_cast<const E&>(*this); }
+            TransposeView<E> Transpose() const noexcept { return TransposeView<E>(Self()); }
+            template <class V, class F = E, class = std::enable_if_t<std::is_same_v<V, typename F::ValueType>>>
+            operator V() const noexcept { return Evaluate(Self()); }
+        };
+
+        template <class V>
+        class Ref : public Node<Ref<V>> {
+        public:
+            using ValueType = V;
+            using DataType = typename Shape<V>::DataType;
+            static constexpr int Rows = Shape<V>::Rows, Cols = Shape<V>::Cols;
+
+            explicit Ref(const V& v) noexcept : _V(&v) { }
+            DataType At(int i, int j) const noexcept { return Shape<V>::At(*_V, i, j); }
+            bool Overlaps(const void* p, const void* q, bool transposedOnly) const noexcept {
+                const auto b = static_cast<const void*>(_V), e = static_cast<const void*>(_V+1);
+                return !transposedOnly && std::less<>()(b, q) && std::less<>()(p, e);
+            }
+        private:
+            const V* _V;
+        };
+
+        template <class E>
+        class TransposeView : public Node<TransposeView<E>> {
+        public:
+            using DataType = typename E::DataType;
+            using ValueType = Mat<DataType, E::Cols, E::Rows>;
+            static constexpr int Rows = E::Cols, Cols = E::Rows;
+            static_assert(!std::is_same_v<typename E::ValueType, Vec<size_t(E::Cols), DataType>>,
+                    "Transpose of a vector expression is not supported");
+
+            explicit TransposeView(const E& e) noexcept : _E(e) { }
+            DataType At(int i, int j) const noexcept { return _E.At(j, i); }
+            bool Overlaps(const void* p, const void* q, bool) const noexcept { return _E.Overlaps(p, q, false); }
+        private:
+            E _E;
+        };
+
+        template <class Op, class E>
+        class Unary : public Node<Unary<Op, E>> {
+        public:
+            using ValueType = typename E::ValueType;
+            using DataType = typename E::DataType;
+            static constexpr int Rows = E::Rows, Cols = E::Cols;
+
+            explicit Unary(const E& e) noexcept : _E(e) { }
+            DataType At(int i, int j) const noexcept { return Op{}(_E.At(i, j)); }
+            bool Overlaps(const void* p, const void* q, bool transposedOnly) const noexcept { return _E.Overlaps(p, q, transposedOnly); }
+        private:
+            E _E;
+        };
+
+        template <class Op, class L, class R>
+        class Binary : public Node<Binary<Op, L, R>> {
+        public:
+            using ValueType = typename L::ValueType;
+            using DataType = typename L::DataType;
+            static constexpr int Rows = L::Rows, Cols = L::Cols;
+            static_assert(L::Rows==R::Rows && L::Cols==R::Cols, "operand shapes differ");
+
+            Binary(const L& l, const R& r) noexcept : _L(l), _R(r) { }
+            DataType At(int i, int j) const noexcept { return Op{}(_L.At(i, j), _R.At(i, j)); }
+            bool Overlaps(const void* p, const void* q, bool transposedOnly) const noexcept {
+                return _L.Overlaps(p, q, transposedOnly) || _R.Overlaps(p, q, transposedOnly);
+            }
+        private:
+            L _L;
+            R _R;
+        };
+
+        // element op scalar, or scalar op element when Left is set
+        template <class Op, class E, bool Left = false>
+        class ScalarExpr : public Node<ScalarExpr<Op, E, Left>> {
+        public:
+            using ValueType = typename E::ValueType;
+            using DataType = typename E::DataType;
+            static constexpr int Rows = E::Rows, Cols = E::Cols;
+
+            ScalarExpr(const E& e, DataType s) noexcept : _E(e), _S(s) { }
+            DataType At(int i, int j) const noexcept { return Left ? Op{}(_S, _E.At(i, j)) : Op{}(_E.At(i, j), _S); }
+            bool Overlaps(const void* p, const void* q, bool transposedOnly) const noexcept { return _E.Overlaps(p, q, transposedOnly); }
+        private:
+            E _E;
+            DataType _S;
+        };
+
+        template <class E>
+        std::true_type IsNodeTest(const Node<E>*);
+        std::false_type IsNodeTest(...);
+        template <class E>
+        constexpr bool IsNode = decltype(IsNodeTest(static_cast<std::decay_t<E>*>(nullptr)))::value;
+        template <class E>
+        using EnableIfNode = std::enable_if_t<IsNode<E>>;
+        template <class E, class S>
+        using EnableIfScalar = std::enable_if_t<IsNode<E> && std::is_convertible_v<S, typename E::DataType> &&
+                !IsNode<S> && IsNotVectorOrMatrix<std::decay_t<S>>::value>;
+
+        template <class L, class R, class = EnableIfNode<L>, class = EnableIfNode<R>>
+        auto operator+(const L& l, const R& r) noexcept { return Binary<std::plus<>, L, R>(l, r); }
+        template <class L, class R, class = EnableIfNode<L>, class = EnableIfNode<R>>
+        auto operator-(const L& l, const R& r) noexcept { return Binary<std::minus<>, L, R>(l, r); }
+        template <class E, class = EnableIfNode<E>>
+        auto operator-(const E& e) noexcept { return Unary<std::negate<>, E>(e); }
+        template <class E, class S, class = EnableIfScalar<E, S>>
+        auto operator*(const E& e, const S& s) noexcept { return ScalarExpr<std::multiplies<>, E>(e, s); }
+        template <class S, class E, class = EnableIfScalar<E, S>, int = 0>
+        auto operator*(const S& s, const E& e) noexcept { return ScalarExpr<std::multiplies<>, E, true>(e, s); }
+        template <class E, class S, class = EnableIfScalar<E, S>>
+        auto operator/(const E& e, const S& s) noexcept { return ScalarExpr<std::divides<>, E>(e, s); }
+
+        template <class E, class = EnableIfNode<E>>
+        auto Transpose(const E& e) noexcept { return e.Transpose(); }
+
+        // Writes e into dst in one pass. If a transposed view reads dst the result is built in a temporary first;
+        // purely element-wise expressions may freely alias dst.
+        template <class V, class E, class = EnableIfNode<E>>
+        V& Assign(V& dst, const E& e) noexcept {
+            static_assert(Shape<V>::Rows==E::Rows && Shape<V>::Cols==E::Cols, "destination shape differs");
+            if (e.Overlaps(&dst, &dst+1, true)) {
+                V tmp{};
+                Assign(tmp, e);
+                return dst = tmp;
+            }
+            // staging each row lets the compiler vectorize the reads without proving dst is disjoint
+            for (auto i = 0; i<E::Rows; ++i) {
+                typename E::DataType row[E::Cols];
+                for (auto j = 0; j<E::Cols; ++j) row[j] = e.At(i, j);
+                for (auto j = 0; j<E::Cols; ++j) Shape<V>::At(dst, i, j) = row[j];
+            }
+            return dst;
+        }
+
+        template <class E, class = EnableIfNode<E>>
+        typename E::ValueType Evaluate(const E& e) noexcept {
+            typename E::ValueType ret{};
+            return Assign(ret, e);
+        }
+    }
+
+    template <size_t D, class T>
+    Expr::Ref<Vec<D, T>> Lazy(const Vec<D, T>& v) noexcept { return Expr::Ref<Vec<D, T>>(v); }
+    template <class T, int R, int C>
+    Expr::Ref<Mat<T, R, C>> Lazy(const Mat<T, R, C>& m) noexcept { return Expr::Ref<Mat<T, R, C>>(m); }
+}
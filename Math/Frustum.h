@@ -0,0 +1,232 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include "AABB.h"
+#include "Matrix.h"
+#include "SIMD.h"
+
+namespace Math {
+    enum class Containment : uint8_t { Outside, Intersecting, Inside };
+
+    // Six inward-facing planes (a, b, c, d) with unit normals: a point p is inside when a*x + b*y + c*z + d >= 0
+    // for every plane. Planes are ordered left, right, bottom, top, near, far.
+    template <class T>
+    class Frustum {
+    public:
+        enum PlaneIndex { Left, Right, Bottom, Top, Near, Far };
+        static constexpr int AllPlanes = 0x3F;
+
+        constexpr Frustum() noexcept = default;
+        // Gribb-Hartmann extraction from a view-projection matrix mapping world points to clip space (clip = m * p).
+        // zeroToOneDepth selects a [0, 1] clip depth range instead of [-1, 1].
+        explicit Frustum(const Mat<T, 4, 4>& viewProj, bool zeroToOneDepth = false) noexcept {
+            for (auto c = 0; c<4; ++c) {
+                const auto w = viewProj(3, c);
+                _Planes[Left].Data[c] = w+viewProj(0, c);
+                _Planes[Right].Data[c] = w-viewProj(0, c);
+                _Planes[Bottom].Data[c] = w+viewProj(1, c);
+                _Planes[Top].Data[c] = w-viewProj(1, c);
+                _Planes[Near].Data[c] = zeroToOneDepth ? viewProj(2, c) : w+viewProj(2, c);
+                _Planes[Far].Data[c] = w-viewProj(2, c);
+            }
+            for (auto& p : _Planes) {
+                const auto inv = T(1)/std::sqrt(p.Data[0]*p.Data[0]+p.Data[1]*p.Data[1]+p.Data[2]*p.Data[2]);
+                for (auto& x : p.Data) x *= inv;
+            }
+        }
+
+        constexpr const Vec4<T>& Plane(int idx) const noexcept { return _Planes[idx]; }
+        // signed distance of point from plane idx, positive inside
+        constexpr T Distance(int idx, const Vec3<T>& point) const noexcept {
+            const auto& p = _Planes[idx].Data;
+            return p[0]*point.Data[0]+p[1]*point.Data[1]+p[2]*point.Data[2]+p[3];
+        }
+
+        // Tests only the planes set in planes and clears the ones the box is entirely inside of, so a caller
+        // descending into sub-boxes can skip them
+        constexpr Containment Classify(const AABB<T>& box, int& planes) const noexcept {
+            const auto c = box.Center(), e = box.Size()/T(2);
+            auto ret = Containment::Inside;
+            for (auto i = 0; i<6; ++i) {
+                if (!(planes & (1 << i))) continue;
+                const auto& p = _Planes[i].Data;
+                const auto s = Distance(i, c);
+                const auto r = Abs(p[0])*e.Data[0]+Abs(p[1])*e.Data[1]+Abs(p[2])*e.Data[2];
+                if (s< -r) return Containment::Outside;
+                if (s<r) ret = Containment::Intersecting;
+                else planes &= ~(1 << i);
+            }
+            return ret;
+        }
+        constexpr Containment Classify(const AABB<T>& box) const noexcept {
+            auto planes = AllPlanes;
+            return Classify(box, planes);
+        }
+        constexpr Containment Classify(const Vec3<T>& center, T radius) const noexcept {
+            auto ret = Containment::Inside;
+            for (auto i = 0; i<6; ++i) {
+                const auto s = Distance(i, center);
+                if (s< -radius) return Containment::Outside;
+                if (s<radius) ret = Containment::Intersecting;
+            }
+            return ret;
+        }
+        constexpr bool Visible(const AABB<T>& box) const noexcept { return Classify(box)!=Containment::Outside; }
+        constexpr bool Visible(const Vec3<T>& center, T radius) const noexcept {
+            return Classify(center, radius)!=Containment::Outside;
+        }
+    private:
+        static constexpr T Abs(T v) noexcept { return v<T(0) ? -v : v; }
+
+        Vec4<T> _Planes[6];
+    };
+
+    using FrustumF = Frustum<float>;
+    using FrustumD = Frustum<double>;
+
+    namespace SIMD {
+        inline F32x8 PlaneDistance8(const Vec4F& plane, const F32x8 (&c)[3]) noexcept {
+            const auto& p = plane.Data;
+            return MulAdd(F32x8::Broadcast(p[2]), c[2], MulAdd(F32x8::Broadcast(p[1]), c[1],
+                    MulAdd(F32x8::Broadcast(p[0]), c[0], F32x8::Broadcast(p[3]))));
+        }
+
+        // 8 boxes in center/half-extent form; bit i of visible is set unless box i is outside, bit i of inside is set
+        // when box i is entirely inside
+        inline void Classify8(const FrustumF& f, const F32x8 (&c)[3], const F32x8 (&e)[3], int& visible,
+                              int& inside) noexcept {
+            auto out = F32x8::Zero(), part = F32x8::Zero();
+            for (auto i = 0; i<6; ++i) {
+                const auto& p = f.Plane(i).Data;
+                const auto s = PlaneDistance8(f.Plane(i), c);
+                const auto r = MulAdd(F32x8::Broadcast(std::abs(p[2])), e[2],
+                        MulAdd(F32x8::Broadcast(std::abs(p[1])), e[1], F32x8::Broadcast(std::abs(p[0]))*e[0]));
+                out = out | (s< -r);
+                part = part | (s<r);
+            }
+            visible = ~out.Mask() & 0xFF;
+            inside = ~(out | part).Mask() & 0xFF;
+        }
+
+        // 8 spheres
+        inline void Classify8(const FrustumF& f, const F32x8 (&c)[3], F32x8 r, int& visible, int& inside) noexcept {
+            const auto nr = -r;
+            auto out = F32x8::Zero(), part = F32x8::Zero();
+            for (auto i = 0; i<6; ++i) {
+                const auto s = PlaneDistance8(f.Plane(i), c);
+                out = out | (s<nr);
+                part = part | (s<r);
+            }
+            visible = ~out.Mask() & 0xFF;
+            inside = ~(out | part).Mask() & 0xFF;
+        }
+
+        // ORs the low count bits of mask into bits starting at bit first; first is a multiple of 8 and count at
+        // most 8, so the bits never straddle two words
+        inline void SetBits(std::span<uint64_t> bits, size_t first, int mask, int count) noexcept {
+            const auto m = uint64_t(unsigned(mask) & ((1u << count)-1));
+            bits[first/64] |= m << first%64;
+        }
+    }
+
+    // Batched culling, 8 objects at a time. Bit i (word i / 64, bit i % 64) of visible is set unless object i is
+    // entirely outside; bit i of inside, when given, is set if object i is entirely inside, so intersecting objects
+    // are visible & ~inside. Both spans need (count + 63) / 64 words.
+    inline void Cull(const FrustumF& f, std::span<const AABBF> boxes, std::span<uint64_t> visible,
+                     std::span<uint64_t> inside = {}) noexcept {
+        using SIMD::F32x8;
+        const auto words = (boxes.size()+63)/64;
+        assert(visible.size()>=words && (inside.empty() || inside.size()>=words));
+        std::fill_n(visible.begin(), words, uint64_t(0));
+        if (!inside.empty()) std::fill_n(inside.begin(), words, uint64_t(0));
+        for (auto i = size_t(0); i<boxes.size(); i += 8) {
+            const auto n = int(std::min<size_t>(boxes.size()-i, 8));
+            float lanes[6][8]{};
+            for (auto j = 0; j<n; ++j)
+                for (auto a = 0; a<3; ++a) {
+                    lanes[a][j] = boxes[i+j].Min.Data[a];
+                    lanes[3+a][j] = boxes[i+j].Max.Data[a];
+                }
+            const auto half = F32x8::Broadcast(0.5f);
+            F32x8 c[3], e[3];
+            for (auto a = 0; a<3; ++a) {
+                const auto lo = F32x8::Load(lanes[a]), hi = F32x8::Load(lanes[3+a]);
+                c[a] = (lo+hi)*half;
+                e[a] = (hi-lo)*half;
+            }
+            int vis, in;
+            SIMD::Classify8(f, c, e, vis, in);
+            SIMD::SetBits(visible, i, vis, n);
+            if (!inside.empty()) SIMD::SetBits(inside, i, in, n);
+        }
+    }
+    // spheres centers[i] with radii[i], over min(centers.size(), radii.size()) objects
+    inline void Cull(const FrustumF& f, std::span<const Vec3F> centers, std::span<const float> radii,
+                     std::span<uint64_t> visible, std::span<uint64_t> inside = {}) noexcept {
+        using SIMD::F32x8;
+        const auto count = std::min(centers.size(), radii.size());
+        const auto words = (count+63)/64;
+        assert(visible.size()>=words && (inside.empty() || inside.size()>=words));
+        std::fill_n(visible.begin(), words, uint64_t(0));
+        if (!inside.empty()) std::fill_n(inside.begin(), words, uint64_t(0));
+        for (auto i = size_t(0); i<count; i += 8) {
+            const auto n = int(std::min<size_t>(count-i, 8));
+            float lanes[4][8]{};
+            for (auto j = 0; j<n; ++j) {
+                for (auto a = 0; a<3; ++a) lanes[a][j] = centers[i+j].Data[a];
+                lanes[3][j] = radii[i+j];
+            }
+            const F32x8 c[3] = {F32x8::Load(lanes[0]), F32x8::Load(lanes[1]), F32x8::Load(lanes[2])};
+            int vis, in;
+            SIMD::Classify8(f, c, F32x8::Load(lanes[3]), vis, in);
+            SIMD::SetBits(visible, i, vis, n);
+            if (!inside.empty()) SIMD::SetBits(inside, i, in, n);
+        }
+    }
+
+    // Walks the cells [lo, hi) of a grid whose cell c spans origin + c * cellSize to origin + (c + 1) * cellSize and
+    // calls fn(const Vec3I& cell, bool inside) for every cell not entirely outside the frustum. Regions are bisected
+    // coarse-to-fine: fully outside regions are skipped, fully inside ones are emitted without further tests, and
+    // planes a region is inside of are not tested again for its sub-regions.
+    template <class F>
+    void ForEachVisibleCell(const FrustumF& f, const Vec3I& lo, const Vec3I& hi, const Vec3F& cellSize, F&& fn,
+                            const Vec3F& origin = Vec3F()) {
+        struct Region {
+            Vec3I Lo, Hi;
+            int Planes;
+        };
+        // each bisection adds at most one pending region per level, and extents fit in 32 bits per axis
+        Region stack[3*32+1];
+        auto top = 0;
+        if (lo.X<hi.X && lo.Y<hi.Y && lo.Z<hi.Z) stack[top++] = {lo, hi, FrustumF::AllPlanes};
+        while (top) {
+            auto [a, b, planes] = stack[--top];
+            const AABBF box(
+                    Vec3F(origin.X+float(a.X)*cellSize.X, origin.Y+float(a.Y)*cellSize.Y, origin.Z+float(a.Z)*cellSize.Z),
+                    Vec3F(origin.X+float(b.X)*cellSize.X, origin.Y+float(b.Y)*cellSize.Y, origin.Z+float(b.Z)*cellSize.Z));
+            const auto state = planes ? f.Classify(box, planes) : Containment::Inside;
+            if (state==Containment::Outside) continue;
+            // extents of up to 2^32 - 1 cells do not fit in int
+            const int64_t size[3] = {int64_t(b.X)-a.X, int64_t(b.Y)-a.Y, int64_t(b.Z)-a.Z};
+            if (state==Containment::Inside || (size[0]==1 && size[1]==1 && size[2]==1)) {
+                const auto inside = state==Containment::Inside;
+                for (auto z = a.Z; z<b.Z; ++z)
+                    for (auto y = a.Y; y<b.Y; ++y)
+                        for (auto x = a.X; x<b.X; ++x) fn(Vec3I(x, y, z), inside);
+                continue;
+            }
+            const auto axis = size[0]>=size[1] ? (size[0]>=size[2] ? 0 : 2) : (size[1]>=size[2] ? 1 : 2);
+            auto mid = a;
+            mid.Data[axis] = int(a.Data[axis]+size[axis]/2);
+            auto split = b;
+            split.Data[axis] = mid.Data[axis];
+            // upper half first so the lower half is visited first
+            stack[top++] = {mid, b, planes};
+            stack[top++] = {a, split, planes};
+        }
+    }
+}
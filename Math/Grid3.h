@@ -0,0 +1,313 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "AABB.h"
+#include "Morton.h"
+
+// Dense 3D grids indexed by Vec3I. Cells [0, Size) are the interior; a border of Border cells on every side is
+// stored as well, so [-Border, Size + Border) is addressable and the neighbours of any interior cell are in range
+// without bounds checks when Border >= 1. Storage layouts:
+//   Linear  x fastest, then y, then z
+//   Tiled4  4x4x4 tiles laid out linearly, cells inside a tile linearly
+//   Morton  Z-order inside 8x8x8 tiles laid out linearly, or inside 4x4x4 tiles when rounding the padded extents
+//           up to whole 8-cell tiles would store more cells
+// Every layout splits into a per-axis sum, index(x, y, z) = Axis(0, x) + Axis(1, y) + Axis(2, z), which the bulk
+// and neighbourhood operations use to hoist index math out of their inner loops.
+namespace Math {
+    enum class GridLayout : uint8_t { Linear, Tiled4, Morton };
+
+    template <GridLayout L>
+    class GridIndex3 {
+    public:
+        constexpr GridIndex3(const Vec3I& size, int border) noexcept
+                :_Size(size), _Border(border) {
+            if constexpr (L==GridLayout::Tiled4) _Shift = 2;
+            if constexpr (L==GridLayout::Morton) {
+                _Shift = TiledCapacity(size, border, 3)<=TiledCapacity(size, border, 2) ? 3 : 2;
+                _Mask = (1u << _Shift)-1;
+            }
+            const auto tile = size_t(1) << _Shift;
+            auto stride = tile*tile*tile;
+            for (auto a = 0; a<3; ++a) {
+                _Stride[a] = stride;
+                stride *= (size_t(size.Data[a]+2*border)+tile-1)/tile;
+            }
+            _Capacity = stride;
+        }
+
+        constexpr const Vec3I& Size() const noexcept { return _Size; }
+        constexpr int Border() const noexcept { return _Border; }
+        // number of stored cells, including border and tile padding
+        constexpr size_t Capacity() const noexcept { return _Capacity; }
+        // interior cells
+        constexpr AABBI Interior() const noexcept {
+            return {Vec3I(0, 0, 0), Vec3I(_Size.Data[0]-1, _Size.Data[1]-1, _Size.Data[2]-1)};
+        }
+        // interior and border cells
+        constexpr AABBI Padded() const noexcept {
+            return {Vec3I(-_Border, -_Border, -_Border),
+                    Vec3I(_Size.Data[0]+_Border-1, _Size.Data[1]+_Border-1, _Size.Data[2]+_Border-1)};
+        }
+
+        // contribution of coordinate v on axis to the storage index; v must be in [-Border, Size + Border)
+        constexpr size_t Axis(int axis, int v) const noexcept {
+            const auto p = uint32_t(v+_Border);
+            if constexpr (L==GridLayout::Linear) return p*_Stride[axis];
+            else if constexpr (L==GridLayout::Tiled4) return (p >> 2u)*_Stride[axis]+(size_t(p & 3u) << (2*axis));
+            else return (p >> _Shift)*_Stride[axis]+size_t(Morton::Spread3(p & _Mask) << axis);
+        }
+        constexpr size_t operator()(const Vec3I& c) const noexcept {
+            return Axis(0, c.Data[0])+Axis(1, c.Data[1])+Axis(2, c.Data[2]);
+        }
+        constexpr size_t operator()(int x, int y, int z) const noexcept { return Axis(0, x)+Axis(1, y)+Axis(2, z); }
+        // index difference between c + d and c, the same for every c in the linear layout
+        constexpr ptrdiff_t Offset(const Vec3I& d) const noexcept {
+            static_assert(L==GridLayout::Linear);
+            return d.Data[0]*ptrdiff_t(_Stride[0])+d.Data[1]*ptrdiff_t(_Stride[1])+d.Data[2]*ptrdiff_t(_Stride[2]);
+        }
+    private:
+        // cells stored when the padded extents are rounded up to whole tiles of 2^shift
+        static constexpr size_t TiledCapacity(const Vec3I& size, int border, uint32_t shift) noexcept {
+            const auto tile = size_t(1) << shift;
+            auto ret = size_t(1);
+            for (auto a = 0; a<3; ++a) ret *= (size_t(size.Data[a]+2*border)+tile-1)/tile*tile;
+            return ret;
+        }
+
+        Vec3I _Size;
+        int _Border;
+        uint32_t _Shift = 0, _Mask = 0;
+        size_t _Stride[3]{};
+        size_t _Capacity = 0;
+    };
+
+    // Offsets of the 26 neighbours ordered faces, edges, corners, so the first 6 and 18 are the face and
+    // face-or-edge neighbourhoods
+    inline constexpr auto GridNeighbourOffsets = [] {
+        std::array<Vec3I, 26> ret{};
+        auto n = size_t(0);
+        for (auto manhattan = 1; manhattan<=3; ++manhattan)
+            for (auto z = -1; z<=1; ++z)
+                for (auto y = -1; y<=1; ++y)
+                    for (auto x = -1; x<=1; ++x)
+                        if ((x!=0)+(y!=0)+(z!=0)==manhattan) {
+                            ret[n].Data[0] = x;
+                            ret[n].Data[1] = y;
+                            ret[n].Data[2] = z;
+                            ++n;
+                        }
+        return ret;
+    }();
+
+    namespace Detail {
+        // Operations shared by the fixed and runtime-sized grids. G provides Index() and Data().
+        template <class G, class T, GridLayout L>
+        class GridBase3 {
+        public:
+            using ValueType = T;
+            static constexpr GridLayout Layout = L;
+
+            const Vec3I& Size() const noexcept { return Self().Index().Size(); }
+            AABBI Interior() const noexcept { return Self().Index().Interior(); }
+            AABBI Padded() const noexcept { return Self().Index().Padded(); }
+            bool Contains(const Vec3I& c) const noexcept { return Interior().Contains(c); }
+
+            T& operator[](const Vec3I& c) noexcept { return Self().Data()[Self().Index()(c)]; }
+            const T& operator[](const Vec3I& c) const noexcept { return Self().Data()[Self().Index()(c)]; }
+            T& At(int x, int y, int z) noexcept { return Self().Data()[Self().Index()(x, y, z)]; }
+            const T& At(int x, int y, int z) const noexcept { return Self().Data()[Self().Index()(x, y, z)]; }
+
+            // Storage indices of the first N (6, 18 or 26) neighbours of c, in GridNeighbourOffsets order.
+            // c must be at most Border - 1 cells outside the interior.
+            template <int N>
+            std::array<size_t, N> NeighbourIndices(const Vec3I& c) const noexcept {
+                static_assert(N==6 || N==18 || N==26);
+                const auto& index = Self().Index();
+                if constexpr (L==GridLayout::Linear) {
+                    const auto base = ptrdiff_t(index(c));
+                    return [&]<size_t... I>(std::index_sequence<I...>) {
+                        return std::array<size_t, N>{size_t(base+index.Offset(GridNeighbourOffsets[I]))...};
+                    }(std::make_index_sequence<N>());
+                }
+                else {
+                    size_t axis[3][3];
+                    for (auto a = 0; a<3; ++a)
+                        for (auto d = 0; d<3; ++d) axis[a][d] = index.Axis(a, c.Data[a]+d-1);
+                    return [&]<size_t... I>(std::index_sequence<I...>) {
+                        return std::array<size_t, N>{(axis[0][GridNeighbourOffsets[I].Data[0]+1]+
+                                                       axis[1][GridNeighbourOffsets[I].Data[1]+1]+
+                                                       axis[2][GridNeighbourOffsets[I].Data[2]+1])...};
+                    }(std::make_index_sequence<N>());
+                }
+            }
+            // Calls fn(const Vec3I& offset, T& neighbour) for the first N neighbours of c
+            template <int N, class F>
+            void ForEachNeighbour(const Vec3I& c, F&& fn) {
+                const auto indices = NeighbourIndices<N>(c);
+                const auto data = Self().Data().data();
+                for (auto i = 0; i<N; ++i) fn(GridNeighbourOffsets[i], data[indices[i]]);
+            }
+            template <int N, class F>
+            void ForEachNeighbour(const Vec3I& c, F&& fn) const {
+                const auto indices = NeighbourIndices<N>(c);
+                const auto data = Self().Data().data();
+                for (auto i = 0; i<N; ++i) fn(GridNeighbourOffsets[i], data[indices[i]]);
+            }
+
+            // Calls fn(const Vec3I& c, size_t index, const std::array<size_t, N>& neighbours) for every cell of box
+            // whose neighbours are all stored, x fastest; indices are as from NeighbourIndices<N>(c). Per-axis index
+            // parts are computed once per row, so this is the fast path for stencil passes over tiled and Morton
+            // layouts. The indices also address any other grid of the same extents, layout and border.
+            template <int N, class F>
+            void ForEachNeighbourhood(AABBI box, F&& fn) const {
+                static_assert(N==6 || N==18 || N==26);
+                box.Intersect(Padded().Expand(Vec3I(-1, -1, -1)));
+                if (box.Empty()) return;
+                const auto& index = Self().Index();
+                const auto count = box.Extent(0)+1;
+                std::vector<size_t> xs;
+                if constexpr (L!=GridLayout::Linear) {
+                    xs.resize(size_t(count+2));
+                    for (auto i = 0; i<count+2; ++i) xs[size_t(i)] = index.Axis(0, box.Min.Data[0]+i-1);
+                }
+                for (auto z = box.Min.Data[2]; z<=box.Max.Data[2]; ++z)
+                    for (auto y = box.Min.Data[1]; y<=box.Max.Data[1]; ++y) {
+                        Vec3I c(box.Min.Data[0], y, z);
+                        if constexpr (L==GridLayout::Linear) {
+                            auto base = ptrdiff_t(index(c));
+                            for (auto i = 0; i<count; ++i, ++base, ++c.Data[0])
+                                fn(std::as_const(c), size_t(base), [&]<size_t... I>(std::index_sequence<I...>) {
+                                    return std::array<size_t, N>{size_t(base+index.Offset(GridNeighbourOffsets[I]))...};
+                                }(std::make_index_sequence<N>()));
+                        }
+                        else {
+                            size_t yz[3][3];
+                            for (auto dy = 0; dy<3; ++dy)
+                                for (auto dz = 0; dz<3; ++dz) yz[dy][dz] = index.Axis(1, y+dy-1)+index.Axis(2, z+dz-1);
+                            for (auto i = 0; i<count; ++i, ++c.Data[0]) {
+                                const auto x = xs.data()+i+1;
+                                fn(std::as_const(c), x[0]+yz[1][1], [&]<size_t... I>(std::index_sequence<I...>) {
+                                    return std::array<size_t, N>{(x[GridNeighbourOffsets[I].Data[0]]+
+                                                                   yz[GridNeighbourOffsets[I].Data[1]+1][GridNeighbourOffsets[I].Data[2]+1])...};
+                                }(std::make_index_sequence<N>()));
+                            }
+                        }
+                    }
+            }
+
+            // Calls fn(const Vec3I&, T&) for every cell of box clipped to the padded grid, x fastest
+            template <class F>
+            void ForEach(const AABBI& box, F&& fn) {
+                ForEachRow(box, [&](const Vec3I& c, size_t base, std::span<const size_t> xs) {
+                    auto cell = c;
+                    for (auto i = size_t(0); i<xs.size(); ++i, ++cell.Data[0]) fn(cell, Self().Data()[base+xs[i]]);
+                });
+            }
+            template <class F>
+            void ForEach(F&& fn) { ForEach(Interior(), std::forward<F>(fn)); }
+
+            // every stored cell, including border and tile padding
+            void Fill(const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+                std::fill(Self().Data().begin(), Self().Data().end(), value);
+            }
+            // box is clipped to the padded grid
+            void Fill(const AABBI& box, const T& value) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+                const auto data = Self().Data().data();
+                ForEachRow(box, [&](const Vec3I&, size_t base, std::span<const size_t> xs) {
+                    if constexpr (L==GridLayout::Linear) std::fill_n(data+base+xs[0], xs.size(), value);
+                    else for (const auto x : xs) data[base+x] = value;
+                });
+            }
+
+            // Copies the cells of srcBox in src to the box of the same size at dstMin, clipped to the padded
+            // extents of both grids. src may use any layout but must not be this grid.
+            template <class S>
+            void Copy(const S& src, const AABBI& srcBox, const Vec3I& dstMin) {
+                const auto shift = dstMin-srcBox.Min;
+                auto box = Intersect(srcBox, src.Padded());
+                auto dst = Padded();
+                dst.Min = dst.Min-shift;
+                dst.Max = dst.Max-shift;
+                box.Intersect(dst);
+                const auto& srcIndex = src.Index();
+                const auto srcData = src.Data().data();
+                const auto data = Self().Data().data();
+                std::vector<size_t> srcXs;
+                ForEachRow(AABBI(box.Min+shift, box.Max+shift), [&](const Vec3I& c, size_t base, std::span<const size_t> xs) {
+                    const auto s = c-shift;
+                    const auto srcBase = srcIndex.Axis(1, s.Data[1])+srcIndex.Axis(2, s.Data[2]);
+                    if constexpr (L==GridLayout::Linear && S::Layout==GridLayout::Linear)
+                        std::copy_n(srcData+srcBase+srcIndex.Axis(0, s.Data[0]), xs.size(), data+base+xs[0]);
+                    else {
+                        if (srcXs.empty())
+                            for (auto i = size_t(0); i<xs.size(); ++i) srcXs.push_back(srcIndex.Axis(0, s.Data[0]+int(i)));
+                        for (auto i = size_t(0); i<xs.size(); ++i) data[base+xs[i]] = srcData[srcBase+srcXs[i]];
+                    }
+                });
+            }
+        private:
+            const G& Self() const noexcept { return static_cast<const G&>(*this); }
+            G& Self() noexcept { return static_cast<G&>(*this); }
+
+            // Calls fn(first cell of row, y + z index part, x index parts of the row) for each row of box clipped
+            // to the padded grid
+            template <class F>
+            void ForEachRow(AABBI box, F&& fn) const {
+                box.Intersect(Padded());
+                if (box.Empty()) return;
+                const auto& index = Self().Index();
+                std::vector<size_t> xs(size_t(box.Extent(0)+1));
+                for (auto i = size_t(0); i<xs.size(); ++i) xs[i] = index.Axis(0, box.Min.Data[0]+int(i));
+                for (auto z = box.Min.Data[2]; z<=box.Max.Data[2]; ++z) {
+                    const auto zi = index.Axis(2, z);
+                    for (auto y = box.Min.Data[1]; y<=box.Max.Data[1]; ++y)
+                        fn(Vec3I(box.Min.Data[0], y, z), zi+index.Axis(1, y), std::span<const size_t>(xs));
+                }
+            }
+        };
+    }
+
+    // Grid with compile-time extents; index math is constexpr and the cells are stored inline
+    template <class T, int SX, int SY, int SZ, GridLayout L = GridLayout::Linear, int Border = 1>
+    class Grid3 : public Detail::GridBase3<Grid3<T, SX, SY, SZ, L, Border>, T, L> {
+        static_assert(SX>0 && SY>0 && SZ>0 && Border>=0);
+    public:
+        static constexpr GridIndex3<L> Indexer{Vec3I(SX, SY, SZ), Border};
+
+        constexpr Grid3() noexcept(std::is_nothrow_default_constructible_v<T>) = default;
+
+        static constexpr const GridIndex3<L>& Index() noexcept { return Indexer; }
+        std::span<T> Data() noexcept { return _Data; }
+        std::span<const T> Data() const noexcept { return _Data; }
+    private:
+        std::array<T, Indexer.Capacity()> _Data{};
+    };
+
+    // Grid with extents chosen at construction
+    template <class T, GridLayout L = GridLayout::Linear, int Border = 1>
+    class DynamicGrid3 : public Detail::GridBase3<DynamicGrid3<T, L, Border>, T, L> {
+        static_assert(!std::is_same_v<T, bool>, "use uint8_t cells");
+    public:
+        explicit DynamicGrid3(const Vec3I& size = Vec3I(), const T& value = T())
+                :_Index(size, Border), _Data(_Index.Capacity(), value) { }
+
+        const GridIndex3<L>& Index() const noexcept { return _Index; }
+        std::span<T> Data() noexcept { return _Data; }
+        std::span<const T> Data() const noexcept { return _Data; }
+
+        // discards the contents
+        void Resize(const Vec3I& size, const T& value = T()) {
+            _Index = GridIndex3<L>(size, Border);
+            _Data.assign(_Index.Capacity(), value);
+        }
+    private:
+        GridIndex3<L> _Index;
+        std::vector<T> _Data;
+    };
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <optional>
+#include <filesystem>
+#include <type_traits>
+#include "Matrix.h"
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
+namespace Math {
+    // Read-only mapping of a whole file; empty when the file could not be opened or mapped
+    class MappedFile {
+    public:
+        MappedFile() noexcept = default;
+        explicit MappedFile(const std::filesystem::path& path) noexcept {
+#if defined(_WIN32)
+            const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                          FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file==INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER size;
+            if (GetFileSizeEx(file, &size) && size.QuadPart>0) {
+                if (const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                    if (const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+                        _Data = static_cast<const uint8_t*>(view);
+                        _Size = size_t(size.QuadPart);
+                    }
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(file);
+#else
+            const auto file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (file<0) return;
+            struct stat st{};
+            if (::fstat(file, &st)==0 && st.st_size>0) {
+                const auto view = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                if (view!=MAP_FAILED) {
+                    _Data = static_cast<const uint8_t*>(view);
+                    _Size = size_t(st.st_size);
+                }
+            }
+            ::close(file);
+#endif
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& r) noexcept { Swap(r); }
+        MappedFile& operator=(MappedFile&& r) noexcept {
+            MappedFile(std::move(r)).Swap(*this);
+            return *this;
+        }
+        ~MappedFile() noexcept {
+            if (!_Data) return;
+#if defined(_WIN32)
+            UnmapViewOfFile(_Data);
+#else
+            ::munmap(const_cast<uint8_t*>(_Data), _Size);
+#endif
+        }
+
+        explicit operator bool() const noexcept { return _Data!=nullptr; }
+        std::span<const uint8_t> Bytes() const noexcept { return {_Data, _Size}; }
+
+        void Swap(MappedFile& r) noexcept {
+            std::swap(_Data, r._Data);
+            std::swap(_Size, r._Size);
+        }
+    private:
+        const uint8_t* _Data = nullptr;
+        size_t _Size = 0;
+    };
+
+    struct Half;
+    template <class I>
+    struct Normalized;
+
+    // ScalarKind of a scalar type, defined below the header for arithmetic types, Half and Normalized
+    template <class T>
+    struct MappedScalar;
+
+    // Element description stored in a mapped array file: a scalar, Vec<Rows, T> (Cols == 1) or Mat<T, Rows, Cols>
+    template <class E>
+    struct MappedElement {
+        using Scalar = E;
+        static constexpr uint8_t Shape = 0;
+        static constexpr uint32_t Rows = 1, Cols = 1;
+    };
+    template <size_t D, class T>
+    struct MappedElement<Vec<D, T>> {
+        using Scalar = T;
+        static constexpr uint8_t Shape = 1;
+        static constexpr uint32_t Rows = uint32_t(D), Cols = 1;
+    };
+    template <class T, int R, int C>
+    struct MappedElement<Mat<T, R, C>> {
+        using Scalar = T;
+        static constexpr uint8_t Shape = 2;
+        static constexpr uint32_t Rows = uint32_t(R), Cols = uint32_t(C);
+    };
+
+    // File layout: this 64-byte header, then Count elements of ElementSize bytes each starting at DataOffset (right
+    // after the header when written by version 1). Multi-byte fields and elements are in the writer's byte order,
+    // named by Endian. Mappings are page aligned, so element alignment only constrains DataOffset.
+    struct MappedArrayHeader {
+        static constexpr uint16_t CurrentVersion = 1;
+        static constexpr uint8_t Little = 1, Big = 2;
+        static constexpr uint8_t Float = 0, Signed = 1, Unsigned = 2, HalfFloat = 3, SNorm = 4, UNorm = 5;
+
+        char Magic[4];
+        uint16_t Version;
+        uint8_t Endian;
+        uint8_t Shape;
+        uint8_t ScalarKind;
+        uint8_t ScalarSize;
+        uint16_t Alignment;
+        uint32_t Rows, Cols;
+        uint32_t ElementSize;
+        uint64_t Count;
+        uint64_t DataOffset;
+        uint8_t Padding[24];
+
+        static constexpr char ExpectedMagic[4] = {'N', 'W', 'M', 'A'};
+        static constexpr uint8_t NativeEndian = std::endian::native==std::endian::little ? Little : Big;
+
+        template <class E>
+        static constexpr MappedArrayHeader For(uint64_t count) noexcept {
+            using Info = MappedElement<E>;
+            using S = typename Info::Scalar;
+            MappedArrayHeader ret{};
+            for (auto i = 0; i<4; ++i) ret.Magic[i] = ExpectedMagic[i];
+            ret.Version = CurrentVersion;
+            ret.Endian = NativeEndian;
+            ret.Shape = Info::Shape;
+            ret.ScalarKind = MappedScalar<S>::Kind;
+            ret.ScalarSize = uint8_t(sizeof(S));
+            ret.Alignment = uint16_t(alignof(E));
+            ret.Rows = Info::Rows;
+            ret.Cols = Info::Cols;
+            ret.ElementSize = uint32_t(sizeof(E));
+            ret.Count = count;
+            ret.DataOffset = sizeof(MappedArrayHeader);
+            return ret;
+        }
+    };
+    static_assert(sizeof(MappedArrayHeader)==64 && std::is_trivially_copyable_v<MappedArrayHeader>);
+
+    // Half and Normalized get kinds of their own so a Vec3H file is not taken for a Vec3<uint16_t> one
+    template <class T>
+    struct MappedScalar {
+        static_assert(std::is_arithmetic_v<T>, "MappedArray scalars must be arithmetic, Half or Normalized");
+        static constexpr uint8_t Kind = std::is_floating_point_v<T> ? MappedArrayHeader::Float
+                : (std::is_signed_v<T> ? MappedArrayHeader::Signed : MappedArrayHeader::Unsigned);
+    };
+    template <>
+    struct MappedScalar<Half> {
+        static constexpr uint8_t Kind = MappedArrayHeader::HalfFloat;
+    };
+    template <class I>
+    struct MappedScalar<Normalized<I>> {
+        static constexpr uint8_t Kind = std::is_signed_v<I> ? MappedArrayHeader::SNorm : MappedArrayHeader::UNorm;
+    };
+
+    enum class MappedArrayError : uint8_t {
+        None, Open, Write, Magic, Version, Endian, Type, Truncated
+    };
+
+    // Typed read-only view of an array file written by MappedArray<E>::Write, used in place without copying:
+    //     if (auto probes = MappedArray<Mat34F>::Open("probes.bin")) for (const auto& m : probes->Data()) ...
+    // Opening checks the header against E as compiled (scalar type, shape, element size and alignment) and fails
+    // instead of converting, so files are only portable between builds with the same layout and byte order.
+    template <class E>
+    class MappedArray {
+        static_assert(std::is_trivially_copyable_v<E>);
+    public:
+        static std::optional<MappedArray> Open(const std::filesystem::path& path,
+                                               MappedArrayError* error = nullptr) noexcept {
+            auto fail = [error](MappedArrayError e) noexcept {
+                if (error) *error = e;
+                return std::nullopt;
+            };
+            MappedFile file(path);
+            if (!file) {
+                // an empty file opens but cannot be mapped
+                std::error_code ec;
+                const auto empty = std::filesystem::is_regular_file(path, ec) && std::filesystem::file_size(path, ec)==0;
+                return fail(empty && !ec ? MappedArrayError::Truncated : MappedArrayError::Open);
+            }
+            const auto bytes = file.Bytes();
+            MappedArrayHeader header;
+            if (bytes.size()<sizeof(header)) return fail(MappedArrayError::Truncated);
+            std::memcpy(&header, bytes.data(), sizeof(header));
+            if (std::memcmp(header.Magic, MappedArrayHeader::ExpectedMagic, 4)!=0) return fail(MappedArrayError::Magic);
+            // checked before any multi-byte field, which would be byte-swapped
+            if (header.Endian!=MappedArrayHeader::NativeEndian) return fail(MappedArrayError::Endian);
+            if (header.Version==0 || header.Version>MappedArrayHeader::CurrentVersion)
+                return fail(MappedArrayError::Version);
+            const auto expected = MappedArrayHeader::For<E>(0);
+            if (header.Shape!=expected.Shape || header.ScalarKind!=expected.ScalarKind ||
+                header.ScalarSize!=expected.ScalarSize || header.Rows!=expected.Rows || header.Cols!=expected.Cols ||
+                header.ElementSize!=expected.ElementSize || header.Alignment!=expected.Alignment ||
+                header.DataOffset%alignof(E)!=0)
+                return fail(MappedArrayError::Type);
+            if (header.DataOffset<sizeof(header) || header.DataOffset>bytes.size() ||
+                header.Count>(bytes.size()-header.DataOffset)/sizeof(E))
+                return fail(MappedArrayError::Truncated);
+            if (error) *error = MappedArrayError::None;
+            return MappedArray(std::move(file), header);
+        }
+
+        // Writes header and elements; returns false on any I/O failure, leaving a partial file behind
+        static bool Write(const std::filesystem::path& path, std::span<const E> data,
+                          MappedArrayError* error = nullptr) {
+            const auto header = MappedArrayHeader::For<E>(data.size());
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size_bytes()));
+            out.close();
+            if (error) *error = out ? MappedArrayError::None : MappedArrayError::Write;
+            return bool(out);
+        }
+
+        MappedArray() noexcept = default;
+
+        const MappedArrayHeader& Header() const noexcept { return _Header; }
+        std::span<const E> Data() const noexcept { return _Data; }
+        size_t Size() const noexcept { return _Data.size(); }
+        const E& operator[](size_t idx) const noexcept { return _Data[idx]; }
+        auto begin() const noexcept { return _Data.begin(); }
+        auto end() const noexcept { return _Data.end(); }
+    private:
+        MappedArray(MappedFile&& file, const MappedArrayHeader& header) noexcept
+                :_File(std::move(file)), _Header(header),
+                 _Data(reinterpret_cast<const E*>(_File.Bytes().data()+header.DataOffset), size_t(header.Count)) { }
+
+        MappedFile _File;
+        MappedArrayHeader _Header{};
+        std::span<const E> _Data;
+    };
+}
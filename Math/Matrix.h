@@ -10,6 +10,7 @@
 #include "Matrix/42.h"
 #include "Matrix/43.h"
 #include "Matrix/44.h"
+#include "Matrix/44F.h"
 #include "Matrix/Generic.h"
 
 namespace Math {
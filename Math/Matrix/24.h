@@ -56,40 +56,40 @@ namespace Math {
         constexpr Mat operator/(const U& r) const noexcept { return {_Stg[0]/r, _Stg[1]/r}; }
         constexpr auto operator*(const Mat<T, 4, 2>& r) const noexcept {
             return Mat<T, 2, 2> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1)
             };
         }
         constexpr auto operator*(const Mat<T, 4, 3>& r) const noexcept {
             return Mat<T, 2, 3> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][2]*r(3, 2),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][2]*r(3, 2)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][3]*r(3, 2),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][3]*r(3, 2)
             };
         }
         constexpr auto operator*(const Mat<T, 4, 4>& r) const noexcept {
             return Mat {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][2]*r(3, 2),
-                    _Stg[0][0]*r(0, 3)+_Stg[0][1]*r(1, 3)+_Stg[0][2]*r(2, 3)+_Stg[0][2]*r(3, 3),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][2]*r(3, 2),
-                    _Stg[1][0]*r(0, 3)+_Stg[1][1]*r(1, 3)+_Stg[1][2]*r(2, 3)+_Stg[1][2]*r(3, 3)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][3]*r(3, 2),
+                    _Stg[0][0]*r(0, 3)+_Stg[0][1]*r(1, 3)+_Stg[0][2]*r(2, 3)+_Stg[0][3]*r(3, 3),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][3]*r(3, 2),
+                    _Stg[1][0]*r(0, 3)+_Stg[1][1]*r(1, 3)+_Stg[1][2]*r(2, 3)+_Stg[1][3]*r(3, 3)
             };
         }
         template <int Cr, class = std::enable_if_t<(Cr > 4)>>
         constexpr auto operator*(const Mat<T, 4, Cr>& r) const noexcept {
             Mat<T, 2, Cr> ret{};
             for (auto j = 0u; j<Cr; ++j) {
-                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][2]*r(3, j);
-                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][2]*r(3, j);
+                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][3]*r(3, j);
+                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][3]*r(3, j);
             }
             return ret;
         }
@@ -24,8 +24,8 @@ namespace Math {
                 RowType{std::forward<A>(m21), std::forward<S>(m22), std::forward<D>(m23), std::forward<F>(m24)},
                 RowType{std::forward<Z>(m31), std::forward<X>(m32), std::forward<C>(m33), std::forward<V>(m34)}} { }
 
-        RowType& operator[](int idx) noexcept { return _Stg[idx]; }
-        const RowType& operator[](int idx) const noexcept { return _Stg[idx]; }
+        constexpr RowType& operator[](int idx) noexcept { return _Stg[idx]; }
+        constexpr const RowType& operator[](int idx) const noexcept { return _Stg[idx]; }
         DataType& operator()(int row, int col) noexcept { return _Stg[row][col]; }
         const DataType& operator()(int row, int col) const noexcept { return _Stg[row][col]; }
 
@@ -64,60 +64,59 @@ namespace Math {
         constexpr Mat operator/(const U& r) const noexcept { return {_Stg[0]/r, _Stg[1]/r, _Stg[2]/r}; }
         constexpr auto operator*(const Mat<T, 4, 2>& r) const noexcept {
             return Mat<T, 3, 2> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][2]*r(3, 0),
-                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][2]*r(3, 1)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][3]*r(3, 0),
+                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][3]*r(3, 1)
             };
         }
         constexpr auto operator*(const Mat<T, 4, 3>& r) const noexcept {
             return Mat<T, 3, 3> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][2]*r(3, 2),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][2]*r(3, 2),
-                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][2]*r(3, 0),
-                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][2]*r(3, 1),
-                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][2]*r(3, 2)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][3]*r(3, 2),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][3]*r(3, 2),
+                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][3]*r(3, 0),
+                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][3]*r(3, 1),
+                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][3]*r(3, 2)
             };
         }
         constexpr auto operator*(const Mat<T, 4, 4>& r) const noexcept {
             return Mat {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][2]*r(3, 2),
-                    _Stg[0][0]*r(0, 3)+_Stg[0][1]*r(1, 3)+_Stg[0][2]*r(2, 3)+_Stg[0][2]*r(3, 3),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][2]*r(3, 2),
-                    _Stg[1][0]*r(0, 3)+_Stg[1][1]*r(1, 3)+_Stg[1][2]*r(2, 3)+_Stg[1][2]*r(3, 3),
-                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][2]*r(3, 0),
-                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][2]*r(3, 1),
-                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][2]*r(3, 2),
-                    _Stg[2][0]*r(0, 3)+_Stg[2][1]*r(1, 3)+_Stg[2][2]*r(2, 3)+_Stg[2][2]*r(3, 3)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][3]*r(3, 2),
+                    _Stg[0][0]*r(0, 3)+_Stg[0][1]*r(1, 3)+_Stg[0][2]*r(2, 3)+_Stg[0][3]*r(3, 3),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][3]*r(3, 2),
+                    _Stg[1][0]*r(0, 3)+_Stg[1][1]*r(1, 3)+_Stg[1][2]*r(2, 3)+_Stg[1][3]*r(3, 3),
+                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][3]*r(3, 0),
+                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][3]*r(3, 1),
+                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][3]*r(3, 2),
+                    _Stg[2][0]*r(0, 3)+_Stg[2][1]*r(1, 3)+_Stg[2][2]*r(2, 3)+_Stg[2][3]*r(3, 3)
             };
         }
         template <int Cr, class = std::enable_if_t<(Cr > 4)>>
         constexpr auto operator*(const Mat<T, 4, Cr>& r) const noexcept {
             Mat<T, 3, Cr> ret{};
             for (auto j = 0u; j<Cr; ++j) {
-                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][2]*r(3, j);
-                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][2]*r(3, j);
-                ret(2, j) += _Stg[2][0]*r(0, j)+_Stg[2][1]*r(1, j)+_Stg[2][2]*r(2, j)+_Stg[2][2]*r(3, j);
+                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][3]*r(3, j);
+                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][3]*r(3, j);
+                ret(2, j) += _Stg[2][0]*r(0, j)+_Stg[2][1]*r(1, j)+_Stg[2][2]*r(2, j)+_Stg[2][3]*r(3, j);
             }
             return ret;
         }
         Mat& operator*=(const Mat<T, 4, 4>& r) noexcept { return (*this = *this*r); }
-        constexpr auto operator*(const Vec<4, T>& r) noexcept {
+        constexpr auto operator*(const Vec<4, T>& r) const noexcept {
             return Vec<3, T>{_Stg[0][0]*r.Data[0]+_Stg[0][1]*r.Data[1]+_Stg[0][2]*r.Data[2]+_Stg[0][3]*r.Data[3],
                     _Stg[1][0]*r.Data[0]+_Stg[1][1]*r.Data[1]+_Stg[1][2]*r.Data[2]+_Stg[1][3]*r.Data[3],
                     _Stg[2][0]*r.Data[0]+_Stg[2][1]*r.Data[1]+_Stg[2][2]*r.Data[2]+_Stg[2][3]*r.Data[3]};
         }
-    private:
     private:
         RowType _Stg[3];
     };
@@ -21,7 +21,7 @@ namespace Math {
         constexpr Mat(Q&& m11, W&& m12, E&& m13,
                 A&& m21, S&& m22, D&& m23,
                 Z&& m31, X&& m32, C&& m33,
-                T&& m41, Y&& m42, I&& m43) noexcept
+                Y&& m41, U&& m42, I&& m43) noexcept
                 :_Stg{RowType{std::forward<Q>(m11), std::forward<W>(m12), std::forward<E>(m13)},
                 RowType{std::forward<A>(m21), std::forward<S>(m22), std::forward<D>(m23)},
                 RowType{std::forward<Z>(m31), std::forward<X>(m32), std::forward<C>(m33)},
@@ -85,7 +85,7 @@ namespace Math {
                     _Stg[3][0]*r(0, 1)+_Stg[3][1]*r(1, 1)+_Stg[3][2]*r(2, 1)
             };
         }
-        constexpr Mat operator*(const Mat& r) const noexcept {
+        constexpr Mat operator*(const Mat<T, 3, 3>& r) const noexcept {
             return {
                     _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0),
                     _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1),
@@ -132,7 +132,7 @@ namespace Math {
             }
             return ret;
         }
-        Mat& operator*=(const Mat& r) noexcept { return (*this = *this * r); }
+        Mat& operator*=(const Mat<T, 3, 3>& r) noexcept { return (*this = *this * r); }
         constexpr auto operator*(const Vec<3, T>& r) noexcept {
             return Vec<4, T>{_Stg[0][0]*r.Data[0]+_Stg[0][1]*r.Data[1]+_Stg[0][2]*r.Data[2],
                     _Stg[1][0]*r.Data[0]+_Stg[1][1]*r.Data[1]+_Stg[1][2]*r.Data[2],
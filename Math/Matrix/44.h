@@ -3,6 +3,87 @@
 #include "Base.h"
 
 namespace Math {
+    // Scalar 4x4 algorithms shared by the generic and SIMD specializations; M is indexed as m[row][col]
+    namespace Scalar {
+        template <class M>
+        constexpr M Transpose4(const M& m) noexcept {
+            return {
+                m[0][0], m[1][0], m[2][0], m[3][0],
+                m[0][1], m[1][1], m[2][1], m[3][1],
+                m[0][2], m[1][2], m[2][2], m[3][2],
+                m[0][3], m[1][3], m[2][3], m[3][3]
+            };
+        }
+
+        // 2x2 minors of the upper (s) and lower (c) row pairs
+        template <class M, class T>
+        constexpr void Minors4(const M& m, T (&s)[6], T (&c)[6]) noexcept {
+            s[0] = m[0][0]*m[1][1]-m[1][0]*m[0][1];
+            s[1] = m[0][0]*m[1][2]-m[1][0]*m[0][2];
+            s[2] = m[0][0]*m[1][3]-m[1][0]*m[0][3];
+            s[3] = m[0][1]*m[1][2]-m[1][1]*m[0][2];
+            s[4] = m[0][1]*m[1][3]-m[1][1]*m[0][3];
+            s[5] = m[0][2]*m[1][3]-m[1][2]*m[0][3];
+            c[0] = m[2][0]*m[3][1]-m[3][0]*m[2][1];
+            c[1] = m[2][0]*m[3][2]-m[3][0]*m[2][2];
+            c[2] = m[2][0]*m[3][3]-m[3][0]*m[2][3];
+            c[3] = m[2][1]*m[3][2]-m[3][1]*m[2][2];
+            c[4] = m[2][1]*m[3][3]-m[3][1]*m[2][3];
+            c[5] = m[2][2]*m[3][3]-m[3][2]*m[2][3];
+        }
+
+        template <class T, class M>
+        constexpr T Determinant4(const M& m) noexcept {
+            T s[6] {}, c[6] {};
+            Minors4(m, s, c);
+            return s[0]*c[5]-s[1]*c[4]+s[2]*c[3]+s[3]*c[2]-s[4]*c[1]+s[5]*c[0];
+        }
+
+        template <class T, class M>
+        constexpr M Inverse4(const M& m) noexcept {
+            T s[6] {}, c[6] {};
+            Minors4(m, s, c);
+            const T inv = T(1)/(s[0]*c[5]-s[1]*c[4]+s[2]*c[3]+s[3]*c[2]-s[4]*c[1]+s[5]*c[0]);
+            return {
+                (m[1][1]*c[5]-m[1][2]*c[4]+m[1][3]*c[3])*inv,
+                (-m[0][1]*c[5]+m[0][2]*c[4]-m[0][3]*c[3])*inv,
+                (m[3][1]*s[5]-m[3][2]*s[4]+m[3][3]*s[3])*inv,
+                (-m[2][1]*s[5]+m[2][2]*s[4]-m[2][3]*s[3])*inv,
+                (-m[1][0]*c[5]+m[1][2]*c[2]-m[1][3]*c[1])*inv,
+                (m[0][0]*c[5]-m[0][2]*c[2]+m[0][3]*c[1])*inv,
+                (-m[3][0]*s[5]+m[3][2]*s[2]-m[3][3]*s[1])*inv,
+                (m[2][0]*s[5]-m[2][2]*s[2]+m[2][3]*s[1])*inv,
+                (m[1][0]*c[4]-m[1][1]*c[2]+m[1][3]*c[0])*inv,
+                (-m[0][0]*c[4]+m[0][1]*c[2]-m[0][3]*c[0])*inv,
+                (m[3][0]*s[4]-m[3][1]*s[2]+m[3][3]*s[0])*inv,
+                (-m[2][0]*s[4]+m[2][1]*s[2]-m[2][3]*s[0])*inv,
+                (-m[1][0]*c[3]+m[1][1]*c[1]-m[1][2]*c[0])*inv,
+                (m[0][0]*c[3]-m[0][1]*c[1]+m[0][2]*c[0])*inv,
+                (-m[3][0]*s[3]+m[3][1]*s[1]-m[3][2]*s[0])*inv,
+                (m[2][0]*s[3]-m[2][1]*s[1]+m[2][2]*s[0])*inv
+            };
+        }
+
+        // [R|t; 0 0 0 1] -> [R^-1 | -R^-1 t; 0 0 0 1]; the bottom row of m is ignored
+        template <class T, class M>
+        constexpr M InverseAffine4(const M& m) noexcept {
+            const T i00 = m[1][1]*m[2][2]-m[1][2]*m[2][1], i01 = m[0][2]*m[2][1]-m[0][1]*m[2][2],
+                    i02 = m[0][1]*m[1][2]-m[0][2]*m[1][1];
+            const T i10 = m[1][2]*m[2][0]-m[1][0]*m[2][2], i11 = m[0][0]*m[2][2]-m[0][2]*m[2][0],
+                    i12 = m[0][2]*m[1][0]-m[0][0]*m[1][2];
+            const T i20 = m[1][0]*m[2][1]-m[1][1]*m[2][0], i21 = m[0][1]*m[2][0]-m[0][0]*m[2][1],
+                    i22 = m[0][0]*m[1][1]-m[0][1]*m[1][0];
+            const T inv = T(1)/(m[0][0]*i00+m[0][1]*i10+m[0][2]*i20);
+            const T tx = m[0][3], ty = m[1][3], tz = m[2][3];
+            return {
+                i00*inv, i01*inv, i02*inv, -(i00*tx+i01*ty+i02*tz)*inv,
+                i10*inv, i11*inv, i12*inv, -(i10*tx+i11*ty+i12*tz)*inv,
+                i20*inv, i21*inv, i22*inv, -(i20*tx+i21*ty+i22*tz)*inv,
+                T(0), T(0), T(0), T(1)
+            };
+        }
+    }
+
     template <class T>
     class Mat<T, 4, 4> {
     public:
@@ -27,8 +108,8 @@ namespace Math {
                 RowType{std::forward<Z>(m31), std::forward<X>(m32), std::forward<C>(m33), std::forward<V>(m34)},
                 RowType{std::forward<Y>(m41), std::forward<U>(m42), std::forward<I>(m43), std::forward<O>(m44)}} { }
 
-        RowType& operator[](int idx) noexcept { return _Stg[idx]; }
-        const RowType& operator[](int idx) const noexcept { return _Stg[idx]; }
+        constexpr RowType& operator[](int idx) noexcept { return _Stg[idx]; }
+        constexpr const RowType& operator[](int idx) const noexcept { return _Stg[idx]; }
         DataType& operator()(int row, int col) noexcept { return _Stg[row][col]; }
         const DataType& operator()(int row, int col) const noexcept { return _Stg[row][col]; }
 
@@ -75,30 +156,30 @@ namespace Math {
         constexpr Mat operator/(const U& r) const noexcept { return {_Stg[0]/r, _Stg[1]/r, _Stg[2]/r, _Stg[3]/r}; }
         constexpr auto operator*(const Mat<T, 4, 2>& r) const noexcept {
             return Mat<T, 4, 2> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][2]*r(3, 0),
-                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][2]*r(3, 1),
-                    _Stg[3][0]*r(0, 0)+_Stg[3][1]*r(1, 0)+_Stg[3][2]*r(2, 0)+_Stg[3][2]*r(3, 0),
-                    _Stg[3][0]*r(0, 1)+_Stg[3][1]*r(1, 1)+_Stg[3][2]*r(2, 1)+_Stg[3][2]*r(3, 1)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][3]*r(3, 0),
+                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][3]*r(3, 1),
+                    _Stg[3][0]*r(0, 0)+_Stg[3][1]*r(1, 0)+_Stg[3][2]*r(2, 0)+_Stg[3][3]*r(3, 0),
+                    _Stg[3][0]*r(0, 1)+_Stg[3][1]*r(1, 1)+_Stg[3][2]*r(2, 1)+_Stg[3][3]*r(3, 1)
             };
         }
         constexpr auto operator*(const Mat<T, 4, 3>& r) const noexcept {
             return Mat<T, 4, 3> {
-                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][2]*r(3, 0),
-                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][2]*r(3, 1),
-                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][2]*r(3, 2),
-                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][2]*r(3, 0),
-                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][2]*r(3, 1),
-                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][2]*r(3, 2),
-                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][2]*r(3, 0),
-                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][2]*r(3, 1),
-                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][2]*r(3, 2),
-                    _Stg[3][0]*r(0, 0)+_Stg[3][1]*r(1, 0)+_Stg[3][2]*r(2, 0)+_Stg[3][2]*r(3, 0),
-                    _Stg[3][0]*r(0, 1)+_Stg[3][1]*r(1, 1)+_Stg[3][2]*r(2, 1)+_Stg[3][2]*r(3, 1),
-                    _Stg[3][0]*r(0, 2)+_Stg[3][1]*r(1, 2)+_Stg[3][2]*r(2, 2)+_Stg[3][2]*r(3, 2)
+                    _Stg[0][0]*r(0, 0)+_Stg[0][1]*r(1, 0)+_Stg[0][2]*r(2, 0)+_Stg[0][3]*r(3, 0),
+                    _Stg[0][0]*r(0, 1)+_Stg[0][1]*r(1, 1)+_Stg[0][2]*r(2, 1)+_Stg[0][3]*r(3, 1),
+                    _Stg[0][0]*r(0, 2)+_Stg[0][1]*r(1, 2)+_Stg[0][2]*r(2, 2)+_Stg[0][3]*r(3, 2),
+                    _Stg[1][0]*r(0, 0)+_Stg[1][1]*r(1, 0)+_Stg[1][2]*r(2, 0)+_Stg[1][3]*r(3, 0),
+                    _Stg[1][0]*r(0, 1)+_Stg[1][1]*r(1, 1)+_Stg[1][2]*r(2, 1)+_Stg[1][3]*r(3, 1),
+                    _Stg[1][0]*r(0, 2)+_Stg[1][1]*r(1, 2)+_Stg[1][2]*r(2, 2)+_Stg[1][3]*r(3, 2),
+                    _Stg[2][0]*r(0, 0)+_Stg[2][1]*r(1, 0)+_Stg[2][2]*r(2, 0)+_Stg[2][3]*r(3, 0),
+                    _Stg[2][0]*r(0, 1)+_Stg[2][1]*r(1, 1)+_Stg[2][2]*r(2, 1)+_Stg[2][3]*r(3, 1),
+                    _Stg[2][0]*r(0, 2)+_Stg[2][1]*r(1, 2)+_Stg[2][2]*r(2, 2)+_Stg[2][3]*r(3, 2),
+                    _Stg[3][0]*r(0, 0)+_Stg[3][1]*r(1, 0)+_Stg[3][2]*r(2, 0)+_Stg[3][3]*r(3, 0),
+                    _Stg[3][0]*r(0, 1)+_Stg[3][1]*r(1, 1)+_Stg[3][2]*r(2, 1)+_Stg[3][3]*r(3, 1),
+                    _Stg[3][0]*r(0, 2)+_Stg[3][1]*r(1, 2)+_Stg[3][2]*r(2, 2)+_Stg[3][3]*r(3, 2)
             };
         }
         constexpr Mat operator*(const Mat& r) const noexcept {
@@ -123,22 +204,28 @@ namespace Math {
         }
         template <int Cr, class = std::enable_if_t<(Cr > 4)>>
         constexpr auto operator*(const Mat<T, 4, Cr>& r) const noexcept {
-            Mat<T, 3, Cr> ret{};
+            Mat<T, 4, Cr> ret{};
             for (auto j = 0u; j<Cr; ++j) {
-                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][2]*r(3, j);
-                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][2]*r(3, j);
-                ret(2, j) += _Stg[2][0]*r(0, j)+_Stg[2][1]*r(1, j)+_Stg[2][2]*r(2, j)+_Stg[2][2]*r(3, j);
-                ret(3, j) += _Stg[3][0]*r(0, j)+_Stg[3][1]*r(1, j)+_Stg[3][2]*r(2, j)+_Stg[3][2]*r(3, j);
+                ret(0, j) += _Stg[0][0]*r(0, j)+_Stg[0][1]*r(1, j)+_Stg[0][2]*r(2, j)+_Stg[0][3]*r(3, j);
+                ret(1, j) += _Stg[1][0]*r(0, j)+_Stg[1][1]*r(1, j)+_Stg[1][2]*r(2, j)+_Stg[1][3]*r(3, j);
+                ret(2, j) += _Stg[2][0]*r(0, j)+_Stg[2][1]*r(1, j)+_Stg[2][2]*r(2, j)+_Stg[2][3]*r(3, j);
+                ret(3, j) += _Stg[3][0]*r(0, j)+_Stg[3][1]*r(1, j)+_Stg[3][2]*r(2, j)+_Stg[3][3]*r(3, j);
             }
             return ret;
         }
         Mat& operator*=(const Mat& r) noexcept { return (*this = *this*r); }
-        constexpr auto operator*(const Vec<4, T>& r) noexcept {
-            return Vec<3, T>{_Stg[0][0]*r.Data[0]+_Stg[0][1]*r.Data[1]+_Stg[0][2]*r.Data[2]+_Stg[0][3]*r.Data[3],
+        constexpr auto operator*(const Vec<4, T>& r) const noexcept {
+            return Vec<4, T>{_Stg[0][0]*r.Data[0]+_Stg[0][1]*r.Data[1]+_Stg[0][2]*r.Data[2]+_Stg[0][3]*r.Data[3],
                     _Stg[1][0]*r.Data[0]+_Stg[1][1]*r.Data[1]+_Stg[1][2]*r.Data[2]+_Stg[1][3]*r.Data[3],
                     _Stg[2][0]*r.Data[0]+_Stg[2][1]*r.Data[1]+_Stg[2][2]*r.Data[2]+_Stg[2][3]*r.Data[3],
                     _Stg[3][0]*r.Data[0]+_Stg[3][1]*r.Data[1]+_Stg[3][2]*r.Data[2]+_Stg[3][3]*r.Data[3]};
         }
+        constexpr Mat Transpose() const noexcept { return Scalar::Transpose4(*this); }
+        constexpr T Determinant() const noexcept { return Scalar::Determinant4<T>(*this); }
+        // singular matrices yield non-finite entries
+        constexpr Mat Inverse() const noexcept { return Scalar::Inverse4<T>(*this); }
+        // for [R|t; 0 0 0 1] transforms (column vectors); cheaper than Inverse()
+        constexpr Mat InverseAffine() const noexcept { return Scalar::InverseAffine4<T>(*this); }
         constexpr static Mat Identity() noexcept {
             return {
                 1.0, 0.0, 0.0, 0.0,
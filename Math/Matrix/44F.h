@@ -0,0 +1,311 @@
+#pragma once
+
+#include "42.h"
+#include "43.h"
+#include "44.h"
+#include "../SIMD/Config.h"
+
+#if MATH_SIMD_LEVEL > 0
+namespace Math {
+    namespace SIMD {
+        inline __m128 Splat(__m128 v, std::integral_constant<int, 0>) noexcept { return _mm_shuffle_ps(v, v, 0x00); }
+        inline __m128 Splat(__m128 v, std::integral_constant<int, 1>) noexcept { return _mm_shuffle_ps(v, v, 0x55); }
+        inline __m128 Splat(__m128 v, std::integral_constant<int, 2>) noexcept { return _mm_shuffle_ps(v, v, 0xAA); }
+        inline __m128 Splat(__m128 v, std::integral_constant<int, 3>) noexcept { return _mm_shuffle_ps(v, v, 0xFF); }
+
+        inline __m128 MulAdd(__m128 a, __m128 b, __m128 c) noexcept {
+#if defined(MATH_SIMD_FMA)
+            return _mm_fmadd_ps(a, b, c);
+#else
+            return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+        }
+
+        // l * [r0; r1; r2; r3] for a row vector l
+        inline __m128 RowCombine(__m128 l, __m128 r0, __m128 r1, __m128 r2, __m128 r3) noexcept {
+            auto ret = _mm_mul_ps(Splat(l, std::integral_constant<int, 0>{}), r0);
+            ret = MulAdd(Splat(l, std::integral_constant<int, 1>{}), r1, ret);
+            ret = MulAdd(Splat(l, std::integral_constant<int, 2>{}), r2, ret);
+            return MulAdd(Splat(l, std::integral_constant<int, 3>{}), r3, ret);
+        }
+
+        // 2x2 blocks packed row-major in one register: (a00, a01, a10, a11)
+        // a * b
+        inline __m128 Mat2Mul(__m128 a, __m128 b) noexcept {
+            return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+        }
+        // adj(a) * b
+        inline __m128 Mat2AdjMul(__m128 a, __m128 b) noexcept {
+            return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+        // a * adj(b)
+        inline __m128 Mat2MulAdj(__m128 a, __m128 b) noexcept {
+            return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                    _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+        }
+
+        inline __m128 HorizontalSum(__m128 v) noexcept {
+            v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        }
+
+        // l x r in xyz; w is zero
+        inline __m128 Cross(__m128 l, __m128 r) noexcept {
+            const auto lyzx = _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 0, 2, 1)), ryzx = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 0, 2, 1));
+            const auto c = _mm_sub_ps(_mm_mul_ps(l, ryzx), _mm_mul_ps(lyzx, r));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+    }
+
+    template <>
+    class Mat<float, 4, 4> {
+    public:
+        using T = float;
+        using DataType = T;
+        using RowType = Vec4<T>;
+        using ColType = Vec4<T>;
+
+        constexpr Mat() = default;
+        template <class Q, class W, class E, class R>
+        constexpr Mat(const Vec4<Q>& m1, const Vec4<W>& m2, const Vec4<E>& m3, const Vec4<R>& m4) noexcept
+                : _Stg{RowType(m1), RowType(m2), RowType(m3), RowType(m4)} { }
+        template <class Q, class W, class E, class R,
+                  class A, class S, class D, class F,
+                  class Z, class X, class C, class V,
+                  class Y, class U, class I, class O>
+        constexpr Mat(Q&& m11, W&& m12, E&& m13, R&& m14,
+                A&& m21, S&& m22, D&& m23, F&& m24,
+                Z&& m31, X&& m32, C&& m33, V&& m34,
+                Y&& m41, U&& m42, I&& m43, O&& m44) noexcept
+                :_Stg{RowType{std::forward<Q>(m11), std::forward<W>(m12), std::forward<E>(m13), std::forward<R>(m14)},
+                RowType{std::forward<A>(m21), std::forward<S>(m22), std::forward<D>(m23), std::forward<F>(m24)},
+                RowType{std::forward<Z>(m31), std::forward<X>(m32), std::forward<C>(m33), std::forward<V>(m34)},
+                RowType{std::forward<Y>(m41), std::forward<U>(m42), std::forward<I>(m43), std::forward<O>(m44)}} { }
+
+        constexpr RowType& operator[](int idx) noexcept { return _Stg[idx]; }
+        constexpr const RowType& operator[](int idx) const noexcept { return _Stg[idx]; }
+        DataType& operator()(int row, int col) noexcept { return _Stg[row][col]; }
+        const DataType& operator()(int row, int col) const noexcept { return _Stg[row][col]; }
+
+        Mat& operator+=(const Mat& r) noexcept {
+            _Stg[0] += r[0];
+            _Stg[1] += r[1];
+            _Stg[2] += r[2];
+            _Stg[3] += r[3];
+            return *this;
+        }
+        Mat& operator-=(const Mat& r) noexcept {
+            _Stg[0] -= r[0];
+            _Stg[1] -= r[1];
+            _Stg[2] -= r[2];
+            _Stg[3] -= r[3];
+            return *this;
+        }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        Mat& operator*=(const U& r) noexcept {
+            _Stg[0] *= r;
+            _Stg[1] *= r;
+            _Stg[2] *= r;
+            _Stg[3] *= r;
+            return *this;
+        }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        Mat& operator/=(const U& r) noexcept {
+            _Stg[0] /= r;
+            _Stg[1] /= r;
+            _Stg[2] /= r;
+            _Stg[3] /= r;
+            return *this;
+        }
+        constexpr Mat operator-() const noexcept { return {-_Stg[0], -_Stg[1], -_Stg[2], -_Stg[3]}; }
+        constexpr Mat operator+(const Mat& r) const noexcept {
+            return {_Stg[0]+r._Stg[0], _Stg[1]+r._Stg[1], _Stg[2]+r._Stg[2], _Stg[3]+r._Stg[3]};
+        }
+        constexpr Mat operator-(const Mat& r) const noexcept {
+            return {_Stg[0]-r._Stg[0], _Stg[1]-r._Stg[1], _Stg[2]-r._Stg[2], _Stg[3]-r._Stg[3]};
+        }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        constexpr Mat operator*(const U& r) const noexcept { return {_Stg[0]*r, _Stg[1]*r, _Stg[2]*r, _Stg[3]*r}; }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        constexpr Mat operator/(const U& r) const noexcept { return {_Stg[0]/r, _Stg[1]/r, _Stg[2]/r, _Stg[3]/r}; }
+        constexpr auto operator*(const Mat<T, 4, 2>& r) const noexcept {
+            Mat<T, 4, 2> ret{};
+            for (auto i = 0; i<4; ++i)
+                for (auto j = 0; j<2; ++j)
+                    ret(i, j) = _Stg[i].Data[0]*r(0, j)+_Stg[i].Data[1]*r(1, j)+_Stg[i].Data[2]*r(2, j)+
+                            _Stg[i].Data[3]*r(3, j);
+            return ret;
+        }
+        constexpr auto operator*(const Mat<T, 4, 3>& r) const noexcept {
+            Mat<T, 4, 3> ret{};
+            for (auto i = 0; i<4; ++i)
+                for (auto j = 0; j<3; ++j)
+                    ret(i, j) = _Stg[i].Data[0]*r(0, j)+_Stg[i].Data[1]*r(1, j)+_Stg[i].Data[2]*r(2, j)+
+                            _Stg[i].Data[3]*r(3, j);
+            return ret;
+        }
+        constexpr Mat operator*(const Mat& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) {
+                Mat ret{};
+                for (auto i = 0; i<4; ++i)
+                    for (auto j = 0; j<4; ++j)
+                        ret._Stg[i].Data[j] = _Stg[i].Data[0]*r._Stg[0].Data[j]+_Stg[i].Data[1]*r._Stg[1].Data[j]+
+                                _Stg[i].Data[2]*r._Stg[2].Data[j]+_Stg[i].Data[3]*r._Stg[3].Data[j];
+                return ret;
+            }
+            Mat ret{};
+            Multiply(*this, r, ret);
+            return ret;
+        }
+        template <int Cr, class = std::enable_if_t<(Cr > 4)>>
+        constexpr auto operator*(const Mat<T, 4, Cr>& r) const noexcept {
+            Mat<T, 4, Cr> ret{};
+            for (auto i = 0; i<4; ++i)
+                for (auto j = 0; j<Cr; ++j)
+                    ret(i, j) = _Stg[i].Data[0]*r(0, j)+_Stg[i].Data[1]*r(1, j)+_Stg[i].Data[2]*r(2, j)+
+                            _Stg[i].Data[3]*r(3, j);
+            return ret;
+        }
+        Mat& operator*=(const Mat& r) noexcept {
+            Multiply(*this, r, *this);
+            return *this;
+        }
+        constexpr auto operator*(const Vec<4, T>& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED())
+                return Vec<4, T>{_Stg[0].Dot(r), _Stg[1].Dot(r), _Stg[2].Dot(r), _Stg[3].Dot(r)};
+            const auto v = r.Load();
+            auto m0 = _mm_mul_ps(_Stg[0].Load(), v);
+            auto m1 = _mm_mul_ps(_Stg[1].Load(), v);
+            auto m2 = _mm_mul_ps(_Stg[2].Load(), v);
+            auto m3 = _mm_mul_ps(_Stg[3].Load(), v);
+            _MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+            return Vec<4, T>(_mm_add_ps(_mm_add_ps(m0, m1), _mm_add_ps(m2, m3)));
+        }
+        constexpr Mat Transpose() const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return Scalar::Transpose4(*this);
+            auto r0 = _Stg[0].Load(), r1 = _Stg[1].Load(), r2 = _Stg[2].Load(), r3 = _Stg[3].Load();
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            return FromRows(r0, r1, r2, r3);
+        }
+        constexpr T Determinant() const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return Scalar::Determinant4<T>(*this);
+            __m128 a, b, c, d, det;
+            Blocks(a, b, c, d, det);
+            const auto ab = SIMD::Mat2AdjMul(a, b), dc = SIMD::Mat2AdjMul(d, c);
+            const auto tr = SIMD::HorizontalSum(_mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0))));
+            const auto m = _mm_mul_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 1, 2, 3)));
+            return _mm_cvtss_f32(_mm_sub_ss(_mm_add_ss(m, _mm_shuffle_ps(m, m, 1)), tr));
+        }
+        // Block-wise 2x2 inversion. Singular matrices yield non-finite entries.
+        constexpr Mat Inverse() const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return Scalar::Inverse4<T>(*this);
+            __m128 a, b, c, d, det;
+            Blocks(a, b, c, d, det);
+            const auto detA = _mm_shuffle_ps(det, det, 0x00), detB = _mm_shuffle_ps(det, det, 0x55);
+            const auto detC = _mm_shuffle_ps(det, det, 0xAA), detD = _mm_shuffle_ps(det, det, 0xFF);
+            const auto ab = SIMD::Mat2AdjMul(a, b), dc = SIMD::Mat2AdjMul(d, c);
+            auto x = _mm_sub_ps(_mm_mul_ps(detD, a), SIMD::Mat2Mul(b, dc));
+            auto w = _mm_sub_ps(_mm_mul_ps(detA, d), SIMD::Mat2Mul(c, ab));
+            auto y = _mm_sub_ps(_mm_mul_ps(detB, c), SIMD::Mat2MulAdj(d, ab));
+            auto z = _mm_sub_ps(_mm_mul_ps(detC, b), SIMD::Mat2MulAdj(a, dc));
+            const auto tr = SIMD::HorizontalSum(_mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0))));
+            const auto detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+            const auto rcp = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+            x = _mm_mul_ps(x, rcp);
+            y = _mm_mul_ps(y, rcp);
+            z = _mm_mul_ps(z, rcp);
+            w = _mm_mul_ps(w, rcp);
+            return FromRows(_mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)),
+                    _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)), _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+        }
+        // For [R|t; 0 0 0 1] transforms (column vectors). The columns of R^-1 are the cross products of the rows of R.
+        constexpr Mat InverseAffine() const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return Scalar::InverseAffine4<T>(*this);
+            const auto xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+            const auto r0 = _Stg[0].Load(), r1 = _Stg[1].Load(), r2 = _Stg[2].Load();
+            const auto a0 = _mm_and_ps(r0, xyz), a1 = _mm_and_ps(r1, xyz), a2 = _mm_and_ps(r2, xyz);
+            auto c0 = SIMD::Cross(a1, a2), c1 = SIMD::Cross(a2, a0), c2 = SIMD::Cross(a0, a1);
+            const auto rcp = _mm_div_ps(_mm_set1_ps(1.0f), SIMD::HorizontalSum(_mm_mul_ps(a0, c0)));
+            c0 = _mm_mul_ps(c0, rcp);
+            c1 = _mm_mul_ps(c1, rcp);
+            c2 = _mm_mul_ps(c2, rcp);
+            auto t = _mm_mul_ps(c0, _mm_shuffle_ps(r0, r0, 0xFF));
+            t = SIMD::MulAdd(c1, _mm_shuffle_ps(r1, r1, 0xFF), t);
+            t = SIMD::MulAdd(c2, _mm_shuffle_ps(r2, r2, 0xFF), t);
+            t = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), t);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, t);
+            return FromRows(c0, c1, c2, t);
+        }
+        constexpr static Mat Identity() noexcept {
+            return {
+                1.0, 0.0, 0.0, 0.0,
+                0.0, 1.0, 0.0, 0.0,
+                0.0, 0.0, 1.0, 0.0,
+                0.0, 0.0, 0.0, 1.0
+            };
+        }
+    private:
+        static Mat FromRows(__m128 r0, __m128 r1, __m128 r2, __m128 r3) noexcept {
+            Mat ret;
+            ret._Stg[0].Store(r0);
+            ret._Stg[1].Store(r1);
+            ret._Stg[2].Store(r2);
+            ret._Stg[3].Store(r3);
+            return ret;
+        }
+
+        // 2x2 blocks [a b; c d] and their determinants (|a|, |b|, |c|, |d|)
+        void Blocks(__m128& a, __m128& b, __m128& c, __m128& d, __m128& det) const noexcept {
+            const auto r0 = _Stg[0].Load(), r1 = _Stg[1].Load(), r2 = _Stg[2].Load(), r3 = _Stg[3].Load();
+            a = _mm_movelh_ps(r0, r1);
+            b = _mm_movehl_ps(r1, r0);
+            c = _mm_movelh_ps(r2, r3);
+            d = _mm_movehl_ps(r3, r2);
+            det = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+                    _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+        }
+
+        // out may alias l or r
+        static void Multiply(const Mat& l, const Mat& r, Mat& out) noexcept {
+#if defined(MATH_SIMD_AVX2)
+            const auto r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r._Stg[0].Data));
+            const auto r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r._Stg[1].Data));
+            const auto r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r._Stg[2].Data));
+            const auto r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(r._Stg[3].Data));
+            const auto l01 = _mm256_loadu_ps(l._Stg[0].Data);
+            const auto l23 = _mm256_loadu_ps(l._Stg[2].Data);
+            auto o01 = _mm256_mul_ps(_mm256_shuffle_ps(l01, l01, 0x00), r0);
+            auto o23 = _mm256_mul_ps(_mm256_shuffle_ps(l23, l23, 0x00), r0);
+            o01 = _mm256_fmadd_ps(_mm256_shuffle_ps(l01, l01, 0x55), r1, o01);
+            o23 = _mm256_fmadd_ps(_mm256_shuffle_ps(l23, l23, 0x55), r1, o23);
+            o01 = _mm256_fmadd_ps(_mm256_shuffle_ps(l01, l01, 0xAA), r2, o01);
+            o23 = _mm256_fmadd_ps(_mm256_shuffle_ps(l23, l23, 0xAA), r2, o23);
+            o01 = _mm256_fmadd_ps(_mm256_shuffle_ps(l01, l01, 0xFF), r3, o01);
+            o23 = _mm256_fmadd_ps(_mm256_shuffle_ps(l23, l23, 0xFF), r3, o23);
+            _mm256_storeu_ps(out._Stg[0].Data, o01);
+            _mm256_storeu_ps(out._Stg[2].Data, o23);
+#else
+            const auto r0 = r._Stg[0].Load(), r1 = r._Stg[1].Load(), r2 = r._Stg[2].Load(), r3 = r._Stg[3].Load();
+            const auto o0 = SIMD::RowCombine(l._Stg[0].Load(), r0, r1, r2, r3);
+            const auto o1 = SIMD::RowCombine(l._Stg[1].Load(), r0, r1, r2, r3);
+            const auto o2 = SIMD::RowCombine(l._Stg[2].Load(), r0, r1, r2, r3);
+            const auto o3 = SIMD::RowCombine(l._Stg[3].Load(), r0, r1, r2, r3);
+            out._Stg[0].Store(o0);
+            out._Stg[1].Store(o1);
+            out._Stg[2].Store(o2);
+            out._Stg[3].Store(o3);
+#endif
+        }
+
+        RowType _Stg[4];
+    };
+
+    constexpr Vec<4, float> operator*(const Vec<4, float>& l, const Mat<float, 4, 4>& r) noexcept {
+        if (MATH_IS_CONSTANT_EVALUATED())
+            return r[0]*l.Data[0] + r[1]*l.Data[1] + r[2]*l.Data[2] + r[3]*l.Data[3];
+        return Vec<4, float>(SIMD::RowCombine(l.Load(), r[0].Load(), r[1].Load(), r[2].Load(), r[3].Load()));
+    }
+}
+#endif
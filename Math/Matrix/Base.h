@@ -4,7 +4,7 @@
 
 namespace Math {
     template <class T, int C, int Cr, class = std::enable_if_t<(C > 4)>>
-    constexpr auto operator*(const Vec<C, T>& l, const Mat<T, C, Cr>& r) noexcept {
+    constexpr auto operator*(const Vec<size_t(C), T>& l, const Mat<T, C, Cr>& r) noexcept {
         Vec<Cr, T> ret{};
         for (auto j = 0u; j<Cr; ++j)
             for (auto k = 0u; k<C; ++k)
@@ -13,7 +13,7 @@ namespace Math {
     }
 
     template <class T, int C>
-    constexpr auto& operator*=(Vec<C, T>& l, const Mat<T, C, C>& r) noexcept { return (l = l * r); }
+    constexpr auto& operator*=(Vec<size_t(C), T>& l, const Mat<T, C, C>& r) noexcept { return (l = l * r); }
 
     template <class T, int Cr, class = std::enable_if_t<(Cr > 4)>>
     constexpr auto operator*(const Vec<2, T>& l, const Mat<T, 2, Cr>& r) noexcept {
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include "../Parallel.h"
+#include "../SIMD/CPU.h"
+#include "../SIMD/F32x8.h"
+
+// Cache-blocked general matrix multiply, C = A * B, on row-major storage with explicit leading dimensions.
+// Follows the Goto/BLIS loop order: a KC x NC panel of B and an MC x KC block of A are packed into contiguous
+// MR- and NR-wide micro-panels, and a register-tiled micro-kernel computes each MR x NR tile of C from them.
+// The micro-kernel and its tile shape are picked once per process: AVX-512F, AVX2+FMA or portable F32x8 for
+// float, AVX2+FMA for double, and a plain template kernel otherwise. Products of at least GemmParallelWork
+// multiply-adds split the MC blocks over the default thread pool.
+namespace Math {
+    namespace SIMD {
+        // cache blocking; MC must be a multiple of every kernel's MR
+        template <class T>
+        struct GemmTile {
+            static constexpr size_t KC = 256, MC = 72, NC = 2048, MaxTile = 6*8;
+        };
+
+        template <>
+        struct GemmTile<float> {
+            static constexpr size_t KC = 256, MC = 72, NC = 4096, MaxTile = 12*32;
+        };
+
+        // computes one MR x NR tile of c from kc columns of MR values in a and kc rows of NR values in b
+        template <class T>
+        using GemmKernel = void (*)(size_t kc, const T* a, const T* b, T* c, size_t ldc, bool accumulate) noexcept;
+
+        template <class T>
+        struct GemmMicro {
+            GemmKernel<T> Kernel;
+            size_t MR, NR;
+        };
+
+        template <class T>
+        void GemmMicroScalar(size_t kc, const T* a, const T* b, T* c, size_t ldc, bool accumulate) noexcept {
+            constexpr auto MR = 4u, NR = 8u;
+            T acc[MR][NR]{};
+            for (auto k = size_t(0); k<kc; ++k, a += MR, b += NR)
+                for (auto i = 0u; i<MR; ++i)
+                    for (auto j = 0u; j<NR; ++j) acc[i][j] += a[i]*b[j];
+            for (auto i = 0u; i<MR; ++i)
+                for (auto j = 0u; j<NR; ++j) c[i*ldc+j] = accumulate ? c[i*ldc+j]+acc[i][j] : acc[i][j];
+        }
+
+        // 6 x 16 tile as two 6 x 8 halves, so the SSE form of F32x8 keeps its accumulators in registers
+        inline void GemmMicroF32x8(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) noexcept {
+            for (auto h = 0u; h<16; h += 8) {
+                auto c0 = F32x8::Zero(), c1 = F32x8::Zero(), c2 = F32x8::Zero();
+                auto c3 = F32x8::Zero(), c4 = F32x8::Zero(), c5 = F32x8::Zero();
+                auto pa = a;
+                auto pb = b+h;
+                for (auto k = size_t(0); k<kc; ++k, pa += 6, pb += 16) {
+                    const auto bv = F32x8::Load(pb);
+                    c0 = MulAdd(F32x8::Broadcast(pa[0]), bv, c0);
+                    c1 = MulAdd(F32x8::Broadcast(pa[1]), bv, c1);
+                    c2 = MulAdd(F32x8::Broadcast(pa[2]), bv, c2);
+                    c3 = MulAdd(F32x8::Broadcast(pa[3]), bv, c3);
+                    c4 = MulAdd(F32x8::Broadcast(pa[4]), bv, c4);
+                    c5 = MulAdd(F32x8::Broadcast(pa[5]), bv, c5);
+                }
+                const F32x8* rows[6] = {&c0, &c1, &c2, &c3, &c4, &c5};
+                for (auto i = 0u; i<6; ++i) {
+                    const auto p = c+i*ldc+h;
+                    (accumulate ? F32x8::Load(p)+*rows[i] : *rows[i]).Store(p);
+                }
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        MATH_TARGET("avx2,fma")
+        inline void GemmStoreAVX2(float* p, __m256 lo, __m256 hi, bool accumulate) noexcept {
+            if (accumulate) lo = _mm256_add_ps(lo, _mm256_loadu_ps(p)), hi = _mm256_add_ps(hi, _mm256_loadu_ps(p+8));
+            _mm256_storeu_ps(p, lo);
+            _mm256_storeu_ps(p+8, hi);
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline void GemmMicroAVX2(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) noexcept {
+            auto c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+            auto c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+            auto c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+            for (auto k = size_t(0); k<kc; ++k, a += 6, b += 16) {
+                const auto b0 = _mm256_load_ps(b), b1 = _mm256_load_ps(b+8);
+                auto av = _mm256_broadcast_ss(a);
+                c00 = _mm256_fmadd_ps(av, b0, c00), c01 = _mm256_fmadd_ps(av, b1, c01);
+                av = _mm256_broadcast_ss(a+1);
+                c10 = _mm256_fmadd_ps(av, b0, c10), c11 = _mm256_fmadd_ps(av, b1, c11);
+                av = _mm256_broadcast_ss(a+2);
+                c20 = _mm256_fmadd_ps(av, b0, c20), c21 = _mm256_fmadd_ps(av, b1, c21);
+                av = _mm256_broadcast_ss(a+3);
+                c30 = _mm256_fmadd_ps(av, b0, c30), c31 = _mm256_fmadd_ps(av, b1, c31);
+                av = _mm256_broadcast_ss(a+4);
+                c40 = _mm256_fmadd_ps(av, b0, c40), c41 = _mm256_fmadd_ps(av, b1, c41);
+                av = _mm256_broadcast_ss(a+5);
+                c50 = _mm256_fmadd_ps(av, b0, c50), c51 = _mm256_fmadd_ps(av, b1, c51);
+            }
+            GemmStoreAVX2(c, c00, c01, accumulate);
+            GemmStoreAVX2(c+ldc, c10, c11, accumulate);
+            GemmStoreAVX2(c+2*ldc, c20, c21, accumulate);
+            GemmStoreAVX2(c+3*ldc, c30, c31, accumulate);
+            GemmStoreAVX2(c+4*ldc, c40, c41, accumulate);
+            GemmStoreAVX2(c+5*ldc, c50, c51, accumulate);
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline void GemmMicroAVX2(size_t kc, const double* a, const double* b, double* c, size_t ldc, bool accumulate) noexcept {
+            // 6 x 8 tile
+            __m256d acc[6][2];
+            for (auto i = 0; i<6; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_pd();
+            for (auto k = size_t(0); k<kc; ++k, a += 6, b += 8) {
+                const auto b0 = _mm256_load_pd(b), b1 = _mm256_load_pd(b+4);
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC unroll 6
+#endif
+                for (auto i = 0; i<6; ++i) {
+                    const auto av = _mm256_broadcast_sd(a+i);
+                    acc[i][0] = _mm256_fmadd_pd(av, b0, acc[i][0]);
+                    acc[i][1] = _mm256_fmadd_pd(av, b1, acc[i][1]);
+                }
+            }
+            for (auto i = 0; i<6; ++i, c += ldc) {
+                if (accumulate) {
+                    acc[i][0] = _mm256_add_pd(acc[i][0], _mm256_loadu_pd(c));
+                    acc[i][1] = _mm256_add_pd(acc[i][1], _mm256_loadu_pd(c+4));
+                }
+                _mm256_storeu_pd(c, acc[i][0]);
+                _mm256_storeu_pd(c+4, acc[i][1]);
+            }
+        }
+
+        MATH_TARGET("avx512f")
+        inline void GemmMicroAVX512(size_t kc, const float* a, const float* b, float* c, size_t ldc, bool accumulate) noexcept {
+            // 12 x 32 tile, 24 accumulators
+            __m512 acc[12][2];
+            for (auto i = 0; i<12; ++i) acc[i][0] = acc[i][1] = _mm512_setzero_ps();
+            for (auto k = size_t(0); k<kc; ++k, a += 12, b += 32) {
+                const auto b0 = _mm512_load_ps(b), b1 = _mm512_load_ps(b+16);
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC unroll 12
+#endif
+                for (auto i = 0; i<12; ++i) {
+                    const auto av = _mm512_set1_ps(a[i]);
+                    acc[i][0] = _mm512_fmadd_ps(av, b0, acc[i][0]);
+                    acc[i][1] = _mm512_fmadd_ps(av, b1, acc[i][1]);
+                }
+            }
+            for (auto i = 0; i<12; ++i, c += ldc) {
+                if (accumulate) {
+                    acc[i][0] = _mm512_add_ps(acc[i][0], _mm512_loadu_ps(c));
+                    acc[i][1] = _mm512_add_ps(acc[i][1], _mm512_loadu_ps(c+16));
+                }
+                _mm512_storeu_ps(c, acc[i][0]);
+                _mm512_storeu_ps(c+16, acc[i][1]);
+            }
+        }
+#endif
+
+        template <class T>
+        GemmMicro<T> SelectGemmMicro() noexcept {
+            if constexpr (std::is_same_v<T, float>) {
+#if defined(MATH_SIMD_SSE2)
+                const auto& cpu = CPU();
+                if (cpu.AVX512F) return {&GemmMicroAVX512, 12, 32};
+                if (cpu.AVX2 && cpu.FMA) return {static_cast<GemmKernel<float>>(&GemmMicroAVX2), 6, 16};
+#endif
+                return {&GemmMicroF32x8, 6, 16};
+            }
+#if defined(MATH_SIMD_SSE2)
+            else if constexpr (std::is_same_v<T, double>) {
+                const auto& cpu = CPU();
+                if (cpu.AVX2 && cpu.FMA) return {static_cast<GemmKernel<double>>(&GemmMicroAVX2), 6, 8};
+                return {&GemmMicroScalar<T>, 4, 8};
+            }
+#endif
+            else return {&GemmMicroScalar<T>, 4, 8};
+        }
+
+        // rows [0, mc) x cols [0, kc) of a into MR-row micro-panels, zero-padded to a multiple of MR rows
+        template <class T>
+        void GemmPackA(size_t MR, size_t mc, size_t kc, const T* a, size_t lda, T* out) noexcept {
+            for (auto i = size_t(0); i<mc; i += MR) {
+                const auto rows = std::min(MR, mc-i);
+                for (auto k = size_t(0); k<kc; ++k, out += MR) {
+                    for (auto r = size_t(0); r<rows; ++r) out[r] = a[(i+r)*lda+k];
+                    for (auto r = rows; r<MR; ++r) out[r] = T(0);
+                }
+            }
+        }
+
+        // rows [0, kc) x cols [0, nc) of b into NR-column micro-panels, zero-padded to a multiple of NR columns
+        template <class T>
+        void GemmPackB(size_t NR, size_t kc, size_t nc, const T* b, size_t ldb, T* out) noexcept {
+            for (auto j = size_t(0); j<nc; j += NR) {
+                const auto cols = std::min(NR, nc-j);
+                for (auto k = size_t(0); k<kc; ++k, out += NR) {
+                    const auto src = b+k*ldb+j;
+                    for (auto c = size_t(0); c<cols; ++c) out[c] = src[c];
+                    for (auto c = cols; c<NR; ++c) out[c] = T(0);
+                }
+            }
+        }
+
+        template <class T>
+        struct GemmBuffer {
+            explicit GemmBuffer(size_t n) : Data(static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(64)))) { }
+            GemmBuffer(const GemmBuffer&) = delete;
+            GemmBuffer& operator=(const GemmBuffer&) = delete;
+            ~GemmBuffer() noexcept { ::operator delete(Data, std::align_val_t(64)); }
+            T* Data;
+        };
+
+        // one packed MC x KC block of A against the packed panel of B
+        template <class T>
+        void GemmBlock(const GemmMicro<T>& micro, size_t mc, size_t nc, size_t kc, const T* a, size_t lda,
+                       const T* packedB, T* packedA, T* c, size_t ldc, bool accumulate) noexcept {
+            const auto MR = micro.MR, NR = micro.NR;
+            const auto kernel = micro.Kernel;
+            GemmPackA(MR, mc, kc, a, lda, packedA);
+            alignas(64) T edge[GemmTile<T>::MaxTile];
+            for (auto j = size_t(0); j<nc; j += NR) {
+                const auto pb = packedB+j*kc;
+                const auto cols = std::min(NR, nc-j);
+                for (auto i = size_t(0); i<mc; i += MR) {
+                    const auto pa = packedA+i*kc;
+                    const auto rows = std::min(MR, mc-i);
+                    const auto pc = c+i*ldc+j;
+                    if (rows==MR && cols==NR) {
+                        kernel(kc, pa, pb, pc, ldc, accumulate);
+                        continue;
+                    }
+                    // partial tiles go through a scratch tile
+                    kernel(kc, pa, pb, edge, NR, false);
+                    for (auto r = size_t(0); r<rows; ++r)
+                        for (auto q = size_t(0); q<cols; ++q)
+                            pc[r*ldc+q] = accumulate ? pc[r*ldc+q]+edge[r*NR+q] : edge[r*NR+q];
+                }
+            }
+        }
+    }
+
+    // multiply-add count above which Gemm goes parallel
+    inline constexpr size_t GemmParallelWork = size_t(1) << 24u;
+
+    // c[m x n] = a[m x k] * b[k x n]; c must not overlap a or b
+    template <class T>
+    void Gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+        using Tile = SIMD::GemmTile<T>;
+        static const auto micro = SIMD::SelectGemmMicro<T>();
+        if (!m || !n) return;
+        if (!k) {
+            for (auto i = size_t(0); i<m; ++i) std::fill_n(c+i*ldc, n, T(0));
+            return;
+        }
+        const auto ncMax = std::min(Tile::NC, (n+micro.NR-1)/micro.NR*micro.NR);
+        const auto kcMax = std::min(Tile::KC, k);
+        SIMD::GemmBuffer<T> packedB(ncMax*kcMax);
+        const auto blocks = (m+Tile::MC-1)/Tile::MC;
+        auto& pool = Parallel::DefaultPool();
+        const auto parallel = blocks>1 && pool.Concurrency()>1 && m*n*k>=GemmParallelWork;
+        const auto packedASize = ((std::min(Tile::MC, m)+micro.MR-1)/micro.MR*micro.MR)*kcMax;
+        SIMD::GemmBuffer<T> packedA(parallel ? 0 : packedASize);
+        for (auto jc = size_t(0); jc<n; jc += Tile::NC) {
+            const auto nc = std::min(Tile::NC, n-jc);
+            for (auto pc = size_t(0); pc<k; pc += Tile::KC) {
+                const auto kc = std::min(Tile::KC, k-pc);
+                const auto accumulate = pc!=0;
+                SIMD::GemmPackB(micro.NR, kc, nc, b+pc*ldb+jc, ldb, packedB.Data);
+                const auto block = [&](size_t ic, T* pa) {
+                    const auto i = ic*Tile::MC;
+                    SIMD::GemmBlock<T>(micro, std::min(Tile::MC, m-i), nc, kc, a+i*lda+pc, lda, packedB.Data, pa,
+                            c+i*ldc+jc, ldc, accumulate);
+                };
+                if (parallel)
+                    pool.For(blocks, [&](size_t ic) {
+                        SIMD::GemmBuffer<T> local(packedASize);
+                        block(ic, local.Data);
+                    });
+                else
+                    for (auto ic = size_t(0); ic<blocks; ++ic) block(ic, packedA.Data);
+            }
+        }
+    }
+}
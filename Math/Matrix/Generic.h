@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Base.h"
+#include "Gemm.h"
 
 namespace Math {
     template <class T, int R, int C>
@@ -26,27 +27,27 @@ namespace Math {
         }
 
         constexpr Mat operator+(const Mat& r) const noexcept {
-            Mat ret = r;
-            for (auto i = 0; i<R; ++i) ret[i] += (*this)[i];
+            Mat ret = *this;
+            for (auto i = 0; i<R; ++i) ret[i] += r[i];
             return ret;
         }
 
         constexpr Mat operator-(const Mat& r) const noexcept {
-            Mat ret = r;
-            for (auto i = 0; i<R; ++i) ret[i] -= (*this)[i];
+            Mat ret = *this;
+            for (auto i = 0; i<R; ++i) ret[i] -= r[i];
             return ret;
         }
 
         template <class U, class = EnableIfNotVectorOrMatrix<U>>
         constexpr Mat operator*(const U& r) const noexcept {
-            Mat ret = r;
+            Mat ret = *this;
             for (auto i = 0; i<R; ++i) ret[i] *= r;
             return ret;
         }
 
         template <class U, class = EnableIfNotVectorOrMatrix<U>>
         constexpr Mat operator/(const U& r) const noexcept {
-            Mat ret = r;
+            Mat ret = *this;
             for (auto i = 0; i<R; ++i) ret[i] /= r;
             return ret;
         }
@@ -102,4 +103,15 @@ namespace Math {
     private:
         RowType _Stg[R];
     };
+
+    // a * b through the cache-blocked, possibly multithreaded Gemm; for large products where operator* would be
+    // slow. Allocates packing buffers and may start the default thread pool.
+    template <class T, int R, int C, int Cr>
+    Mat<T, R, Cr> Gemm(const Mat<T, R, C>& a, const Mat<T, C, Cr>& b) {
+        static_assert(sizeof(typename Mat<T, R, C>::RowType)==C*sizeof(T) &&
+                      sizeof(typename Mat<T, C, Cr>::RowType)==Cr*sizeof(T), "Gemm needs unpadded rows");
+        Mat<T, R, Cr> ret{};
+        Gemm<T>(R, Cr, C, a[0].Data, C, b[0].Data, Cr, ret[0].Data, Cr);
+        return ret;
+    }
 }
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <span>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include "Vector/2.h"
+#include "Vector/3.h"
+#include "SIMD/CPU.h"
+
+// Z-order (Morton) codes for integer grid coordinates.
+// 3D codes keep the low 21 bits of each axis (bit 3k+a holds bit k of axis a, X=0, Y=1, Z=2); coordinates outside
+// [-2^20, 2^20) wrap, and decoding sign-extends from bit 20. 2D codes keep all 32 bits of each axis.
+// Scalar calls use PDEP/PEXT when compiled for BMI2; the span versions select BMI2 at runtime.
+namespace Math::Morton {
+    inline constexpr uint64_t Mask3X = 0x1249249249249249, Mask3Y = Mask3X << 1u, Mask3Z = Mask3X << 2u;
+    inline constexpr uint64_t Mask2X = 0x5555555555555555, Mask2Y = Mask2X << 1u;
+
+    constexpr uint64_t Spread3(uint32_t v) noexcept {
+        uint64_t x = v & 0x1FFFFFu;
+        x = (x | (x << 32u)) & 0x001F00000000FFFF;
+        x = (x | (x << 16u)) & 0x001F0000FF0000FF;
+        x = (x | (x << 8u)) & 0x100F00F00F00F00F;
+        x = (x | (x << 4u)) & 0x10C30C30C30C30C3;
+        return (x | (x << 2u)) & Mask3X;
+    }
+
+    constexpr uint32_t Compact3(uint64_t x) noexcept {
+        x &= Mask3X;
+        x = (x | (x >> 2u)) & 0x10C30C30C30C30C3;
+        x = (x | (x >> 4u)) & 0x100F00F00F00F00F;
+        x = (x | (x >> 8u)) & 0x001F0000FF0000FF;
+        x = (x | (x >> 16u)) & 0x001F00000000FFFF;
+        return uint32_t((x | (x >> 32u)) & 0x1FFFFFu);
+    }
+
+    constexpr uint64_t Spread2(uint32_t v) noexcept {
+        uint64_t x = v;
+        x = (x | (x << 16u)) & 0x0000FFFF0000FFFF;
+        x = (x | (x << 8u)) & 0x00FF00FF00FF00FF;
+        x = (x | (x << 4u)) & 0x0F0F0F0F0F0F0F0F;
+        x = (x | (x << 2u)) & 0x3333333333333333;
+        return (x | (x << 1u)) & Mask2X;
+    }
+
+    constexpr uint32_t Compact2(uint64_t x) noexcept {
+        x &= Mask2X;
+        x = (x | (x >> 1u)) & 0x3333333333333333;
+        x = (x | (x >> 2u)) & 0x0F0F0F0F0F0F0F0F;
+        x = (x | (x >> 4u)) & 0x00FF00FF00FF00FF;
+        x = (x | (x >> 8u)) & 0x0000FFFF0000FFFF;
+        return uint32_t(x | (x >> 16u));
+    }
+
+    constexpr int SignExtend21(uint32_t v) noexcept { return int(v << 11u) >> 11; }
+
+    constexpr uint64_t Encode3(const Vec3I& v) noexcept {
+#if defined(MATH_SIMD_BMI2)
+        if (!MATH_IS_CONSTANT_EVALUATED())
+            return _pdep_u64(uint32_t(v.Data[0]), Mask3X) | _pdep_u64(uint32_t(v.Data[1]), Mask3Y) |
+                    _pdep_u64(uint32_t(v.Data[2]), Mask3Z);
+#endif
+        return Spread3(uint32_t(v.Data[0])) | (Spread3(uint32_t(v.Data[1])) << 1u) | (Spread3(uint32_t(v.Data[2])) << 2u);
+    }
+
+    constexpr Vec3I Decode3(uint64_t code) noexcept {
+#if defined(MATH_SIMD_BMI2)
+        if (!MATH_IS_CONSTANT_EVALUATED())
+            return Vec3I(SignExtend21(uint32_t(_pext_u64(code, Mask3X))), SignExtend21(uint32_t(_pext_u64(code, Mask3Y))),
+                    SignExtend21(uint32_t(_pext_u64(code, Mask3Z))));
+#endif
+        return Vec3I(SignExtend21(Compact3(code)), SignExtend21(Compact3(code >> 1u)), SignExtend21(Compact3(code >> 2u)));
+    }
+
+    constexpr uint64_t Encode2(const Vec2I& v) noexcept {
+#if defined(MATH_SIMD_BMI2)
+        if (!MATH_IS_CONSTANT_EVALUATED())
+            return _pdep_u64(uint32_t(v.Data[0]), Mask2X) | _pdep_u64(uint32_t(v.Data[1]), Mask2Y);
+#endif
+        return Spread2(uint32_t(v.Data[0])) | (Spread2(uint32_t(v.Data[1])) << 1u);
+    }
+
+    constexpr Vec2I Decode2(uint64_t code) noexcept {
+#if defined(MATH_SIMD_BMI2)
+        if (!MATH_IS_CONSTANT_EVALUATED())
+            return Vec2I(int(uint32_t(_pext_u64(code, Mask2X))), int(uint32_t(_pext_u64(code, Mask2Y))));
+#endif
+        return Vec2I(int(Compact2(code)), int(Compact2(code >> 1u)));
+    }
+
+    namespace Kernels {
+        template <class In, class Out>
+        using Kernel = void (*)(const In*, Out*, size_t) noexcept;
+
+        inline void Encode3Scalar(const Vec3I* in, uint64_t* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i) out[i] = Encode3(in[i]);
+        }
+        inline void Decode3Scalar(const uint64_t* in, Vec3I* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i) out[i] = Decode3(in[i]);
+        }
+        inline void Encode2Scalar(const Vec2I* in, uint64_t* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i) out[i] = Encode2(in[i]);
+        }
+        inline void Decode2Scalar(const uint64_t* in, Vec2I* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i) out[i] = Decode2(in[i]);
+        }
+
+#if defined(MATH_SIMD_SSE2) && !defined(MATH_SIMD_BMI2)
+        MATH_TARGET("bmi2")
+        inline void Encode3BMI2(const Vec3I* in, uint64_t* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i)
+                out[i] = _pdep_u64(uint32_t(in[i].X), Mask3X) | _pdep_u64(uint32_t(in[i].Y), Mask3Y) |
+                        _pdep_u64(uint32_t(in[i].Z), Mask3Z);
+        }
+        MATH_TARGET("bmi2")
+        inline void Decode3BMI2(const uint64_t* in, Vec3I* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i)
+                out[i] = Vec3I(SignExtend21(uint32_t(_pext_u64(in[i], Mask3X))),
+                        SignExtend21(uint32_t(_pext_u64(in[i], Mask3Y))), SignExtend21(uint32_t(_pext_u64(in[i], Mask3Z))));
+        }
+        MATH_TARGET("bmi2")
+        inline void Encode2BMI2(const Vec2I* in, uint64_t* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i) out[i] = _pdep_u64(uint32_t(in[i].X), Mask2X) | _pdep_u64(uint32_t(in[i].Y), Mask2Y);
+        }
+        MATH_TARGET("bmi2")
+        inline void Decode2BMI2(const uint64_t* in, Vec2I* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i)
+                out[i] = Vec2I(int(uint32_t(_pext_u64(in[i], Mask2X))), int(uint32_t(_pext_u64(in[i], Mask2Y))));
+        }
+
+        template <class In, class Out>
+        Kernel<In, Out> Select(Kernel<In, Out> bmi2, Kernel<In, Out> scalar) noexcept {
+            return SIMD::CPU().BMI2 ? bmi2 : scalar;
+        }
+#   define MATH_MORTON_SELECT(name) Kernels::Select(&Kernels::name##BMI2, &Kernels::name##Scalar)
+#else
+#   define MATH_MORTON_SELECT(name) &Kernels::name##Scalar
+#endif
+    }
+
+    // batched forms process min(in.size(), out.size()) elements
+    inline void Encode3(std::span<const Vec3I> in, std::span<uint64_t> out) noexcept {
+        static const Kernels::Kernel<Vec3I, uint64_t> kernel = MATH_MORTON_SELECT(Encode3);
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+
+    inline void Decode3(std::span<const uint64_t> in, std::span<Vec3I> out) noexcept {
+        static const Kernels::Kernel<uint64_t, Vec3I> kernel = MATH_MORTON_SELECT(Decode3);
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+
+    inline void Encode2(std::span<const Vec2I> in, std::span<uint64_t> out) noexcept {
+        static const Kernels::Kernel<Vec2I, uint64_t> kernel = MATH_MORTON_SELECT(Encode2);
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+
+    inline void Decode2(std::span<const uint64_t> in, std::span<Vec2I> out) noexcept {
+        static const Kernels::Kernel<uint64_t, Vec2I> kernel = MATH_MORTON_SELECT(Decode2);
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+
+#undef MATH_MORTON_SELECT
+}
+
+namespace std {
+    // Morton code of the low 21 bits of each axis; see Math::Morton
+    template <>
+    struct hash<Math::Vec3I> {
+        using argument_type = Math::Vec3I;
+        using result_type = std::size_t;
+
+        result_type operator()(argument_type const& s) const noexcept { return result_type(Math::Morton::Encode3(s)); }
+    };
+}
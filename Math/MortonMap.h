@@ -0,0 +1,325 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include "Vector.h"
+#include "Morton.h"
+
+namespace Math {
+    struct MortonSetValue {};
+
+    // Open-addressing hash map keyed by Vec3I, with linear probing and backward-shift deletion.
+    // Keys are ranked by their 63-bit Morton code (21 bits per axis, wrapping). The low 6 bits of the code
+    // (the position inside an aligned 4x4x4 block) pick the bucket inside a 64-bucket group, and the remaining
+    // bits are mixed to pick the group. A block of neighbouring keys therefore occupies one contiguous run of
+    // buckets and is iterated in Morton order, while distinct blocks spread evenly over the table.
+    template <class V>
+    class MortonMap {
+    public:
+        // the key is const so iterators cannot move an entry away from its bucket
+        struct Entry {
+            const Vec3I Key;
+            [[no_unique_address]] V Value;
+        };
+
+        template <bool Const>
+        class BasicIterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Entry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const Entry*, Entry*>;
+            using reference = std::conditional_t<Const, const Entry&, Entry&>;
+
+            BasicIterator() noexcept = default;
+            // mutable iterators convert to const ones
+            template <bool C = Const, class = std::enable_if_t<C>>
+            BasicIterator(const BasicIterator<false>& r) noexcept: _Map(r._Map), _Index(r._Index) { }
+
+            reference operator*() const noexcept { return _Map->_Slots[_Index]; }
+            pointer operator->() const noexcept { return _Map->_Slots+_Index; }
+            BasicIterator& operator++() noexcept {
+                _Index = _Map->NextUsed(_Index+1);
+                return *this;
+            }
+            BasicIterator operator++(int) noexcept {
+                auto ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(const BasicIterator& r) const noexcept { return _Index==r._Index; }
+            bool operator!=(const BasicIterator& r) const noexcept { return _Index!=r._Index; }
+        private:
+            friend class MortonMap;
+            friend class BasicIterator<true>;
+            BasicIterator(const MortonMap* map, size_t index) noexcept: _Map(map), _Index(index) { }
+            const MortonMap* _Map = nullptr;
+            size_t _Index = 0;
+        };
+
+        using Iterator = BasicIterator<false>;
+        using ConstIterator = BasicIterator<true>;
+        using iterator = Iterator;
+        using const_iterator = ConstIterator;
+
+        MortonMap() noexcept = default;
+        explicit MortonMap(size_t capacity) { Reserve(capacity); }
+        MortonMap(const MortonMap& r) : MortonMap(r._Size) { for (auto& e : r) Emplace(e.Key, e.Value); }
+        MortonMap(MortonMap&& r) noexcept { Swap(r); }
+        MortonMap& operator=(const MortonMap& r) {
+            if (this!=&r) MortonMap(r).Swap(*this);
+            return *this;
+        }
+        MortonMap& operator=(MortonMap&& r) noexcept {
+            MortonMap(std::move(r)).Swap(*this);
+            return *this;
+        }
+        ~MortonMap() noexcept {
+            Clear();
+            Deallocate();
+        }
+
+        size_t Size() const noexcept { return _Size; }
+        bool Empty() const noexcept { return _Size==0; }
+        size_t BucketCount() const noexcept { return _Mask ? _Mask+1 : 0; }
+
+        Iterator begin() noexcept { return {this, NextUsed(0)}; }
+        Iterator end() noexcept { return {this, BucketCount()}; }
+        ConstIterator begin() const noexcept { return {this, NextUsed(0)}; }
+        ConstIterator end() const noexcept { return {this, BucketCount()}; }
+
+        void Swap(MortonMap& r) noexcept {
+            std::swap(_Slots, r._Slots);
+            std::swap(_Used, r._Used);
+            std::swap(_Mask, r._Mask);
+            std::swap(_Size, r._Size);
+        }
+
+        void Clear() noexcept {
+            for (auto i = 0u; i<BucketCount(); ++i)
+                if (_Used[i]) {
+                    std::destroy_at(_Slots+i);
+                    _Used[i] = false;
+                }
+            _Size = 0;
+        }
+
+        // guarantees that count elements fit without rehashing
+        void Reserve(size_t count) {
+            auto buckets = size_t(16);
+            while (buckets*MaxLoadNum<count*MaxLoadDen) buckets *= 2;
+            if (buckets>BucketCount()) Rehash(buckets);
+        }
+
+        template <class ...A>
+        std::pair<Iterator, bool> Emplace(const Vec3I& key, A&& ... args) {
+            if ((_Size+1)*MaxLoadDen>BucketCount()*MaxLoadNum) Reserve(_Size+1);
+            auto i = Home(Code(key));
+            for (; _Used[i]; i = (i+1) & _Mask)
+                if (_Slots[i].Key==key) return {{this, i}, false};
+            ::new(static_cast<void*>(_Slots+i)) Entry{key, V(std::forward<A>(args)...)};
+            _Used[i] = true;
+            ++_Size;
+            return {{this, i}, true};
+        }
+
+        std::pair<Iterator, bool> Insert(const Vec3I& key, const V& value) { return Emplace(key, value); }
+        std::pair<Iterator, bool> Insert(const Vec3I& key, V&& value) { return Emplace(key, std::move(value)); }
+        V& operator[](const Vec3I& key) { return Emplace(key).first->Value; }
+
+        V* Find(const Vec3I& key) noexcept { return const_cast<V*>(std::as_const(*this).Find(key)); }
+        const V* Find(const Vec3I& key) const noexcept { return FindCode(key, Code(key)); }
+        bool Contains(const Vec3I& key) const noexcept { return Find(key)!=nullptr; }
+
+        bool Erase(const Vec3I& key) noexcept {
+            if (!_Size) return false;
+            auto i = Home(Code(key));
+            for (; _Used[i]; i = (i+1) & _Mask)
+                if (_Slots[i].Key==key) {
+                    EraseAt(i);
+                    return true;
+                }
+            return false;
+        }
+
+        // Fills out with the 26 face/edge/corner neighbours of key (nullptr where absent), x fastest, then y, then z.
+        // Returns the number found. Neighbour codes are derived from the centre code with dilated arithmetic.
+        size_t Neighbours(const Vec3I& key, V* (&out)[26]) noexcept {
+            const V* found[26];
+            const auto ret = std::as_const(*this).Neighbours(key, found);
+            for (auto i = 0u; i<26; ++i) out[i] = const_cast<V*>(found[i]);
+            return ret;
+        }
+        size_t Neighbours(const Vec3I& key, const V* (&out)[26]) const noexcept {
+            const auto centre = Code(key);
+            uint64_t xs[3], ys[3], zs[3];
+            xs[0] = Dec(centre, MaskX) & MaskX, xs[1] = centre & MaskX, xs[2] = Inc(centre, MaskX) & MaskX;
+            ys[0] = Dec(centre, MaskY) & MaskY, ys[1] = centre & MaskY, ys[2] = Inc(centre, MaskY) & MaskY;
+            zs[0] = Dec(centre, MaskZ) & MaskZ, zs[1] = centre & MaskZ, zs[2] = Inc(centre, MaskZ) & MaskZ;
+            auto n = 0u, found = 0u;
+            for (auto dz = -1; dz<=1; ++dz)
+                for (auto dy = -1; dy<=1; ++dy)
+                    for (auto dx = -1; dx<=1; ++dx) {
+                        if (!dx && !dy && !dz) continue;
+                        // neighbours past the int range do not exist
+                        const auto x = int64_t(key.X)+dx, y = int64_t(key.Y)+dy, z = int64_t(key.Z)+dz;
+                        out[n] = InRange(x) && InRange(y) && InRange(z)
+                                ? FindCode(Vec3I(int(x), int(y), int(z)), xs[dx+1] | ys[dy+1] | zs[dz+1]) : nullptr;
+                        found += out[n++]!=nullptr;
+                    }
+            return found;
+        }
+
+        // Visits every entry with min <= key <= max (component-wise, inclusive) as fn(const Vec3I&, V&), or with a
+        // const V& on a const map. Small boxes probe each cell; boxes larger than the table scan the buckets instead.
+        template <class F>
+        void ForEachInBox(const Vec3I& min, const Vec3I& max, F&& fn) { VisitBox(*this, min, max, fn); }
+        template <class F>
+        void ForEachInBox(const Vec3I& min, const Vec3I& max, F&& fn) const { VisitBox(*this, min, max, fn); }
+    private:
+        static constexpr size_t MaxLoadNum = 3, MaxLoadDen = 4;
+        static constexpr uint64_t MaskX = Morton::Mask3X, MaskY = Morton::Mask3Y, MaskZ = Morton::Mask3Z;
+
+        static uint64_t Code(const Vec3I& k) noexcept { return Morton::Encode3(k); }
+        static bool InRange(int64_t v) noexcept {
+            return v>=std::numeric_limits<int>::lowest() && v<=std::numeric_limits<int>::max();
+        }
+
+        // extents and loop counters are 64-bit so boxes touching the int limits neither overflow nor loop forever
+        template <class M, class F>
+        static void VisitBox(M& map, const Vec3I& min, const Vec3I& max, F& fn) {
+            using Value = std::conditional_t<std::is_const_v<M>, const V, V>;
+            if (min.X>max.X || min.Y>max.Y || min.Z>max.Z || !map._Size) return;
+            const auto ex = uint64_t(int64_t(max.X)-min.X+1), ey = uint64_t(int64_t(max.Y)-min.Y+1),
+                    ez = uint64_t(int64_t(max.Z)-min.Z+1);
+            // compared by division, the product of three 33-bit extents does not fit in 64 bits
+            if (ex<=map.BucketCount() && ey<=map.BucketCount()/ex && ez<=map.BucketCount()/(ex*ey)) {
+                for (auto z = int64_t(min.Z); z<=max.Z; ++z)
+                    for (auto y = int64_t(min.Y); y<=max.Y; ++y)
+                        for (auto x = int64_t(min.X); x<=max.X; ++x) {
+                            const Vec3I at(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z));
+                            if (Value* v = map.Find(at)) fn(static_cast<const Vec3I&>(at), *v);
+                        }
+            }
+            else {
+                for (auto& e : map) {
+                    const auto& k = e.Key;
+                    if (k.X>=min.X && k.X<=max.X && k.Y>=min.Y && k.Y<=max.Y && k.Z>=min.Z && k.Z<=max.Z)
+                        fn(k, e.Value);
+                }
+            }
+        }
+        static uint64_t Inc(uint64_t code, uint64_t mask) noexcept { return (code | ~mask)+1; }
+        static uint64_t Dec(uint64_t code, uint64_t mask) noexcept { return (code & mask)-1; }
+
+        size_t Home(uint64_t code) const noexcept {
+            return (size_t(((code >> 6u)*0x9E3779B97F4A7C15) >> 26u) << 6u | size_t(code & 63u)) & _Mask;
+        }
+
+        const V* FindCode(const Vec3I& key, uint64_t code) const noexcept {
+            if (!_Size) return nullptr;
+            for (auto i = Home(code); _Used[i]; i = (i+1) & _Mask)
+                if (_Slots[i].Key==key) return &_Slots[i].Value;
+            return nullptr;
+        }
+
+        size_t NextUsed(size_t i) const noexcept {
+            while (i<BucketCount() && !_Used[i]) ++i;
+            return i;
+        }
+
+        void EraseAt(size_t i) noexcept {
+            std::destroy_at(_Slots+i);
+            for (auto j = (i+1) & _Mask; _Used[j]; j = (j+1) & _Mask) {
+                const auto h = Home(Code(_Slots[j].Key));
+                // entries whose home lies cyclically in (i, j] stay where they are
+                const auto stays = i<j ? (h>i && h<=j) : (h>i || h<=j);
+                if (stays) continue;
+                ::new(static_cast<void*>(_Slots+i)) Entry(std::move(_Slots[j]));
+                std::destroy_at(_Slots+j);
+                i = j;
+            }
+            _Used[i] = false;
+            --_Size;
+        }
+
+        void Rehash(size_t buckets) {
+            // both buffers are owned until the table takes them, so a failed allocation leaks neither
+            const auto free = [buckets](Entry* p) noexcept { std::allocator<Entry>{}.deallocate(p, buckets); };
+            std::unique_ptr<Entry, decltype(free)> slots(std::allocator<Entry>{}.allocate(buckets), free);
+            auto used = std::make_unique<bool[]>(buckets);
+            const auto oldSlots = _Slots;
+            const auto oldUsed = _Used;
+            const auto oldCount = BucketCount();
+            _Slots = slots.release();
+            _Used = used.release();
+            _Mask = buckets-1;
+            for (auto i = size_t(0); i<oldCount; ++i)
+                if (oldUsed[i]) {
+                    auto j = Home(Code(oldSlots[i].Key));
+                    while (_Used[j]) j = (j+1) & _Mask;
+                    ::new(static_cast<void*>(_Slots+j)) Entry(std::move(oldSlots[i]));
+                    _Used[j] = true;
+                    std::destroy_at(oldSlots+i);
+                }
+            if (oldSlots) {
+                std::allocator<Entry>{}.deallocate(oldSlots, oldCount);
+                delete[] oldUsed;
+            }
+        }
+
+        void Deallocate() noexcept {
+            if (_Slots) {
+                std::allocator<Entry>{}.deallocate(_Slots, BucketCount());
+                delete[] _Used;
+            }
+            _Slots = nullptr;
+            _Used = nullptr;
+            _Mask = 0;
+        }
+
+        Entry* _Slots = nullptr;
+        bool* _Used = nullptr;
+        size_t _Mask = 0;
+        size_t _Size = 0;
+    };
+
+    // Set of Vec3I with the same bucket layout as MortonMap
+    class MortonSet {
+    public:
+        using Iterator = MortonMap<MortonSetValue>::ConstIterator;
+
+        MortonSet() noexcept = default;
+        explicit MortonSet(size_t capacity) : _Map(capacity) { }
+
+        size_t Size() const noexcept { return _Map.Size(); }
+        bool Empty() const noexcept { return _Map.Empty(); }
+        Iterator begin() const noexcept { return _Map.begin(); }
+        Iterator end() const noexcept { return _Map.end(); }
+        void Clear() noexcept { _Map.Clear(); }
+        void Reserve(size_t count) { _Map.Reserve(count); }
+        bool Insert(const Vec3I& key) { return _Map.Emplace(key).second; }
+        bool Contains(const Vec3I& key) const noexcept { return _Map.Contains(key); }
+        bool Erase(const Vec3I& key) noexcept { return _Map.Erase(key); }
+
+        // presence of the 26 neighbours as a bitmask, bit n matching MortonMap::Neighbours slot n
+        uint32_t Neighbours(const Vec3I& key) const noexcept {
+            const MortonSetValue* found[26];
+            _Map.Neighbours(key, found);
+            uint32_t ret = 0;
+            for (auto i = 0u; i<26; ++i) ret |= uint32_t(found[i]!=nullptr) << i;
+            return ret;
+        }
+
+        template <class F>
+        void ForEachInBox(const Vec3I& min, const Vec3I& max, F&& fn) const {
+            _Map.ForEachInBox(min, max, [&fn](const Vec3I& key, const MortonSetValue&) { fn(key); });
+        }
+    private:
+        MortonMap<MortonSetValue> _Map;
+    };
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+#include "Vector.h"
+#include "Parallel.h"
+#include "SIMD/F32x8.h"
+#include "SIMD/I32x8.h"
+
+// Seeded gradient (Perlin) noise and fBm in 2D and 3D, for single points, spans of points and regular grids.
+// Lattice corners are hashed with integer multiplies instead of a permutation table, so the batched paths need no
+// gathers; they evaluate eight samples at a time on F32x8/I32x8.
+// Results are bit-identical between the single-point and batched paths and across the scalar, SSE and AVX2 builds:
+// every path performs the same sequence of IEEE float operations, and products are hidden from the compiler before
+// they are summed so none is contracted into an FMA, which rounds once instead of twice.
+// Values lie in about [-1, 1]. Sample coordinates must stay within the int32 range.
+namespace Math::Noise {
+    // Octaves are summed with frequency multiplied by Lacunarity and amplitude by Gain at each step, then divided
+    // by the total amplitude; octave i uses seed + i
+    struct Fractal {
+        int Octaves = 4;
+        float Lacunarity = 2.0f;
+        float Gain = 0.5f;
+    };
+
+    namespace Detail {
+        using SIMD::F32x8;
+        using SIMD::I32x8;
+
+        inline constexpr uint32_t PrimeX = 501125321u, PrimeY = 1136930381u, PrimeZ = 1720413743u;
+        inline constexpr uint32_t HashMultiplier = 0x27D4EB2Du;
+        // bring the peak magnitudes of the raw sums to about 1
+        inline constexpr float Scale2 = 0.65f, Scale3 = 0.9649214f;
+
+        // GCC contracts a * b + c into an FMA whenever FMA is enabled, even across intrinsics; an empty asm
+        // statement makes the product opaque at no cost. MSVC does not contract by default.
+        inline float Opaque(float v) noexcept {
+#if defined(__GNUC__) && defined(__SSE2__)
+            __asm__("" : "+x"(v));
+#elif defined(__GNUC__) && defined(__aarch64__)
+            __asm__("" : "+w"(v));
+#endif
+            return v;
+        }
+        inline F32x8 Opaque(F32x8 v) noexcept {
+#if defined(__GNUC__) && defined(MATH_SIMD_AVX2)
+            __asm__("" : "+x"(v.V));
+#elif defined(__GNUC__) && defined(MATH_SIMD_SSE2)
+            __asm__("" : "+x"(v.L), "+x"(v.H));
+#elif !defined(MATH_SIMD_SSE2)
+            for (auto& f : v.V) f = Opaque(f);
+#endif
+            return v;
+        }
+
+        // lane operations on one sample (float, uint32_t) or eight (F32x8, I32x8)
+        template <class X>
+        X Splat(float v) noexcept {
+            if constexpr (std::is_same_v<X, float>) return v;
+            else return F32x8::Broadcast(v);
+        }
+        template <class I>
+        I SplatInt(uint32_t v) noexcept {
+            if constexpr (std::is_same_v<I, uint32_t>) return v;
+            else return I32x8::Broadcast(int32_t(v));
+        }
+        inline uint32_t FloorToInt(float v, float& floor) noexcept {
+            floor = std::floor(v);
+            return uint32_t(int32_t(floor));
+        }
+        inline I32x8 FloorToInt(F32x8 v, F32x8& floor) noexcept {
+            floor = Floor(v);
+            return I32x8::Truncate(floor);
+        }
+        inline uint32_t ShiftRightLogical(uint32_t v, int s) noexcept { return v >> s; }
+        inline I32x8 ShiftRightLogical(I32x8 v, int s) noexcept { return v.ShiftRightLogical(s); }
+        inline float Choose(bool mask, float a, float b) noexcept { return mask ? a : b; }
+        inline F32x8 Choose(I32x8 mask, F32x8 a, F32x8 b) noexcept { return Select(mask.AsFloat(), a, b); }
+        // flips the sign where bit 31 of sign is set
+        inline float FlipSign(float v, uint32_t sign) noexcept {
+            return std::bit_cast<float>(std::bit_cast<uint32_t>(v) ^ (sign & 0x80000000u));
+        }
+        inline F32x8 FlipSign(F32x8 v, I32x8 sign) noexcept {
+            return v ^ (sign & I32x8::Broadcast(int32_t(0x80000000u))).AsFloat();
+        }
+
+        template <class X>
+        X Mul(X a, X b) noexcept { return Opaque(a*b); }
+        template <class X>
+        X Lerp(X a, X b, X t) noexcept { return a+Mul(t, b-a); }
+        // 6t^5 - 15t^4 + 10t^3
+        template <class X>
+        X Fade(X t) noexcept {
+            const auto inner = Mul(t, Mul(t, Splat<X>(6.0f))-Splat<X>(15.0f))+Splat<X>(10.0f);
+            return Mul(Mul(Mul(t, t), t), inner);
+        }
+        template <class I>
+        I Hash(I seed, I x, I y, I z) noexcept { return (seed ^ x ^ y ^ z)*SplatInt<I>(HashMultiplier); }
+        template <class I>
+        I Hash(I seed, I x, I y) noexcept { return (seed ^ x ^ y)*SplatInt<I>(HashMultiplier); }
+
+        // Perlin's 12 cube-edge gradients, four of them twice, chosen by the top 4 hash bits
+        template <class X, class I>
+        X Gradient(I hash, X x, X y, X z) noexcept {
+            const auto h = ShiftRightLogical(hash, 28);
+            const auto u = Choose(h<SplatInt<I>(8), x, y);
+            const auto v = Choose(h<SplatInt<I>(4), y, Choose((h | SplatInt<I>(2))==SplatInt<I>(14), x, z));
+            return FlipSign(u, h << 31)+FlipSign(v, ShiftRightLogical(h, 1) << 31);
+        }
+        // (±1, ±2) and (±2, ±1), chosen by the top 3 hash bits
+        template <class X, class I>
+        X Gradient(I hash, X x, X y) noexcept {
+            const auto h = ShiftRightLogical(hash, 29);
+            const auto low = h<SplatInt<I>(4);
+            const auto u = Choose(low, x, y), v = Choose(low, y, x);
+            return FlipSign(u, h << 31)+FlipSign(v+v, ShiftRightLogical(h, 1) << 31);
+        }
+
+        template <class X, class I>
+        X Perlin(X x, X y, X z, I seed) noexcept {
+            X fx, fy, fz;
+            const auto x0 = FloorToInt(x, fx)*SplatInt<I>(PrimeX), x1 = x0+SplatInt<I>(PrimeX);
+            const auto y0 = FloorToInt(y, fy)*SplatInt<I>(PrimeY), y1 = y0+SplatInt<I>(PrimeY);
+            const auto z0 = FloorToInt(z, fz)*SplatInt<I>(PrimeZ), z1 = z0+SplatInt<I>(PrimeZ);
+            const auto one = Splat<X>(1.0f);
+            const auto dx0 = x-fx, dy0 = y-fy, dz0 = z-fz;
+            const auto dx1 = dx0-one, dy1 = dy0-one, dz1 = dz0-one;
+            const auto u = Fade(dx0), v = Fade(dy0), w = Fade(dz0);
+            const auto a = Lerp(Gradient(Hash(seed, x0, y0, z0), dx0, dy0, dz0),
+                                Gradient(Hash(seed, x1, y0, z0), dx1, dy0, dz0), u);
+            const auto b = Lerp(Gradient(Hash(seed, x0, y1, z0), dx0, dy1, dz0),
+                                Gradient(Hash(seed, x1, y1, z0), dx1, dy1, dz0), u);
+            const auto c = Lerp(Gradient(Hash(seed, x0, y0, z1), dx0, dy0, dz1),
+                                Gradient(Hash(seed, x1, y0, z1), dx1, dy0, dz1), u);
+            const auto d = Lerp(Gradient(Hash(seed, x0, y1, z1), dx0, dy1, dz1),
+                                Gradient(Hash(seed, x1, y1, z1), dx1, dy1, dz1), u);
+            return Mul(Lerp(Lerp(a, b, v), Lerp(c, d, v), w), Splat<X>(Scale3));
+        }
+        template <class X, class I>
+        X Perlin(X x, X y, I seed) noexcept {
+            X fx, fy;
+            const auto x0 = FloorToInt(x, fx)*SplatInt<I>(PrimeX), x1 = x0+SplatInt<I>(PrimeX);
+            const auto y0 = FloorToInt(y, fy)*SplatInt<I>(PrimeY), y1 = y0+SplatInt<I>(PrimeY);
+            const auto one = Splat<X>(1.0f);
+            const auto dx0 = x-fx, dy0 = y-fy;
+            const auto dx1 = dx0-one, dy1 = dy0-one;
+            const auto u = Fade(dx0), v = Fade(dy0);
+            const auto a = Lerp(Gradient(Hash(seed, x0, y0), dx0, dy0), Gradient(Hash(seed, x1, y0), dx1, dy0), u);
+            const auto b = Lerp(Gradient(Hash(seed, x0, y1), dx0, dy1), Gradient(Hash(seed, x1, y1), dx1, dy1), u);
+            return Mul(Lerp(a, b, v), Splat<X>(Scale2));
+        }
+
+        // D coordinates per sample in p
+        template <class X, class I, size_t D>
+        X Fbm(const X (&p)[D], uint32_t seed, const Fractal& fractal) noexcept {
+            auto sum = Splat<X>(0.0f);
+            auto frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+            for (auto o = 0; o<std::max(fractal.Octaves, 1); ++o) {
+                const auto f = Splat<X>(frequency);
+                const auto s = SplatInt<I>(seed+uint32_t(o));
+                X n;
+                if constexpr (D==2) n = Perlin(Mul(p[0], f), Mul(p[1], f), s);
+                else n = Perlin(Mul(p[0], f), Mul(p[1], f), Mul(p[2], f), s);
+                sum = sum+Mul(n, Splat<X>(amplitude));
+                total += amplitude;
+                amplitude *= fractal.Gain;
+                frequency *= fractal.Lacunarity;
+            }
+            return Mul(sum, Splat<X>(1.0f/total));
+        }
+
+        inline constexpr size_t Grain = 1024;
+
+        // samples [begin, end) of points into out, eight at a time on SIMD builds; without SIMD, F32x8 is a plain
+        // array and one sample at a time is faster
+        template <size_t D>
+        void FbmPoints(const Vec<D, float>* points, uint32_t seed, const Fractal& fractal, float* out,
+                       size_t begin, size_t end) noexcept {
+#if defined(MATH_SIMD_SSE2)
+            for (auto i = begin; i<end; i += 8) {
+                const auto n = std::min<size_t>(8, end-i);
+                float c[D][8]{}, r[8];
+                for (auto k = size_t(0); k<n; ++k)
+                    for (auto a = size_t(0); a<D; ++a) c[a][k] = points[i+k].Data[a];
+                F32x8 p[D];
+                for (auto a = size_t(0); a<D; ++a) p[a] = F32x8::Load(c[a]);
+                Fbm<F32x8, I32x8>(p, seed, fractal).Store(r);
+                std::copy_n(r, n, out+i);
+            }
+#else
+            for (auto i = begin; i<end; ++i) {
+                float c[D];
+                std::copy_n(points[i].Data, D, c);
+                out[i] = Fbm<float, uint32_t>(c, seed, fractal);
+            }
+#endif
+        }
+
+        // rows of a grid: row r starts at cell (originX, rowOrigin(r)...) and runs along X for width samples
+        template <size_t D, class RowOrigin>
+        void FbmRows(int originX, int width, float frequency, uint32_t seed, const Fractal& fractal, float* out,
+                     size_t samples, size_t rowBegin, size_t rowEnd, RowOrigin&& rowOrigin) noexcept {
+            for (auto row = rowBegin; row<rowEnd; ++row) {
+                const auto first = row*size_t(width);
+                const auto count = std::min(size_t(width), samples-first);
+                const auto others = rowOrigin(row);
+#if defined(MATH_SIMD_SSE2)
+                const auto iota = I32x8::Load(std::array<int32_t, 8>{0, 1, 2, 3, 4, 5, 6, 7}.data());
+                const auto f = F32x8::Broadcast(frequency);
+                F32x8 p[D];
+                for (auto a = size_t(1); a<D; ++a) p[a] = Mul(F32x8::Broadcast(float(others[a-1])), f);
+                for (auto i = size_t(0); i<count; i += 8) {
+                    p[0] = Mul((I32x8::Broadcast(originX+int(i))+iota).ToFloat(), f);
+                    const auto v = Fbm<F32x8, I32x8>(p, seed, fractal);
+                    if (count-i>=8) v.Store(out+first+i);
+                    else {
+                        float r[8];
+                        v.Store(r);
+                        std::copy_n(r, count-i, out+first+i);
+                    }
+                }
+#else
+                float p[D];
+                for (auto a = size_t(1); a<D; ++a) p[a] = Mul(float(others[a-1]), frequency);
+                for (auto i = size_t(0); i<count; ++i) {
+                    p[0] = Mul(float(originX+int(i)), frequency);
+                    out[first+i] = Fbm<float, uint32_t>(p, seed, fractal);
+                }
+#endif
+            }
+        }
+    }
+
+    inline float Perlin(const Vec2F& p, uint32_t seed = 0) noexcept {
+        return Detail::Perlin(p.Data[0], p.Data[1], seed);
+    }
+    inline float Perlin(const Vec3F& p, uint32_t seed = 0) noexcept {
+        return Detail::Perlin(p.Data[0], p.Data[1], p.Data[2], seed);
+    }
+    inline float Fbm(const Vec2F& p, uint32_t seed = 0, const Fractal& fractal = {}) noexcept {
+        const float c[2] = {p.Data[0], p.Data[1]};
+        return Detail::Fbm<float, uint32_t>(c, seed, fractal);
+    }
+    inline float Fbm(const Vec3F& p, uint32_t seed = 0, const Fractal& fractal = {}) noexcept {
+        const float c[3] = {p.Data[0], p.Data[1], p.Data[2]};
+        return Detail::Fbm<float, uint32_t>(c, seed, fractal);
+    }
+
+    // Fbm at every point into out, min(points.size(), out.size()) samples, split across the default pool
+    inline void Fbm(std::span<const Vec2F> points, uint32_t seed, const Fractal& fractal, std::span<float> out) {
+        Parallel::For(0, std::min(points.size(), out.size()), Detail::Grain, [&](size_t b, size_t e) {
+            Detail::FbmPoints(points.data(), seed, fractal, out.data(), b, e);
+        });
+    }
+    inline void Fbm(std::span<const Vec3F> points, uint32_t seed, const Fractal& fractal, std::span<float> out) {
+        Parallel::For(0, std::min(points.size(), out.size()), Detail::Grain, [&](size_t b, size_t e) {
+            Detail::FbmPoints(points.data(), seed, fractal, out.data(), b, e);
+        });
+    }
+    // Octaves = 1 gives plain Perlin noise
+    inline void Perlin(std::span<const Vec2F> points, uint32_t seed, std::span<float> out) {
+        Fbm(points, seed, Fractal{1}, out);
+    }
+    inline void Perlin(std::span<const Vec3F> points, uint32_t seed, std::span<float> out) {
+        Fbm(points, seed, Fractal{1}, out);
+    }
+
+    // Fbm over the cells c of a grid, sampled at Vec2F(origin + c) * frequency, X fastest. Writes
+    // min(out.size(), size.X * size.Y) samples, split by rows across the default pool; the values equal Fbm of the
+    // same points one at a time.
+    inline void Fbm(const Vec2I& origin, const Vec2I& size, float frequency, uint32_t seed, const Fractal& fractal,
+                    std::span<float> out) {
+        if (size.Data[0]<=0 || size.Data[1]<=0) return;
+        const auto width = size_t(size.Data[0]);
+        const auto samples = std::min(out.size(), width*size_t(size.Data[1]));
+        Parallel::For(0, (samples+width-1)/width, std::max<size_t>(1, Detail::Grain/width), [&](size_t b, size_t e) {
+            Detail::FbmRows<2>(origin.Data[0], size.Data[0], frequency, seed, fractal, out.data(), samples, b, e,
+                               [&](size_t row) { return std::array<int, 1>{origin.Data[1]+int(row)}; });
+        });
+    }
+    // As above in 3D: sampled at Vec3F(origin + c) * frequency, X fastest, then Y, then Z
+    inline void Fbm(const Vec3I& origin, const Vec3I& size, float frequency, uint32_t seed, const Fractal& fractal,
+                    std::span<float> out) {
+        if (size.Data[0]<=0 || size.Data[1]<=0 || size.Data[2]<=0) return;
+        const auto width = size_t(size.Data[0]), height = size_t(size.Data[1]);
+        const auto samples = std::min(out.size(), width*height*size_t(size.Data[2]));
+        Parallel::For(0, (samples+width-1)/width, std::max<size_t>(1, Detail::Grain/width), [&](size_t b, size_t e) {
+            Detail::FbmRows<3>(origin.Data[0], size.Data[0], frequency, seed, fractal, out.data(), samples, b, e,
+                               [&](size_t row) {
+                                   return std::array<int, 2>{origin.Data[1]+int(row%height), origin.Data[2]+int(row/height)};
+                               });
+        });
+    }
+}
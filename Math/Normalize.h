@@ -0,0 +1,167 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "Vector.h"
+#include "Transform.h"
+#include "SIMD/CPU.h"
+
+// Reciprocal length and normalization with a compile-time precision policy:
+//   Exact     1 / sqrt(x)
+//   Newton    rsqrt estimate refined by one Newton-Raphson step, ~22 bits
+//   Estimate  raw rsqrt estimate, relative error below 1.5 * 2^-12
+// Newton and Estimate only change float results on SSE builds; double and scalar builds always compute Exact.
+// Normalize of a zero vector yields non-finite components; NormalizeSafe returns a fallback instead for
+// vectors whose squared length is zero, denormal or not finite.
+namespace Math {
+    enum class Precision : uint8_t { Exact, Newton, Estimate };
+
+    template <Precision P = Precision::Exact, class T>
+    T InvSqrt(T x) noexcept {
+        static_assert(std::is_floating_point_v<T>);
+#if defined(MATH_SIMD_SSE2)
+        if constexpr (std::is_same_v<T, float> && P!=Precision::Exact) {
+            const auto y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+            if constexpr (P==Precision::Estimate) return y;
+            else return y*(1.5f-0.5f*x*y*y);
+        }
+        else
+#endif
+        return T(1)/std::sqrt(x);
+    }
+
+    template <Precision P = Precision::Exact, size_t D, class T>
+    T InvLength(const Vec<D, T>& v) noexcept { return InvSqrt<P>(v.LengthSqr()); }
+
+    template <Precision P = Precision::Exact, size_t D, class T>
+    Vec<D, T> Normalize(const Vec<D, T>& v) noexcept { return v*InvLength<P>(v); }
+
+    template <Precision P = Precision::Exact, size_t D, class T>
+    Vec<D, T> NormalizeSafe(const Vec<D, T>& v, const Vec<D, T>& fallback = Vec<D, T>()) noexcept {
+        const auto len = v.LengthSqr();
+        if (!(len>=std::numeric_limits<T>::min() && len<=std::numeric_limits<T>::max())) return fallback;
+        return v*InvSqrt<P>(len);
+    }
+
+    namespace SIMD {
+        using NormalizeKernel = void (*)(const float*, float*, size_t) noexcept;
+
+        // D consecutive floats per vector; Safe maps degenerate vectors to zero
+        template <size_t D, Precision P, bool Safe>
+        void NormalizeScalar(const float* in, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, in += D, out += D) {
+                Vec<D, float> v{VectorUninitialized};
+                std::copy_n(in, D, v.Data);
+                v = Safe ? NormalizeSafe<P>(v) : Normalize<P>(v);
+                std::copy_n(v.Data, D, out);
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        template <Precision P>
+        MATH_TARGET("avx2,fma")
+        __m256 InvSqrt8(__m256 x) noexcept {
+            if constexpr (P==Precision::Exact) return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(x));
+            auto y = _mm256_rsqrt_ps(x);
+            if constexpr (P==Precision::Newton) {
+                const auto h = _mm256_mul_ps(_mm256_set1_ps(0.5f), x);
+                y = _mm256_mul_ps(y, _mm256_fnmadd_ps(_mm256_mul_ps(h, y), y, _mm256_set1_ps(1.5f)));
+            }
+            return y;
+        }
+
+        // all-ones where NormalizeSafe normalizes, zero where it falls back; applied to the products, since
+        // masking the reciprocal alone leaves inf * 0 = NaN
+        MATH_TARGET("avx2,fma")
+        inline __m256 SafeMask8(__m256 x) noexcept {
+            return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::min()), _CMP_GE_OQ),
+                    _mm256_cmp_ps(x, _mm256_set1_ps(std::numeric_limits<float>::max()), _CMP_LE_OQ));
+        }
+
+        template <Precision P, bool Safe>
+        MATH_TARGET("avx2,fma")
+        void Normalize3AVX2(const float* in, float* out, size_t n) noexcept {
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8, in += 24, out += 24) {
+                __m256 x, y, z;
+                Deinterleave3(in, x, y, z);
+                const auto len = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+                const auto inv = InvSqrt8<P>(len);
+                x = _mm256_mul_ps(x, inv);
+                y = _mm256_mul_ps(y, inv);
+                z = _mm256_mul_ps(z, inv);
+                if constexpr (Safe) {
+                    const auto ok = SafeMask8(len);
+                    x = _mm256_and_ps(ok, x);
+                    y = _mm256_and_ps(ok, y);
+                    z = _mm256_and_ps(ok, z);
+                }
+                Interleave3(out, x, y, z);
+            }
+            NormalizeScalar<3, P, Safe>(in, out, n-i);
+        }
+
+        // two vectors per register; the squared length is summed within each 128-bit half
+        template <Precision P, bool Safe>
+        MATH_TARGET("avx2,fma")
+        void Normalize4AVX2(const float* in, float* out, size_t n) noexcept {
+            auto i = size_t(0);
+            for (; i+4<=n; i += 4, in += 16, out += 16) {
+                const auto a = _mm256_loadu_ps(in), b = _mm256_loadu_ps(in+8);
+                auto sa = _mm256_mul_ps(a, a), sb = _mm256_mul_ps(b, b);
+                sa = _mm256_add_ps(sa, _mm256_permute_ps(sa, _MM_SHUFFLE(2, 3, 0, 1)));
+                sb = _mm256_add_ps(sb, _mm256_permute_ps(sb, _MM_SHUFFLE(2, 3, 0, 1)));
+                sa = _mm256_add_ps(sa, _mm256_permute_ps(sa, _MM_SHUFFLE(1, 0, 3, 2)));
+                sb = _mm256_add_ps(sb, _mm256_permute_ps(sb, _MM_SHUFFLE(1, 0, 3, 2)));
+                auto ra = _mm256_mul_ps(a, InvSqrt8<P>(sa)), rb = _mm256_mul_ps(b, InvSqrt8<P>(sb));
+                if constexpr (Safe) {
+                    ra = _mm256_and_ps(SafeMask8(sa), ra);
+                    rb = _mm256_and_ps(SafeMask8(sb), rb);
+                }
+                _mm256_storeu_ps(out, ra);
+                _mm256_storeu_ps(out+8, rb);
+            }
+            NormalizeScalar<4, P, Safe>(in, out, n-i);
+        }
+#endif
+
+        template <size_t D, Precision P, bool Safe>
+        NormalizeKernel SelectNormalize() noexcept {
+            static_assert(D==3 || D==4);
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX2 && cpu.FMA) {
+                if constexpr (D==3) return &Normalize3AVX2<P, Safe>;
+                else return &Normalize4AVX2<P, Safe>;
+            }
+#endif
+            return &NormalizeScalar<D, P, Safe>;
+        }
+    }
+
+    // Batched forms over min(in.size(), out.size()) elements; in and out may be the same span, otherwise they must
+    // not overlap. NormalizeSafe maps degenerate vectors to zero. Results can differ from the single-vector
+    // functions in the last bit, as the kernels may contract the squared length into FMAs.
+    template <Precision P = Precision::Exact>
+    void Normalize(std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        static const auto kernel = SIMD::SelectNormalize<3, P, false>();
+        kernel(reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+    template <Precision P = Precision::Exact>
+    void NormalizeSafe(std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        static const auto kernel = SIMD::SelectNormalize<3, P, true>();
+        kernel(reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+    template <Precision P = Precision::Exact>
+    void Normalize(std::span<const Vec4F> in, std::span<Vec4F> out) noexcept {
+        static const auto kernel = SIMD::SelectNormalize<4, P, false>();
+        kernel(reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+    template <Precision P = Precision::Exact>
+    void NormalizeSafe(std::span<const Vec4F> in, std::span<Vec4F> out) noexcept {
+        static const auto kernel = SIMD::SelectNormalize<4, P, true>();
+        kernel(reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+}
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "Vector.h"
+#include "Transform.h"
+
+// Compact storage formats and their float conversions:
+//   Half                 IEEE 754 binary16; round to nearest even, overflow to inf, inf and NaN kept
+//   Normalized<I>        fixed point over [-1, 1] for signed I or [0, 1] for unsigned I: SNorm8, SNorm16, UNorm8, UNorm16
+//   (U|S)Norm1010102     a Vec4F in 32 bits, 10 bits each for x, y, z from the low bit up and 2 bits for w
+//   Octahedral(16|8)     a unit Vec3F folded onto [-1, 1]^2 and stored as two snorm16 (uint32_t) or snorm8 (uint16_t)
+// Quantization clamps to the range (NaN to its low end) and rounds to nearest even. Half and Normalized convert
+// implicitly to and from float, so they work as Vec components (Vec3H, Vec4UN8, ...) through the converting
+// constructors; arithmetic and comparisons happen in float.
+// The span overloads convert min(in.size(), out.size()) elements with a kernel picked once per process from cpuid:
+// F16C for halves, AVX2 for the rest, scalar otherwise; every kernel produces the same bits as the scalar form.
+namespace Math {
+    namespace Scalar {
+        constexpr uint16_t FloatToHalf(float v) noexcept {
+            auto x = std::bit_cast<uint32_t>(v);
+            const auto sign = (x >> 16) & 0x8000u;
+            x &= 0x7FFFFFFFu;
+            uint32_t ret;
+            if (x>=0x47800000u) // 65536 and up, inf, NaN
+                ret = x>0x7F800000u ? 0x7E00u | ((x >> 13) & 0x3FFu) : 0x7C00u;
+            else if (x<0x38800000u) // half subnormals: adding 0.5f lets the FPU round the shifted-out mantissa
+                ret = std::bit_cast<uint32_t>(std::bit_cast<float>(x)+0.5f)-0x3F000000u;
+            else
+                ret = (x+0xC8000FFFu+((x >> 13) & 1u)) >> 13;
+            return uint16_t(ret | sign);
+        }
+
+        constexpr float HalfToFloat(uint16_t h) noexcept {
+            auto x = uint32_t(h & 0x7FFFu) << 13;
+            const auto exp = x & 0x0F800000u;
+            x += 0x38000000u;
+            if (exp==0x0F800000u) { // inf, NaN; NaNs come out quiet
+                x += 0x38000000u;
+                if (h & 0x3FFu) x |= 0x00400000u;
+            }
+            else if (exp==0)
+                x = std::bit_cast<uint32_t>(std::bit_cast<float>(x+0x00800000u)-std::bit_cast<float>(0x38800000u));
+            return std::bit_cast<float>(x | (uint32_t(h & 0x8000u) << 16));
+        }
+
+        // round to nearest even for |x| < 2^22; the runtime path stays a separate rounding step even when the
+        // compiler contracts x = a*b into an FMA with the magic constant
+        constexpr float RoundEven(float x) noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return (x+12582912.0f)-12582912.0f;
+            return std::nearbyint(x);
+        }
+
+        template <int Bits, bool Signed>
+        constexpr float NormalizedMax = float(Signed ? (1 << (Bits-1))-1 : (1 << Bits)-1);
+
+        // two's complement, not masked to Bits
+        template <int Bits, bool Signed>
+        constexpr int32_t Quantize(float v) noexcept {
+            constexpr auto lo = Signed ? -1.0f : 0.0f;
+            v = v>lo ? (v<1.0f ? v : 1.0f) : lo;
+            return int32_t(RoundEven(v*NormalizedMax<Bits, Signed>));
+        }
+
+        // a product the compiler cannot fuse into a following add, so the scalar and vector forms round alike
+        inline float Product(float a, float b) noexcept {
+            auto p = a*b;
+#if defined(__GNUC__) && defined(__SSE2__)
+            __asm__("" : "+x"(p));
+#elif defined(__GNUC__) && defined(__aarch64__)
+            __asm__("" : "+w"(p));
+#endif
+            return p;
+        }
+
+        template <int Bits, bool Signed>
+        constexpr float Dequantize(int32_t q) noexcept {
+            const auto v = float(q)/NormalizedMax<Bits, Signed>;
+            return Signed && v< -1.0f ? -1.0f : v;
+        }
+    }
+
+    struct Half {
+        constexpr Half() noexcept = default;
+        constexpr Half(float v) noexcept
+                :Bits(Scalar::FloatToHalf(v)) { }
+        constexpr operator float() const noexcept { return Scalar::HalfToFloat(Bits); }
+        constexpr static Half FromBits(uint16_t bits) noexcept {
+            Half ret;
+            ret.Bits = bits;
+            return ret;
+        }
+
+        uint16_t Bits = 0;
+    };
+
+    template <class I>
+    struct Normalized {
+        static_assert(std::is_integral_v<I> && sizeof(I)<=2);
+        static constexpr bool Signed = std::is_signed_v<I>;
+        static constexpr int Bits = int(sizeof(I))*8;
+
+        constexpr Normalized() noexcept = default;
+        constexpr Normalized(float v) noexcept
+                :Value(I(Scalar::Quantize<Bits, Signed>(v))) { }
+        constexpr operator float() const noexcept { return Scalar::Dequantize<Bits, Signed>(Value); }
+
+        I Value = 0;
+    };
+
+    using SNorm8 = Normalized<int8_t>;
+    using SNorm16 = Normalized<int16_t>;
+    using UNorm8 = Normalized<uint8_t>;
+    using UNorm16 = Normalized<uint16_t>;
+
+    using Vec2H = Vec2<Half>;
+    using Vec3H = Vec3<Half>;
+    using Vec4H = Vec4<Half>;
+    using Vec2SN8 = Vec2<SNorm8>;
+    using Vec3SN8 = Vec3<SNorm8>;
+    using Vec4SN8 = Vec4<SNorm8>;
+    using Vec2SN16 = Vec2<SNorm16>;
+    using Vec3SN16 = Vec3<SNorm16>;
+    using Vec4SN16 = Vec4<SNorm16>;
+    using Vec2UN8 = Vec2<UNorm8>;
+    using Vec3UN8 = Vec3<UNorm8>;
+    using Vec4UN8 = Vec4<UNorm8>;
+    using Vec2UN16 = Vec2<UNorm16>;
+    using Vec3UN16 = Vec3<UNorm16>;
+    using Vec4UN16 = Vec4<UNorm16>;
+
+    constexpr uint32_t PackUNorm1010102(const Vec4F& v) noexcept {
+        return uint32_t(Scalar::Quantize<10, false>(v.Data[0])) | uint32_t(Scalar::Quantize<10, false>(v.Data[1])) << 10 |
+               uint32_t(Scalar::Quantize<10, false>(v.Data[2])) << 20 | uint32_t(Scalar::Quantize<2, false>(v.Data[3])) << 30;
+    }
+    constexpr Vec4F UnpackUNorm1010102(uint32_t p) noexcept {
+        return Vec4F(Scalar::Dequantize<10, false>(int32_t(p & 0x3FFu)), Scalar::Dequantize<10, false>(int32_t(p >> 10 & 0x3FFu)),
+                     Scalar::Dequantize<10, false>(int32_t(p >> 20 & 0x3FFu)), Scalar::Dequantize<2, false>(int32_t(p >> 30)));
+    }
+    constexpr uint32_t PackSNorm1010102(const Vec4F& v) noexcept {
+        return (uint32_t(Scalar::Quantize<10, true>(v.Data[0])) & 0x3FFu) |
+               (uint32_t(Scalar::Quantize<10, true>(v.Data[1])) & 0x3FFu) << 10 |
+               (uint32_t(Scalar::Quantize<10, true>(v.Data[2])) & 0x3FFu) << 20 | uint32_t(Scalar::Quantize<2, true>(v.Data[3])) << 30;
+    }
+    constexpr Vec4F UnpackSNorm1010102(uint32_t p) noexcept {
+        return Vec4F(Scalar::Dequantize<10, true>(int32_t(p << 22) >> 22), Scalar::Dequantize<10, true>(int32_t(p << 12) >> 22),
+                     Scalar::Dequantize<10, true>(int32_t(p << 2) >> 22), Scalar::Dequantize<2, true>(int32_t(p) >> 30));
+    }
+
+    // n must be unit length; the result lies in [-1, 1]^2
+    inline Vec2F OctahedralEncode(const Vec3F& n) noexcept {
+        const auto s = std::abs(n.X)+std::abs(n.Y)+std::abs(n.Z);
+        const auto x = n.X/s, y = n.Y/s;
+        if (n.Z<0.0f) return Vec2F(std::copysign(1.0f-std::abs(y), x), std::copysign(1.0f-std::abs(x), y));
+        return Vec2F(x, y);
+    }
+    inline Vec3F OctahedralDecode(const Vec2F& e) noexcept {
+        const auto z = 1.0f-std::abs(e.X)-std::abs(e.Y);
+        const auto t = std::max(-z, 0.0f);
+        const auto x = e.X-std::copysign(t, e.X), y = e.Y-std::copysign(t, e.Y);
+        const auto inv = 1.0f/std::sqrt(Scalar::Product(x, x)+Scalar::Product(y, y)+Scalar::Product(z, z));
+        return Vec3F(x*inv, y*inv, z*inv);
+    }
+
+    template <int Bits>
+    using OctahedralStorage = std::conditional_t<Bits==16, uint32_t, uint16_t>;
+
+    template <int Bits>
+    OctahedralStorage<Bits> PackOctahedral(const Vec3F& n) noexcept {
+        static_assert(Bits==8 || Bits==16);
+        constexpr auto mask = (1u << Bits)-1;
+        const auto e = OctahedralEncode(n);
+        return OctahedralStorage<Bits>((uint32_t(Scalar::Quantize<Bits, true>(e.X)) & mask) |
+                                       (uint32_t(Scalar::Quantize<Bits, true>(e.Y)) & mask) << Bits);
+    }
+    template <int Bits>
+    Vec3F UnpackOctahedral(OctahedralStorage<Bits> p) noexcept {
+        static_assert(Bits==8 || Bits==16);
+        const auto v = uint32_t(p);
+        return OctahedralDecode(Vec2F(Scalar::Dequantize<Bits, true>(int32_t(v << (32-Bits)) >> (32-Bits)),
+                                      Scalar::Dequantize<Bits, true>(int32_t(v << (32-2*Bits)) >> (32-Bits))));
+    }
+
+    inline uint32_t PackOctahedral16(const Vec3F& n) noexcept { return PackOctahedral<16>(n); }
+    inline Vec3F UnpackOctahedral16(uint32_t p) noexcept { return UnpackOctahedral<16>(p); }
+    inline uint16_t PackOctahedral8(const Vec3F& n) noexcept { return PackOctahedral<8>(n); }
+    inline Vec3F UnpackOctahedral8(uint16_t p) noexcept { return UnpackOctahedral<8>(p); }
+
+    namespace SIMD {
+        template <class From, class To>
+        using PackKernel = void (*)(const From*, To*, size_t) noexcept;
+
+        inline void HalfFromFloatScalar(const float* in, Half* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i) out[i] = Half(in[i]);
+        }
+        inline void FloatFromHalfScalar(const Half* in, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i) out[i] = float(in[i]);
+        }
+        template <class I>
+        void QuantizeScalar(const float* in, Normalized<I>* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i) out[i] = Normalized<I>(in[i]);
+        }
+        template <class I>
+        void DequantizeScalar(const Normalized<I>* in, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i) out[i] = float(in[i]);
+        }
+        template <bool Signed>
+        void Pack1010102Scalar(const float* in, uint32_t* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, in += 4) {
+                const Vec4F v(in[0], in[1], in[2], in[3]);
+                out[i] = Signed ? PackSNorm1010102(v) : PackUNorm1010102(v);
+            }
+        }
+        template <bool Signed>
+        void Unpack1010102Scalar(const uint32_t* in, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, out += 4) {
+                const auto v = Signed ? UnpackSNorm1010102(in[i]) : UnpackUNorm1010102(in[i]);
+                for (auto c = 0; c<4; ++c) out[c] = v.Data[c];
+            }
+        }
+        template <int Bits>
+        void PackOctahedralScalar(const float* in, OctahedralStorage<Bits>* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, in += 3) out[i] = PackOctahedral<Bits>(Vec3F(in[0], in[1], in[2]));
+        }
+        template <int Bits>
+        void UnpackOctahedralScalar(const OctahedralStorage<Bits>* in, float* out, size_t n) noexcept {
+            for (auto i = size_t(0); i<n; ++i, out += 3) {
+                const auto v = UnpackOctahedral<Bits>(in[i]);
+                for (auto c = 0; c<3; ++c) out[c] = v.Data[c];
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        MATH_TARGET("avx,f16c")
+        inline void HalfFromFloatF16C(const float* in, Half* out, size_t n) noexcept {
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),
+                        _mm256_cvtps_ph(_mm256_loadu_ps(in+i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+            HalfFromFloatScalar(in+i, out+i, n-i);
+        }
+
+        MATH_TARGET("avx,f16c")
+        inline void FloatFromHalfF16C(const Half* in, float* out, size_t n) noexcept {
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8)
+                _mm256_storeu_ps(out+i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i))));
+            FloatFromHalfScalar(in+i, out+i, n-i);
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline __m256 ProductAVX2(__m256 a, __m256 b) noexcept {
+            auto p = _mm256_mul_ps(a, b);
+#if defined(__GNUC__)
+            __asm__("" : "+x"(p));
+#endif
+            return p;
+        }
+
+        // clamp to [lo, 1] (NaN to lo), scale, round to nearest even
+        MATH_TARGET("avx2,fma")
+        inline __m256i QuantizeAVX2(__m256 x, __m256 lo, __m256 scale) noexcept {
+            return _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(x, lo), _mm256_set1_ps(1.0f)), scale));
+        }
+
+        template <class I>
+        MATH_TARGET("avx2,fma")
+        void QuantizeAVX2(const float* in, Normalized<I>* out, size_t n) noexcept {
+            constexpr auto Signed = Normalized<I>::Signed;
+            const auto lo = _mm256_set1_ps(Signed ? -1.0f : 0.0f);
+            const auto scale = _mm256_set1_ps(Scalar::NormalizedMax<Normalized<I>::Bits, Signed>);
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8) {
+                const auto q = QuantizeAVX2(_mm256_loadu_ps(in+i), lo, scale);
+                const auto l = _mm256_castsi256_si128(q), h = _mm256_extracti128_si256(q, 1);
+                if constexpr (sizeof(I)==2)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i), Signed ? _mm_packs_epi32(l, h) : _mm_packus_epi32(l, h));
+                else {
+                    const auto w = _mm_packs_epi32(l, h);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(out+i), Signed ? _mm_packs_epi16(w, w) : _mm_packus_epi16(w, w));
+                }
+            }
+            QuantizeScalar(in+i, out+i, n-i);
+        }
+
+        template <class I>
+        MATH_TARGET("avx2,fma")
+        void DequantizeAVX2(const Normalized<I>* in, float* out, size_t n) noexcept {
+            constexpr auto Signed = Normalized<I>::Signed;
+            const auto scale = _mm256_set1_ps(Scalar::NormalizedMax<Normalized<I>::Bits, Signed>);
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8) {
+                __m256i q;
+                if constexpr (sizeof(I)==2) {
+                    const auto raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i));
+                    q = Signed ? _mm256_cvtepi16_epi32(raw) : _mm256_cvtepu16_epi32(raw);
+                }
+                else {
+                    const auto raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in+i));
+                    q = Signed ? _mm256_cvtepi8_epi32(raw) : _mm256_cvtepu8_epi32(raw);
+                }
+                auto v = _mm256_div_ps(_mm256_cvtepi32_ps(q), scale);
+                if constexpr (Signed) v = _mm256_max_ps(v, _mm256_set1_ps(-1.0f));
+                _mm256_storeu_ps(out+i, v);
+            }
+            DequantizeScalar(in+i, out+i, n-i);
+        }
+
+        // two Vec4F per register; each 128-bit half is quantized per component and OR-reduced into its lane 0
+        template <bool Signed>
+        MATH_TARGET("avx2,fma")
+        void Pack1010102AVX2(const float* in, uint32_t* out, size_t n) noexcept {
+            const auto lo = _mm256_set1_ps(Signed ? -1.0f : 0.0f);
+            const auto xyz = Scalar::NormalizedMax<10, Signed>, w = Scalar::NormalizedMax<2, Signed>;
+            const auto scale = _mm256_setr_ps(xyz, xyz, xyz, w, xyz, xyz, xyz, w);
+            const auto mask = _mm256_setr_epi32(0x3FF, 0x3FF, 0x3FF, 0x3, 0x3FF, 0x3FF, 0x3FF, 0x3);
+            const auto shift = _mm256_setr_epi32(0, 10, 20, 30, 0, 10, 20, 30);
+            auto i = size_t(0);
+            for (; i+2<=n; i += 2) {
+                auto q = QuantizeAVX2(_mm256_loadu_ps(in+i*4), lo, scale);
+                q = _mm256_sllv_epi32(_mm256_and_si256(q, mask), shift);
+                q = _mm256_or_si256(q, _mm256_shuffle_epi32(q, _MM_SHUFFLE(1, 0, 3, 2)));
+                q = _mm256_or_si256(q, _mm256_shuffle_epi32(q, _MM_SHUFFLE(2, 3, 0, 1)));
+                out[i] = uint32_t(_mm256_cvtsi256_si32(q));
+                out[i+1] = uint32_t(_mm256_extract_epi32(q, 4));
+            }
+            Pack1010102Scalar<Signed>(in+i*4, out+i, n-i);
+        }
+
+        template <bool Signed>
+        MATH_TARGET("avx2,fma")
+        void Unpack1010102AVX2(const uint32_t* in, float* out, size_t n) noexcept {
+            const auto xyz = Scalar::NormalizedMax<10, Signed>, w = Scalar::NormalizedMax<2, Signed>;
+            const auto scale = _mm256_setr_ps(xyz, xyz, xyz, w, xyz, xyz, xyz, w);
+            auto i = size_t(0);
+            for (; i+2<=n; i += 2) {
+                const auto p = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(int(in[i]))),
+                        _mm_set1_epi32(int(in[i+1])), 1);
+                __m256i q;
+                if constexpr (Signed)
+                    q = _mm256_srav_epi32(_mm256_sllv_epi32(p, _mm256_setr_epi32(22, 12, 2, 0, 22, 12, 2, 0)),
+                            _mm256_setr_epi32(22, 22, 22, 30, 22, 22, 22, 30));
+                else
+                    q = _mm256_and_si256(_mm256_srlv_epi32(p, _mm256_setr_epi32(0, 10, 20, 30, 0, 10, 20, 30)),
+                            _mm256_setr_epi32(0x3FF, 0x3FF, 0x3FF, 0x3, 0x3FF, 0x3FF, 0x3FF, 0x3));
+                auto v = _mm256_div_ps(_mm256_cvtepi32_ps(q), scale);
+                if constexpr (Signed) v = _mm256_max_ps(v, _mm256_set1_ps(-1.0f));
+                _mm256_storeu_ps(out+i*4, v);
+            }
+            Unpack1010102Scalar<Signed>(in+i, out+i*4, n-i);
+        }
+
+        template <int Bits>
+        MATH_TARGET("avx2,fma")
+        void PackOctahedralAVX2(const float* in, OctahedralStorage<Bits>* out, size_t n) noexcept {
+            const auto sign = _mm256_set1_ps(-0.0f), one = _mm256_set1_ps(1.0f), lo = _mm256_set1_ps(-1.0f);
+            const auto scale = _mm256_set1_ps(Scalar::NormalizedMax<Bits, true>);
+            const auto mask = _mm256_set1_epi32((1 << Bits)-1);
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8) {
+                __m256 x, y, z;
+                Deinterleave3(in+i*3, x, y, z);
+                const auto s = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(sign, x), _mm256_andnot_ps(sign, y)),
+                        _mm256_andnot_ps(sign, z));
+                const auto ex = _mm256_div_ps(x, s), ey = _mm256_div_ps(y, s);
+                const auto fx = _mm256_or_ps(_mm256_sub_ps(one, _mm256_andnot_ps(sign, ey)), _mm256_and_ps(ex, sign));
+                const auto fy = _mm256_or_ps(_mm256_sub_ps(one, _mm256_andnot_ps(sign, ex)), _mm256_and_ps(ey, sign));
+                const auto fold = _mm256_cmp_ps(z, _mm256_setzero_ps(), _CMP_LT_OQ);
+                const auto qx = _mm256_and_si256(QuantizeAVX2(_mm256_blendv_ps(ex, fx, fold), lo, scale), mask);
+                const auto qy = _mm256_and_si256(QuantizeAVX2(_mm256_blendv_ps(ey, fy, fold), lo, scale), mask);
+                const auto q = _mm256_or_si256(qx, _mm256_slli_epi32(qy, Bits));
+                if constexpr (Bits==16)
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out+i), q);
+                else
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),
+                            _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1)));
+            }
+            PackOctahedralScalar<Bits>(in+i*3, out+i, n-i);
+        }
+
+        template <int Bits>
+        MATH_TARGET("avx2,fma")
+        void UnpackOctahedralAVX2(const OctahedralStorage<Bits>* in, float* out, size_t n) noexcept {
+            const auto sign = _mm256_set1_ps(-0.0f), one = _mm256_set1_ps(1.0f), lo = _mm256_set1_ps(-1.0f);
+            const auto scale = _mm256_set1_ps(Scalar::NormalizedMax<Bits, true>);
+            auto i = size_t(0);
+            for (; i+8<=n; i += 8) {
+                __m256i p;
+                if constexpr (Bits==16) p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in+i));
+                else p = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i)));
+                const auto qx = _mm256_srai_epi32(_mm256_slli_epi32(p, 32-Bits), 32-Bits);
+                const auto qy = _mm256_srai_epi32(_mm256_slli_epi32(p, 32-2*Bits), 32-Bits);
+                const auto ex = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(qx), scale), lo);
+                const auto ey = _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(qy), scale), lo);
+                const auto z = _mm256_sub_ps(_mm256_sub_ps(one, _mm256_andnot_ps(sign, ex)), _mm256_andnot_ps(sign, ey));
+                const auto t = _mm256_max_ps(_mm256_xor_ps(z, sign), _mm256_setzero_ps());
+                const auto x = _mm256_sub_ps(ex, _mm256_or_ps(t, _mm256_and_ps(ex, sign)));
+                const auto y = _mm256_sub_ps(ey, _mm256_or_ps(t, _mm256_and_ps(ey, sign)));
+                const auto len = _mm256_add_ps(_mm256_add_ps(ProductAVX2(x, x), ProductAVX2(y, y)), ProductAVX2(z, z));
+                const auto inv = _mm256_div_ps(one, _mm256_sqrt_ps(len));
+                Interleave3(out+i*3, _mm256_mul_ps(x, inv), _mm256_mul_ps(y, inv), _mm256_mul_ps(z, inv));
+            }
+            UnpackOctahedralScalar<Bits>(in+i, out+i*3, n-i);
+        }
+#endif
+
+        inline PackKernel<float, Half> SelectHalfFromFloat() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().F16C) return &HalfFromFloatF16C;
+#endif
+            return &HalfFromFloatScalar;
+        }
+        inline PackKernel<Half, float> SelectFloatFromHalf() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().F16C) return &FloatFromHalfF16C;
+#endif
+            return &FloatFromHalfScalar;
+        }
+
+        template <class I>
+        PackKernel<float, Normalized<I>> SelectQuantize() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &QuantizeAVX2<I>;
+#endif
+            return &QuantizeScalar<I>;
+        }
+
+        template <class I>
+        PackKernel<Normalized<I>, float> SelectDequantize() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &DequantizeAVX2<I>;
+#endif
+            return &DequantizeScalar<I>;
+        }
+
+        template <bool Signed>
+        PackKernel<float, uint32_t> SelectPack1010102() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &Pack1010102AVX2<Signed>;
+#endif
+            return &Pack1010102Scalar<Signed>;
+        }
+
+        template <bool Signed>
+        PackKernel<uint32_t, float> SelectUnpack1010102() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &Unpack1010102AVX2<Signed>;
+#endif
+            return &Unpack1010102Scalar<Signed>;
+        }
+
+        template <int Bits>
+        PackKernel<float, OctahedralStorage<Bits>> SelectPackOctahedral() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &PackOctahedralAVX2<Bits>;
+#endif
+            return &PackOctahedralScalar<Bits>;
+        }
+
+        template <int Bits>
+        PackKernel<OctahedralStorage<Bits>, float> SelectUnpackOctahedral() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            if (CPU().AVX2 && CPU().FMA) return &UnpackOctahedralAVX2<Bits>;
+#endif
+            return &UnpackOctahedralScalar<Bits>;
+        }
+    }
+
+    inline void Convert(std::span<const float> in, std::span<Half> out) noexcept {
+        static const auto kernel = SIMD::SelectHalfFromFloat();
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+    inline void Convert(std::span<const Half> in, std::span<float> out) noexcept {
+        static const auto kernel = SIMD::SelectFloatFromHalf();
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+    template <class I>
+    void Convert(std::span<const float> in, std::span<Normalized<I>> out) noexcept {
+        static const auto kernel = SIMD::SelectQuantize<I>();
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+    template <class I>
+    void Convert(std::span<const Normalized<I>> in, std::span<float> out) noexcept {
+        static const auto kernel = SIMD::SelectDequantize<I>();
+        kernel(in.data(), out.data(), std::min(in.size(), out.size()));
+    }
+    // component-wise over whole vectors
+    template <size_t D, class P>
+    void Convert(std::span<const Vec<D, float>> in, std::span<Vec<D, P>> out) noexcept {
+        static_assert(sizeof(Vec<D, float>)==D*sizeof(float) && sizeof(Vec<D, P>)==D*sizeof(P));
+        const auto n = std::min(in.size(), out.size())*D;
+        Convert(std::span<const float>(reinterpret_cast<const float*>(in.data()), n),
+                std::span<P>(reinterpret_cast<P*>(out.data()), n));
+    }
+    template <size_t D, class P>
+    void Convert(std::span<const Vec<D, P>> in, std::span<Vec<D, float>> out) noexcept {
+        static_assert(sizeof(Vec<D, float>)==D*sizeof(float) && sizeof(Vec<D, P>)==D*sizeof(P));
+        const auto n = std::min(in.size(), out.size())*D;
+        Convert(std::span<const P>(reinterpret_cast<const P*>(in.data()), n),
+                std::span<float>(reinterpret_cast<float*>(out.data()), n));
+    }
+
+    inline void PackUNorm1010102(std::span<const Vec4F> in, std::span<uint32_t> out) noexcept {
+        static const auto kernel = SIMD::SelectPack1010102<false>();
+        kernel(reinterpret_cast<const float*>(in.data()), out.data(), std::min(in.size(), out.size()));
+    }
+    inline void UnpackUNorm1010102(std::span<const uint32_t> in, std::span<Vec4F> out) noexcept {
+        static const auto kernel = SIMD::SelectUnpack1010102<false>();
+        kernel(in.data(), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+    inline void PackSNorm1010102(std::span<const Vec4F> in, std::span<uint32_t> out) noexcept {
+        static const auto kernel = SIMD::SelectPack1010102<true>();
+        kernel(reinterpret_cast<const float*>(in.data()), out.data(), std::min(in.size(), out.size()));
+    }
+    inline void UnpackSNorm1010102(std::span<const uint32_t> in, std::span<Vec4F> out) noexcept {
+        static const auto kernel = SIMD::SelectUnpack1010102<true>();
+        kernel(in.data(), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+
+    template <int Bits>
+    void PackOctahedral(std::span<const Vec3F> in, std::span<OctahedralStorage<Bits>> out) noexcept {
+        static const auto kernel = SIMD::SelectPackOctahedral<Bits>();
+        kernel(reinterpret_cast<const float*>(in.data()), out.data(), std::min(in.size(), out.size()));
+    }
+    template <int Bits>
+    void UnpackOctahedral(std::span<const OctahedralStorage<Bits>> in, std::span<Vec3F> out) noexcept {
+        static const auto kernel = SIMD::SelectUnpackOctahedral<Bits>();
+        kernel(in.data(), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+    inline void PackOctahedral16(std::span<const Vec3F> in, std::span<uint32_t> out) noexcept { PackOctahedral<16>(in, out); }
+    inline void UnpackOctahedral16(std::span<const uint32_t> in, std::span<Vec3F> out) noexcept { UnpackOctahedral<16>(in, out); }
+    inline void PackOctahedral8(std::span<const Vec3F> in, std::span<uint16_t> out) noexcept { PackOctahedral<8>(in, out); }
+    inline void UnpackOctahedral8(std::span<const uint16_t> in, std::span<Vec3F> out) noexcept { UnpackOctahedral<8>(in, out); }
+
+}
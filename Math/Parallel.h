@@ -0,0 +1,128 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <condition_variable>
+
+namespace Math::Parallel {
+    // Fixed set of worker threads running one blocking index loop at a time.
+    // The calling thread takes part in every loop. A loop started while another one is running, or from inside a
+    // loop body of any pool, runs serially on the caller instead of waiting, so nesting cannot deadlock.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned workers = std::max(std::thread::hardware_concurrency(), 1u)-1) {
+            _Workers.reserve(workers);
+            for (auto i = 0u; i<workers; ++i) _Workers.emplace_back([this] { Work(); });
+        }
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool() noexcept {
+            {
+                std::lock_guard lk(_Mutex);
+                _Stop = true;
+            }
+            _Wake.notify_all();
+            for (auto& t : _Workers) t.join();
+        }
+
+        // number of threads a loop can run on, the caller included
+        unsigned Concurrency() const noexcept { return unsigned(_Workers.size())+1; }
+
+        // Calls fn(i) for every i in [0, count) and returns when all calls have finished.
+        // fn must not throw.
+        template <class F>
+        void For(size_t count, F&& fn) {
+            if (count==0) return;
+            // a body runs while its caller holds _Submit, so re-entry is detected before touching the mutex
+            if (count==1 || _Workers.empty() || _InLoop || !_Submit.try_lock()) {
+                for (auto i = size_t(0); i<count; ++i) fn(i);
+                return;
+            }
+            Job job{&Invoke<std::remove_reference_t<F>>, const_cast<void*>(static_cast<const void*>(&fn)), count};
+            job.Pending.store(unsigned(_Workers.size()), std::memory_order_relaxed);
+            {
+                std::lock_guard lk(_Mutex);
+                _Job = &job;
+                ++_Generation;
+            }
+            _Wake.notify_all();
+            Run(job);
+            {
+                std::unique_lock lk(_Mutex);
+                _Done.wait(lk, [&job] { return job.Pending.load(std::memory_order_acquire)==0; });
+                _Job = nullptr;
+            }
+            _Submit.unlock();
+        }
+    private:
+        struct Job {
+            void (*Call)(void*, size_t);
+            void* Fn;
+            size_t Count;
+            std::atomic<size_t> Next{0};
+            std::atomic<unsigned> Pending{0};
+        };
+
+        template <class F>
+        static void Invoke(void* fn, size_t i) { (*static_cast<F*>(fn))(i); }
+
+        static void Run(Job& job) {
+            _InLoop = true;
+            for (auto i = job.Next.fetch_add(1, std::memory_order_relaxed); i<job.Count;
+                 i = job.Next.fetch_add(1, std::memory_order_relaxed))
+                job.Call(job.Fn, i);
+            _InLoop = false;
+        }
+
+        void Work() {
+            auto seen = size_t(0);
+            for (;;) {
+                Job* job;
+                {
+                    std::unique_lock lk(_Mutex);
+                    _Wake.wait(lk, [&] { return _Stop || _Generation!=seen; });
+                    if (_Stop) return;
+                    seen = _Generation;
+                    job = _Job;
+                }
+                Run(*job);
+                if (job->Pending.fetch_sub(1, std::memory_order_acq_rel)==1) {
+                    std::lock_guard lk(_Mutex);
+                    _Done.notify_one();
+                }
+            }
+        }
+
+        // set while this thread runs loop bodies
+        static inline thread_local bool _InLoop = false;
+
+        std::vector<std::thread> _Workers;
+        std::mutex _Submit;
+        std::mutex _Mutex;
+        std::condition_variable _Wake, _Done;
+        Job* _Job = nullptr;
+        size_t _Generation = 0;
+        bool _Stop = false;
+    };
+
+    // process-wide pool sized to the hardware, created on first use
+    inline ThreadPool& DefaultPool() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Splits [begin, end) into chunks of at least grain elements and calls fn(chunkBegin, chunkEnd) on the default pool
+    template <class F>
+    void For(size_t begin, size_t end, size_t grain, F&& fn) {
+        if (end<=begin) return;
+        auto& pool = DefaultPool();
+        const auto total = end-begin;
+        const auto chunks = std::max<size_t>(1, std::min<size_t>(total/std::max<size_t>(grain, 1), pool.Concurrency()*4));
+        const auto step = (total+chunks-1)/chunks;
+        pool.For((total+step-1)/step, [&](size_t c) { fn(begin+c*step, std::min(end, begin+(c+1)*step)); });
+    }
+}
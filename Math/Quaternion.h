@@ -0,0 +1,222 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include "Matrix.h"
+#include "Transform.h"
+#include "SIMD.h"
+
+namespace Math {
+    // Rotation quaternion x*i + y*j + z*k + w stored as Vec4 (X, Y, Z, T = w).
+    // Matrix conversions follow the library's column-vector convention: ToMat3() * v == Rotate(v).
+    template <class T>
+    class Quat {
+    public:
+        using DataType = T;
+
+        constexpr Quat() noexcept
+                :_Stg(T(0), T(0), T(0), T(1)) { }
+        constexpr Quat(T x, T y, T z, T w) noexcept
+                :_Stg(x, y, z, w) { }
+        constexpr explicit Quat(const Vec4<T>& v) noexcept
+                :_Stg(v) { }
+
+        constexpr T X() const noexcept { return _Stg.Data[0]; }
+        constexpr T Y() const noexcept { return _Stg.Data[1]; }
+        constexpr T Z() const noexcept { return _Stg.Data[2]; }
+        constexpr T W() const noexcept { return _Stg.Data[3]; }
+        constexpr const Vec4<T>& AsVec() const noexcept { return _Stg; }
+
+        constexpr static Quat Identity() noexcept { return {}; }
+        // axis must be unit length; angle in radians
+        static Quat AxisAngle(const Vec3<T>& axis, T angle) noexcept {
+            const T s = std::sin(angle/T(2));
+            return {axis.X*s, axis.Y*s, axis.Z*s, std::cos(angle/T(2))};
+        }
+        // m must be a rotation (orthonormal, determinant 1)
+        static Quat FromMatrix(const Mat<T, 3, 3>& m) noexcept { return FromRotation(m); }
+        // uses the upper-left 3x3 block
+        static Quat FromMatrix(const Mat<T, 4, 4>& m) noexcept { return FromRotation(m); }
+
+        constexpr bool operator==(const Quat& r) const noexcept { return _Stg==r._Stg; }
+        constexpr Quat operator-() const noexcept { return Quat(-_Stg); }
+        // Hamilton product: (l * r) applies r first, then l
+        constexpr Quat operator*(const Quat& r) const noexcept {
+            const auto& a = _Stg.Data;
+            const auto& b = r._Stg.Data;
+            return {a[3]*b[0]+a[0]*b[3]+a[1]*b[2]-a[2]*b[1],
+                    a[3]*b[1]-a[0]*b[2]+a[1]*b[3]+a[2]*b[0],
+                    a[3]*b[2]+a[0]*b[1]-a[1]*b[0]+a[2]*b[3],
+                    a[3]*b[3]-a[0]*b[0]-a[1]*b[1]-a[2]*b[2]};
+        }
+        Quat& operator*=(const Quat& r) noexcept { return (*this = *this*r); }
+
+        constexpr Quat Conjugate() const noexcept { return {-X(), -Y(), -Z(), W()}; }
+        constexpr Quat Inverse() const noexcept { return Quat(Conjugate()._Stg/LengthSqr()); }
+        constexpr T Dot(const Quat& r) const noexcept { return _Stg.Dot(r._Stg); }
+        constexpr T LengthSqr() const noexcept { return _Stg.LengthSqr(); }
+        T Length() const noexcept { return std::sqrt(LengthSqr()); }
+        Quat Normalized() const noexcept { return Quat(_Stg/Length()); }
+
+        // v' = v + w t + u x t with t = 2 u x v, for unit quaternions
+        constexpr Vec3<T> Rotate(const Vec3<T>& v) const noexcept {
+            const Vec3<T> u(X(), Y(), Z());
+            const auto t = (u*v)*T(2);
+            return v+t*W()+u*t;
+        }
+        constexpr Vec3<T> operator*(const Vec3<T>& v) const noexcept { return Rotate(v); }
+
+        constexpr Mat<T, 3, 3> ToMat3() const noexcept {
+            T e[9] {};
+            Elements(e);
+            return {e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7], e[8]};
+        }
+        constexpr Mat<T, 4, 4> ToMat4() const noexcept {
+            T e[9] {};
+            Elements(e);
+            return {
+                e[0], e[1], e[2], T(0),
+                e[3], e[4], e[5], T(0),
+                e[6], e[7], e[8], T(0),
+                T(0), T(0), T(0), T(1)
+            };
+        }
+    private:
+        // row-major rotation matrix entries
+        constexpr void Elements(T (&e)[9]) const noexcept {
+            const T x = X(), y = Y(), z = Z(), w = W();
+            const T xx = x*x, yy = y*y, zz = z*z, xy = x*y, xz = x*z, yz = y*z, wx = w*x, wy = w*y, wz = w*z;
+            e[0] = T(1)-T(2)*(yy+zz), e[1] = T(2)*(xy-wz), e[2] = T(2)*(xz+wy);
+            e[3] = T(2)*(xy+wz), e[4] = T(1)-T(2)*(xx+zz), e[5] = T(2)*(yz-wx);
+            e[6] = T(2)*(xz-wy), e[7] = T(2)*(yz+wx), e[8] = T(1)-T(2)*(xx+yy);
+        }
+
+        // Shepperd's method: pivot on the largest of the trace and the diagonal
+        template <class M>
+        static Quat FromRotation(const M& m) noexcept {
+            const T tr = m(0, 0)+m(1, 1)+m(2, 2);
+            if (tr>T(0)) {
+                const T s = std::sqrt(tr+T(1))*T(2);
+                return {(m(2, 1)-m(1, 2))/s, (m(0, 2)-m(2, 0))/s, (m(1, 0)-m(0, 1))/s, s/T(4)};
+            }
+            if (m(0, 0)>m(1, 1) && m(0, 0)>m(2, 2)) {
+                const T s = std::sqrt(T(1)+m(0, 0)-m(1, 1)-m(2, 2))*T(2);
+                return {s/T(4), (m(0, 1)+m(1, 0))/s, (m(0, 2)+m(2, 0))/s, (m(2, 1)-m(1, 2))/s};
+            }
+            if (m(1, 1)>m(2, 2)) {
+                const T s = std::sqrt(T(1)+m(1, 1)-m(0, 0)-m(2, 2))*T(2);
+                return {(m(0, 1)+m(1, 0))/s, s/T(4), (m(1, 2)+m(2, 1))/s, (m(0, 2)-m(2, 0))/s};
+            }
+            const T s = std::sqrt(T(1)+m(2, 2)-m(0, 0)-m(1, 1))*T(2);
+            return {(m(0, 2)+m(2, 0))/s, (m(1, 2)+m(2, 1))/s, s/T(4), (m(1, 0)-m(0, 1))/s};
+        }
+
+        Vec4<T> _Stg;
+    };
+
+    using QuatF = Quat<float>;
+    using QuatD = Quat<double>;
+
+    // Normalized linear interpolation along the shorter arc
+    template <class T>
+    Quat<T> Nlerp(const Quat<T>& a, const Quat<T>& b, T t) noexcept {
+        const auto& bv = a.Dot(b)<T(0) ? -b.AsVec() : b.AsVec();
+        return Quat<T>(a.AsVec()*(T(1)-t)+bv*t).Normalized();
+    }
+
+    // Spherical interpolation along the shorter arc; falls back to Nlerp for nearly parallel inputs
+    template <class T>
+    Quat<T> Slerp(const Quat<T>& a, const Quat<T>& b, T t) noexcept {
+        T d = a.Dot(b);
+        const auto& bv = d<T(0) ? -b.AsVec() : b.AsVec();
+        d = std::abs(d);
+        if (d>T(0.9995)) return Quat<T>(a.AsVec()*(T(1)-t)+bv*t).Normalized();
+        const T theta = std::acos(d), s = T(1)/std::sin(theta);
+        return Quat<T>(a.AsVec()*(std::sin((T(1)-t)*theta)*s)+bv*(std::sin(t*theta)*s));
+    }
+
+    namespace SIMD {
+        // lanes of b are negated where dot(a, b) < 0 so both interpolations take the shorter arc
+        inline F32x8 ShortestArc(const F32x8 (&a)[4], F32x8 (&b)[4]) noexcept {
+            auto d = a[0]*b[0];
+            d = MulAdd(a[1], b[1], d);
+            d = MulAdd(a[2], b[2], d);
+            d = MulAdd(a[3], b[3], d);
+            const auto sign = d & F32x8::Broadcast(-0.0f);
+            for (auto& c : b) c = c ^ sign;
+            return d ^ sign;
+        }
+
+        // Eberly, "A Fast and Accurate Algorithm for Computing SLERP": sin(t*theta)/sin(theta) is expanded as a
+        // polynomial in cos(theta), so there is no acos/sin and no branch. The published fit (8 terms, mu 1.85298)
+        // is off by up to 2e-5 in float; 12 terms with the last one scaled by mu = 1.8937, refit the same way,
+        // bring that to 8e-7 over the shorter arc (checked in Tests/QuaternionTest.cpp).
+        inline void SlerpCoefficients(F32x8 cosTheta, F32x8 t, F32x8& ca, F32x8& cb) noexcept {
+            constexpr int Terms = 12;
+            constexpr float mu = 1.8937f;
+            constexpr auto u = [](int i) noexcept { return (i==Terms ? mu : 1.0f)/float(i*(2*i+1)); };
+            constexpr auto v = [](int i) noexcept { return (i==Terms ? mu : 1.0f)*float(i)/float(2*i+1); };
+            const auto one = F32x8::Broadcast(1.0f);
+            const auto xm1 = cosTheta-one, s = one-t;
+            const auto tt = t*t, ss = s*s;
+            auto pt = one, ps = one;
+            for (auto i = Terms; i>0; --i) {
+                const auto ui = F32x8::Broadcast(u(i)), vi = F32x8::Broadcast(v(i));
+                pt = MulAdd((ui*tt-vi)*xm1, pt, one);
+                ps = MulAdd((ui*ss-vi)*xm1, ps, one);
+            }
+            ca = s*ps;
+            cb = t*pt;
+        }
+    }
+
+    // Batched forms over min(a.size(), b.size(), out.size()) elements; out may alias a or b.
+    inline void Nlerp(std::span<const QuatF> a, std::span<const QuatF> b, float t, std::span<QuatF> out) noexcept {
+        const auto n = std::min({a.size(), b.size(), out.size()});
+        auto pa = reinterpret_cast<const float*>(a.data());
+        auto pb = reinterpret_cast<const float*>(b.data());
+        auto po = reinterpret_cast<float*>(out.data());
+        auto i = size_t(0);
+        const auto vt = SIMD::F32x8::Broadcast(t), vs = SIMD::F32x8::Broadcast(1.0f-t);
+        for (; i+8<=n; i += 8) {
+            SIMD::F32x8 qa[4], qb[4];
+            SIMD::F32x8::Load4(pa+i*4, qa[0], qa[1], qa[2], qa[3]);
+            SIMD::F32x8::Load4(pb+i*4, qb[0], qb[1], qb[2], qb[3]);
+            SIMD::ShortestArc(qa, qb);
+            SIMD::F32x8 r[4];
+            for (auto c = 0; c<4; ++c) r[c] = MulAdd(qb[c], vt, qa[c]*vs);
+            auto len = r[0]*r[0];
+            len = MulAdd(r[1], r[1], len);
+            len = MulAdd(r[2], r[2], len);
+            len = MulAdd(r[3], r[3], len);
+            const auto inv = SIMD::F32x8::Broadcast(1.0f)/Sqrt(len);
+            SIMD::F32x8::Store4(po+i*4, r[0]*inv, r[1]*inv, r[2]*inv, r[3]*inv);
+        }
+        for (; i<n; ++i) out[i] = Nlerp(a[i], b[i], t);
+    }
+
+    inline void Slerp(std::span<const QuatF> a, std::span<const QuatF> b, float t, std::span<QuatF> out) noexcept {
+        const auto n = std::min({a.size(), b.size(), out.size()});
+        auto pa = reinterpret_cast<const float*>(a.data());
+        auto pb = reinterpret_cast<const float*>(b.data());
+        auto po = reinterpret_cast<float*>(out.data());
+        auto i = size_t(0);
+        const auto vt = SIMD::F32x8::Broadcast(t);
+        for (; i+8<=n; i += 8) {
+            SIMD::F32x8 qa[4], qb[4], ca, cb;
+            SIMD::F32x8::Load4(pa+i*4, qa[0], qa[1], qa[2], qa[3]);
+            SIMD::F32x8::Load4(pb+i*4, qb[0], qb[1], qb[2], qb[3]);
+            SIMD::SlerpCoefficients(SIMD::ShortestArc(qa, qb), vt, ca, cb);
+            SIMD::F32x8::Store4(po+i*4, MulAdd(qb[0], cb, qa[0]*ca), MulAdd(qb[1], cb, qa[1]*ca),
+                    MulAdd(qb[2], cb, qa[2]*ca), MulAdd(qb[3], cb, qa[3]*ca));
+        }
+        for (; i<n; ++i) out[i] = Slerp(a[i], b[i], t);
+    }
+
+    // Rotating many vectors by one quaternion goes through the 3x3 matrix (9 multiply-adds per vector
+    // instead of 18) and the runtime-dispatched TransformVectors kernels.
+    inline void Rotate(const QuatF& q, std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        TransformVectors(q.ToMat4(), in, out);
+    }
+    inline void Rotate(const QuatF& q, std::span<Vec3F> v) noexcept { Rotate(q, v, v); }
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <limits>
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+#include "AABB.h"
+#include "SIMD.h"
+
+// Rays and the shared ray/box (slab) and ray/triangle (Moller-Trumbore) intersection core.
+// Scalar forms work on any floating type; the 8-wide forms test one ray against 8 boxes or triangles, or a packet
+// of 8 rays against one box or triangle, on F32x8 (one AVX2 register, two SSE registers or scalar lanes).
+// They return a bitmask with bit i set when lane i hits, and write per-lane hit distances.
+// Hits are accepted for tMin <= t <= tMax. Triangles are two-sided; boxes must not be empty.
+namespace Math {
+    template <class T>
+    struct Ray {
+        constexpr Ray() noexcept = default;
+        constexpr Ray(const Vec3<T>& origin, const Vec3<T>& direction) noexcept
+                :Origin(origin), Direction(direction) { }
+        constexpr Vec3<T> At(T t) const noexcept { return Origin+Direction*t; }
+
+        Vec3<T> Origin, Direction;
+    };
+
+    using RayF = Ray<float>;
+    using RayD = Ray<double>;
+
+    // Component-wise 1 / d for slab tests. Zero components map to +-max instead of +-inf, so a ray lying in a
+    // slab plane yields 0 * max = 0 instead of 0 * inf = NaN.
+    template <class T>
+    Vec3<T> SafeInverse(const Vec3<T>& d) noexcept {
+        Vec3<T> ret{VectorUninitialized};
+        for (auto a = 0; a<3; ++a) {
+            const auto inv = T(1)/d.Data[a];
+            ret.Data[a] = std::abs(inv)<=std::numeric_limits<T>::max() ? inv :
+                    std::copysign(std::numeric_limits<T>::max(), d.Data[a]);
+        }
+        return ret;
+    }
+
+    // invDir is SafeInverse(ray.Direction); tEnter is max(tMin, entry distance) on a hit
+    template <class T>
+    bool IntersectBox(const Ray<T>& ray, const Vec3<T>& invDir, const AABB<T>& box, T tMin, T tMax, T& tEnter) noexcept {
+        for (auto a = 0; a<3; ++a) {
+            const auto t0 = (box.Min.Data[a]-ray.Origin.Data[a])*invDir.Data[a];
+            const auto t1 = (box.Max.Data[a]-ray.Origin.Data[a])*invDir.Data[a];
+            tMin = std::max(tMin, std::min(t0, t1));
+            tMax = std::min(tMax, std::max(t0, t1));
+        }
+        tEnter = tMin;
+        return tMin<=tMax;
+    }
+
+    // t is the distance along the ray, (u, v) the barycentric weights of v1 and v2
+    template <class T>
+    bool IntersectTriangle(const Ray<T>& ray, const Vec3<T>& v0, const Vec3<T>& v1, const Vec3<T>& v2, T tMin, T tMax,
+                           T& t, T& u, T& v) noexcept {
+        const auto e1 = v1-v0, e2 = v2-v0;
+        const auto p = ray.Direction*e2;
+        const auto det = e1.Dot(p);
+        if (det==T(0)) return false;
+        const auto inv = T(1)/det;
+        const auto s = ray.Origin-v0;
+        u = s.Dot(p)*inv;
+        const auto q = s*e1;
+        v = ray.Direction.Dot(q)*inv;
+        t = e2.Dot(q)*inv;
+        return u>=T(0) && v>=T(0) && u+v<=T(1) && t>=tMin && t<=tMax;
+    }
+
+    namespace SIMD {
+        // Structure-of-arrays slab test; lanes that miss have tEnter unspecified
+        inline F32x8 SlabTest8(const F32x8 (&origin)[3], const F32x8 (&inverse)[3], const F32x8 (&min)[3],
+                               const F32x8 (&max)[3], F32x8 tMin, F32x8 tMax, F32x8& tEnter) noexcept {
+            for (auto a = 0; a<3; ++a) {
+                const auto t0 = (min[a]-origin[a])*inverse[a], t1 = (max[a]-origin[a])*inverse[a];
+                tMin = Max(tMin, Min(t0, t1));
+                tMax = Min(tMax, Max(t0, t1));
+            }
+            tEnter = tMin;
+            return tMin<=tMax;
+        }
+
+        inline void Cross8(const F32x8 (&a)[3], const F32x8 (&b)[3], F32x8 (&out)[3]) noexcept {
+            out[0] = a[1]*b[2]-a[2]*b[1];
+            out[1] = a[2]*b[0]-a[0]*b[2];
+            out[2] = a[0]*b[1]-a[1]*b[0];
+        }
+
+        inline F32x8 Dot8(const F32x8 (&a)[3], const F32x8 (&b)[3]) noexcept {
+            return MulAdd(a[2], b[2], MulAdd(a[1], b[1], a[0]*b[0]));
+        }
+
+        // Structure-of-arrays Moller-Trumbore with edges e1 = v1 - v0, e2 = v2 - v0
+        inline F32x8 MollerTrumbore8(const F32x8 (&origin)[3], const F32x8 (&dir)[3], const F32x8 (&v0)[3],
+                                     const F32x8 (&e1)[3], const F32x8 (&e2)[3], F32x8 tMin, F32x8 tMax,
+                                     F32x8& t, F32x8& u, F32x8& v) noexcept {
+            const auto zero = F32x8::Zero(), one = F32x8::Broadcast(1.0f);
+            F32x8 p[3], q[3];
+            Cross8(dir, e2, p);
+            const auto det = Dot8(e1, p);
+            const auto inv = one/det;
+            const F32x8 s[3] = {origin[0]-v0[0], origin[1]-v0[1], origin[2]-v0[2]};
+            u = Dot8(s, p)*inv;
+            Cross8(s, e1, q);
+            v = Dot8(dir, q)*inv;
+            t = Dot8(e2, q)*inv;
+            return AndNot(det==zero, (u>=zero) & (v>=zero) & (u+v<=one) & (t>=tMin) & (t<=tMax));
+        }
+
+        inline F32x8 SafeInverse8(F32x8 d) noexcept {
+            const auto inv = F32x8::Broadcast(1.0f)/d;
+            const auto max = F32x8::Broadcast(std::numeric_limits<float>::max());
+            return Select(Abs(inv)<=max, inv, (d & F32x8::Broadcast(-0.0f)) | max);
+        }
+    }
+
+    // Up to 8 rays in structure-of-arrays form; unused lanes never hit
+    struct RayPacket8 {
+        SIMD::F32x8 Origin[3], Direction[3], Inverse[3], TMin, TMax;
+
+        static RayPacket8 Load(std::span<const RayF> rays, float tMin = 0.0f,
+                               float tMax = std::numeric_limits<float>::infinity()) noexcept {
+            float lanes[6][8]{}, lo[8], hi[8];
+            const auto n = std::min<size_t>(rays.size(), 8);
+            for (auto i = size_t(0); i<8; ++i) {
+                lo[i] = tMin;
+                hi[i] = i<n ? tMax : -std::numeric_limits<float>::infinity();
+                if (i>=n) continue;
+                for (auto a = 0; a<3; ++a) {
+                    lanes[a][i] = rays[i].Origin.Data[a];
+                    lanes[3+a][i] = rays[i].Direction.Data[a];
+                }
+            }
+            RayPacket8 ret;
+            for (auto a = 0; a<3; ++a) {
+                ret.Origin[a] = SIMD::F32x8::Load(lanes[a]);
+                ret.Direction[a] = SIMD::F32x8::Load(lanes[3+a]);
+                ret.Inverse[a] = SIMD::SafeInverse8(ret.Direction[a]);
+            }
+            ret.TMin = SIMD::F32x8::Load(lo);
+            ret.TMax = SIMD::F32x8::Load(hi);
+            return ret;
+        }
+    };
+
+    // Up to 8 boxes in structure-of-arrays form; Active has a bit per loaded box
+    struct BoxPacket8 {
+        SIMD::F32x8 Min[3], Max[3];
+        int Active;
+
+        static BoxPacket8 Load(std::span<const AABBF> boxes) noexcept {
+            float lanes[6][8]{};
+            const auto n = std::min<size_t>(boxes.size(), 8);
+            for (auto i = size_t(0); i<n; ++i)
+                for (auto a = 0; a<3; ++a) {
+                    lanes[a][i] = boxes[i].Min.Data[a];
+                    lanes[3+a][i] = boxes[i].Max.Data[a];
+                }
+            BoxPacket8 ret;
+            for (auto a = 0; a<3; ++a) {
+                ret.Min[a] = SIMD::F32x8::Load(lanes[a]);
+                ret.Max[a] = SIMD::F32x8::Load(lanes[3+a]);
+            }
+            ret.Active = (1 << n)-1;
+            return ret;
+        }
+    };
+
+    // Up to 8 triangles as a vertex and two edges in structure-of-arrays form; unused lanes are degenerate
+    // and never hit
+    struct TrianglePacket8 {
+        SIMD::F32x8 V0[3], E1[3], E2[3];
+
+        // vertices holds three corners per triangle
+        static TrianglePacket8 Load(std::span<const Vec3F> vertices) noexcept {
+            float lanes[9][8]{};
+            const auto n = std::min<size_t>(vertices.size()/3, 8);
+            for (auto i = size_t(0); i<n; ++i)
+                for (auto c = 0; c<3; ++c)
+                    for (auto a = 0; a<3; ++a) lanes[c*3+a][i] = vertices[i*3+c].Data[a];
+            TrianglePacket8 ret;
+            for (auto a = 0; a<3; ++a) {
+                ret.V0[a] = SIMD::F32x8::Load(lanes[a]);
+                ret.E1[a] = SIMD::F32x8::Load(lanes[3+a])-ret.V0[a];
+                ret.E2[a] = SIMD::F32x8::Load(lanes[6+a])-ret.V0[a];
+            }
+            return ret;
+        }
+    };
+
+    // 8 rays against one box
+    inline int IntersectBox(const RayPacket8& rays, const AABBF& box, SIMD::F32x8& tEnter) noexcept {
+        using SIMD::F32x8;
+        const F32x8 min[3] = {F32x8::Broadcast(box.Min.X), F32x8::Broadcast(box.Min.Y), F32x8::Broadcast(box.Min.Z)};
+        const F32x8 max[3] = {F32x8::Broadcast(box.Max.X), F32x8::Broadcast(box.Max.Y), F32x8::Broadcast(box.Max.Z)};
+        return SIMD::SlabTest8(rays.Origin, rays.Inverse, min, max, rays.TMin, rays.TMax, tEnter).Mask();
+    }
+
+    // one ray against 8 boxes; invDir is SafeInverse(ray.Direction)
+    inline int IntersectBoxes(const RayF& ray, const Vec3F& invDir, const BoxPacket8& boxes, float tMin, float tMax,
+                              SIMD::F32x8& tEnter) noexcept {
+        using SIMD::F32x8;
+        const F32x8 o[3] = {F32x8::Broadcast(ray.Origin.X), F32x8::Broadcast(ray.Origin.Y), F32x8::Broadcast(ray.Origin.Z)};
+        const F32x8 inv[3] = {F32x8::Broadcast(invDir.X), F32x8::Broadcast(invDir.Y), F32x8::Broadcast(invDir.Z)};
+        const auto hit = SIMD::SlabTest8(o, inv, boxes.Min, boxes.Max, F32x8::Broadcast(tMin), F32x8::Broadcast(tMax), tEnter);
+        return hit.Mask() & boxes.Active;
+    }
+
+    // 8 rays against one triangle
+    inline int IntersectTriangle(const RayPacket8& rays, const Vec3F& v0, const Vec3F& v1, const Vec3F& v2,
+                                 SIMD::F32x8& t, SIMD::F32x8& u, SIMD::F32x8& v) noexcept {
+        using SIMD::F32x8;
+        const auto e1 = v1-v0, e2 = v2-v0;
+        const F32x8 p[3] = {F32x8::Broadcast(v0.X), F32x8::Broadcast(v0.Y), F32x8::Broadcast(v0.Z)};
+        const F32x8 a[3] = {F32x8::Broadcast(e1.X), F32x8::Broadcast(e1.Y), F32x8::Broadcast(e1.Z)};
+        const F32x8 b[3] = {F32x8::Broadcast(e2.X), F32x8::Broadcast(e2.Y), F32x8::Broadcast(e2.Z)};
+        return SIMD::MollerTrumbore8(rays.Origin, rays.Direction, p, a, b, rays.TMin, rays.TMax, t, u, v).Mask();
+    }
+
+    // one ray against 8 triangles
+    inline int IntersectTriangles(const RayF& ray, const TrianglePacket8& tris, float tMin, float tMax,
+                                  SIMD::F32x8& t, SIMD::F32x8& u, SIMD::F32x8& v) noexcept {
+        using SIMD::F32x8;
+        const F32x8 o[3] = {F32x8::Broadcast(ray.Origin.X), F32x8::Broadcast(ray.Origin.Y), F32x8::Broadcast(ray.Origin.Z)};
+        const F32x8 d[3] = {F32x8::Broadcast(ray.Direction.X), F32x8::Broadcast(ray.Direction.Y),
+                            F32x8::Broadcast(ray.Direction.Z)};
+        return SIMD::MollerTrumbore8(o, d, tris.V0, tris.E1, tris.E2, F32x8::Broadcast(tMin), F32x8::Broadcast(tMax),
+                t, u, v).Mask();
+    }
+
+    struct RayHit {
+        uint32_t Index = ~0u;
+        float T = std::numeric_limits<float>::infinity(), U = 0.0f, V = 0.0f;
+        explicit operator bool() const noexcept { return Index!=~0u; }
+    };
+
+    // Nearest hit among triangles given as consecutive vertex triples, tested 8 at a time
+    inline RayHit Raycast(const RayF& ray, std::span<const Vec3F> triangles, float tMin = 0.0f,
+                          float tMax = std::numeric_limits<float>::infinity()) noexcept {
+        RayHit hit;
+        const auto count = triangles.size()/3;
+        for (auto i = size_t(0); i<count; i += 8) {
+            const auto packet = TrianglePacket8::Load(triangles.subspan(i*3));
+            SIMD::F32x8 t, u, v;
+            auto mask = IntersectTriangles(ray, packet, tMin, tMax, t, u, v);
+            if (!mask) continue;
+            float ts[8], us[8], vs[8];
+            t.Store(ts);
+            u.Store(us);
+            v.Store(vs);
+            for (; mask; mask &= mask-1) {
+                const auto lane = std::countr_zero(unsigned(mask));
+                if (ts[lane]<=tMax) {
+                    hit = {uint32_t(i+lane), ts[lane], us[lane], vs[lane]};
+                    tMax = ts[lane];
+                }
+            }
+        }
+        return hit;
+    }
+}
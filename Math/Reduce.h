@@ -0,0 +1,333 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "AABB.h"
+#include "AARect.h"
+#include "Parallel.h"
+#include "Transform.h"
+#include "SIMD/CPU.h"
+
+// Fused reductions over point arrays, one pass over the data:
+//   Bounds      component-wise min/max as an AABB, or an AARect for Vec2I
+//   Statistics  count, bounds, centroid and the population covariance (divided by the count)
+// Moments are accumulated in double relative to the first point, so far-from-origin clouds do not cancel.
+// Spans of more than ReduceGrain points are split into fixed chunks of ReduceGrain points, reduced on the default
+// pool and merged in chunk order; the result therefore does not depend on the thread count. The float, double and
+// int overloads pick an AVX2+FMA or scalar kernel once per process, and the two kernels can differ in the last bits
+// of the moments as they sum in a different order.
+namespace Math {
+    template <class T>
+    struct PointStats {
+        using ValueType = LengthType<T>;
+
+        size_t Count = 0;
+        AABB<T> Bounds;
+        Vec3<ValueType> Centroid;
+        Mat<ValueType, 3, 3> Covariance;
+    };
+
+    inline constexpr size_t ReduceGrain = size_t(1) << 15u;
+
+    namespace SIMD {
+        // bounds and moments of one chunk; Outer holds xx, xy, xz, yy, yz, zz
+        template <class T>
+        struct ReducePartial {
+            size_t Count = 0;
+            AABB<T> Bounds;
+            double Sum[3]{}, Outer[6]{};
+
+            void Add(const ReducePartial& r) noexcept {
+                Count += r.Count;
+                Bounds.Merge(r.Bounds);
+                for (auto i = 0; i<3; ++i) Sum[i] += r.Sum[i];
+                for (auto i = 0; i<6; ++i) Outer[i] += r.Outer[i];
+            }
+        };
+
+        // n records of three T; moments are taken relative to shift
+        template <class T>
+        using ReduceKernel = void (*)(const T* p, size_t n, const double* shift, ReducePartial<T>& acc) noexcept;
+
+        template <class T, bool Moments>
+        void ReduceScalar(const T* p, size_t n, const double* shift, ReducePartial<T>& acc) noexcept {
+            for (auto i = size_t(0); i<n; ++i, p += 3) {
+                acc.Bounds.Include(Vec3<T>(p[0], p[1], p[2]));
+                if constexpr (Moments) {
+                    const double x = double(p[0])-shift[0], y = double(p[1])-shift[1], z = double(p[2])-shift[2];
+                    acc.Sum[0] += x;
+                    acc.Sum[1] += y;
+                    acc.Sum[2] += z;
+                    acc.Outer[0] += x*x;
+                    acc.Outer[1] += x*y;
+                    acc.Outer[2] += x*z;
+                    acc.Outer[3] += y*y;
+                    acc.Outer[4] += y*z;
+                    acc.Outer[5] += z*z;
+                }
+            }
+            acc.Count += n;
+        }
+
+        inline void Bounds2Scalar(const int* p, size_t n, Vec2I& min, Vec2I& max) noexcept {
+            for (auto i = size_t(0); i<n; ++i, p += 2) {
+                min.X = std::min(min.X, p[0]);
+                min.Y = std::min(min.Y, p[1]);
+                max.X = std::max(max.X, p[0]);
+                max.Y = std::max(max.Y, p[1]);
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        // 4 interleaved xyz triples of double -> x, y, z lanes
+        MATH_TARGET("avx2,fma")
+        inline void Deinterleave3(const double* p, __m256d& x, __m256d& y, __m256d& z) noexcept {
+            const auto a = _mm256_loadu_pd(p), b = _mm256_loadu_pd(p+4), c = _mm256_loadu_pd(p+8);
+            x = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b0100), c, 0b0010), _MM_SHUFFLE(1, 2, 3, 0));
+            y = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b1001), c, 0b0100), _MM_SHUFFLE(2, 3, 0, 1));
+            z = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 0b0010), c, 0b1001), _MM_SHUFFLE(3, 0, 1, 2));
+        }
+
+        // sums x, y, z into m[0..2] and the upper triangle of their outer product into m[3..8]
+        MATH_TARGET("avx2,fma")
+        inline void AccumulateMoments(__m256d x, __m256d y, __m256d z, __m256d* m) noexcept {
+            m[0] = _mm256_add_pd(m[0], x);
+            m[1] = _mm256_add_pd(m[1], y);
+            m[2] = _mm256_add_pd(m[2], z);
+            m[3] = _mm256_fmadd_pd(x, x, m[3]);
+            m[4] = _mm256_fmadd_pd(x, y, m[4]);
+            m[5] = _mm256_fmadd_pd(x, z, m[5]);
+            m[6] = _mm256_fmadd_pd(y, y, m[6]);
+            m[7] = _mm256_fmadd_pd(y, z, m[7]);
+            m[8] = _mm256_fmadd_pd(z, z, m[8]);
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline double HorizontalSum(__m256d v) noexcept {
+            alignas(32) double l[4];
+            _mm256_store_pd(l, v);
+            return (l[0]+l[1])+(l[2]+l[3]);
+        }
+
+        template <class T>
+        struct ReduceRegister { using Type = __m256; };
+        template <>
+        struct ReduceRegister<double> { using Type = __m256d; };
+
+        // float and int records go eight at a time through the float shuffles, doubles four at a time; min and max
+        // stay in the input type and the moments are widened to double
+        template <class T, bool Moments>
+        MATH_TARGET("avx2,fma")
+        void ReduceAVX2(const T* p, size_t n, const double* shift, ReducePartial<T>& acc) noexcept {
+            constexpr auto width = std::is_same_v<T, double> ? 4u : 8u;
+            using Reg = typename ReduceRegister<T>::Type;
+            auto i = size_t(0);
+            if (n>=width) {
+                Reg mn[3], mx[3];
+                for (auto a = 0; a<3; ++a) {
+                    if constexpr (std::is_same_v<T, double>) {
+                        mn[a] = _mm256_set1_pd(std::numeric_limits<double>::max());
+                        mx[a] = _mm256_set1_pd(std::numeric_limits<double>::lowest());
+                    }
+                    else if constexpr (std::is_same_v<T, float>) {
+                        mn[a] = _mm256_set1_ps(std::numeric_limits<float>::max());
+                        mx[a] = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+                    }
+                    else {
+                        mn[a] = _mm256_castsi256_ps(_mm256_set1_epi32(std::numeric_limits<int>::max()));
+                        mx[a] = _mm256_castsi256_ps(_mm256_set1_epi32(std::numeric_limits<int>::lowest()));
+                    }
+                }
+                __m256d m[9];
+                const __m256d s[3] = {_mm256_set1_pd(shift[0]), _mm256_set1_pd(shift[1]), _mm256_set1_pd(shift[2])};
+                for (auto& r : m) r = _mm256_setzero_pd();
+                for (; i+width<=n; i += width, p += width*3) {
+                    Reg v[3];
+                    if constexpr (std::is_same_v<T, double>) Deinterleave3(p, v[0], v[1], v[2]);
+                    else Deinterleave3(reinterpret_cast<const float*>(p), v[0], v[1], v[2]);
+                    for (auto a = 0; a<3; ++a) {
+                        if constexpr (std::is_same_v<T, double>) {
+                            mn[a] = _mm256_min_pd(mn[a], v[a]);
+                            mx[a] = _mm256_max_pd(mx[a], v[a]);
+                        }
+                        else if constexpr (std::is_same_v<T, float>) {
+                            mn[a] = _mm256_min_ps(mn[a], v[a]);
+                            mx[a] = _mm256_max_ps(mx[a], v[a]);
+                        }
+                        else {
+                            mn[a] = _mm256_castsi256_ps(_mm256_min_epi32(_mm256_castps_si256(mn[a]), _mm256_castps_si256(v[a])));
+                            mx[a] = _mm256_castsi256_ps(_mm256_max_epi32(_mm256_castps_si256(mx[a]), _mm256_castps_si256(v[a])));
+                        }
+                    }
+                    if constexpr (Moments) {
+                        if constexpr (std::is_same_v<T, double>)
+                            AccumulateMoments(_mm256_sub_pd(v[0], s[0]), _mm256_sub_pd(v[1], s[1]), _mm256_sub_pd(v[2], s[2]), m);
+                        else {
+                            __m256d lo[3], hi[3];
+                            for (auto a = 0; a<3; ++a) {
+                                if constexpr (std::is_same_v<T, float>) {
+                                    lo[a] = _mm256_cvtps_pd(_mm256_castps256_ps128(v[a]));
+                                    hi[a] = _mm256_cvtps_pd(_mm256_extractf128_ps(v[a], 1));
+                                }
+                                else {
+                                    lo[a] = _mm256_cvtepi32_pd(_mm_castps_si128(_mm256_castps256_ps128(v[a])));
+                                    hi[a] = _mm256_cvtepi32_pd(_mm_castps_si128(_mm256_extractf128_ps(v[a], 1)));
+                                }
+                                lo[a] = _mm256_sub_pd(lo[a], s[a]);
+                                hi[a] = _mm256_sub_pd(hi[a], s[a]);
+                            }
+                            AccumulateMoments(lo[0], lo[1], lo[2], m);
+                            AccumulateMoments(hi[0], hi[1], hi[2], m);
+                        }
+                    }
+                }
+                alignas(32) T lmn[3][width], lmx[3][width];
+                for (auto a = 0; a<3; ++a) {
+                    if constexpr (std::is_same_v<T, double>) {
+                        _mm256_store_pd(lmn[a], mn[a]);
+                        _mm256_store_pd(lmx[a], mx[a]);
+                    }
+                    else {
+                        _mm256_store_ps(reinterpret_cast<float*>(lmn[a]), mn[a]);
+                        _mm256_store_ps(reinterpret_cast<float*>(lmx[a]), mx[a]);
+                    }
+                }
+                for (auto l = 0u; l<width; ++l) {
+                    acc.Bounds.Include(Vec3<T>(lmn[0][l], lmn[1][l], lmn[2][l]));
+                    acc.Bounds.Include(Vec3<T>(lmx[0][l], lmx[1][l], lmx[2][l]));
+                }
+                if constexpr (Moments) {
+                    for (auto a = 0; a<3; ++a) acc.Sum[a] += HorizontalSum(m[a]);
+                    for (auto a = 0; a<6; ++a) acc.Outer[a] += HorizontalSum(m[3+a]);
+                }
+                acc.Count += i;
+            }
+            ReduceScalar<T, Moments>(p, n-i, shift, acc);
+        }
+
+        // four points per register, x in the even lanes and y in the odd ones
+        MATH_TARGET("avx2,fma")
+        inline void Bounds2AVX2(const int* p, size_t n, Vec2I& min, Vec2I& max) noexcept {
+            auto i = size_t(0);
+            if (n>=4) {
+                auto mn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), mx = mn;
+                for (i = 4, p += 8; i+4<=n; i += 4, p += 8) {
+                    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                    mn = _mm256_min_epi32(mn, v);
+                    mx = _mm256_max_epi32(mx, v);
+                }
+                alignas(32) int lmn[8], lmx[8];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lmn), mn);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lmx), mx);
+                for (auto l = 0; l<8; l += 2) {
+                    min.X = std::min(min.X, lmn[l]);
+                    min.Y = std::min(min.Y, lmn[l+1]);
+                    max.X = std::max(max.X, lmx[l]);
+                    max.Y = std::max(max.Y, lmx[l+1]);
+                }
+            }
+            Bounds2Scalar(p, n-i, min, max);
+        }
+#endif
+
+        template <class T, bool Moments>
+        ReduceKernel<T> SelectReduce() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX2 && cpu.FMA) return &ReduceAVX2<T, Moments>;
+#endif
+            return &ReduceScalar<T, Moments>;
+        }
+
+        inline auto SelectBounds2() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX2 && cpu.FMA) return &Bounds2AVX2;
+#endif
+            return &Bounds2Scalar;
+        }
+
+        // Calls fn(begin, end, acc) on chunks of ReduceGrain elements of [0, n) and folds the per-chunk accumulators
+        // left to right, so the result is the same however the chunks were scheduled
+        template <class A, class F>
+        A ReduceChunks(size_t n, F&& fn) {
+            const auto chunks = (n+ReduceGrain-1)/ReduceGrain;
+            if (chunks<2) {
+                A acc;
+                fn(size_t(0), n, acc);
+                return acc;
+            }
+            std::vector<A> partial(chunks);
+            Parallel::DefaultPool().For(chunks, [&](size_t c) {
+                fn(c*ReduceGrain, std::min(n, (c+1)*ReduceGrain), partial[c]);
+            });
+            for (auto c = size_t(1); c<chunks; ++c) partial[0].Add(partial[c]);
+            return partial[0];
+        }
+
+        template <class T, bool Moments>
+        ReducePartial<T> Reduce(std::span<const Vec3<T>> points) {
+            static const auto kernel = SelectReduce<T, Moments>();
+            const auto p = reinterpret_cast<const T*>(points.data());
+            double shift[3]{};
+            if (Moments && !points.empty()) for (auto a = 0; a<3; ++a) shift[a] = double(p[a]);
+            return ReduceChunks<ReducePartial<T>>(points.size(), [&](size_t b, size_t e, ReducePartial<T>& acc) {
+                kernel(p+b*3, e-b, shift, acc);
+            });
+        }
+    }
+
+    template <class T>
+    AABB<T> Bounds(std::span<const Vec3<T>> points) {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int>);
+        return SIMD::Reduce<T, false>(points).Bounds;
+    }
+    inline AABBF Bounds(std::span<const Vec3F> points) { return Bounds<float>(points); }
+    inline AABBD Bounds(std::span<const Vec3D> points) { return Bounds<double>(points); }
+    inline AABBI Bounds(std::span<const Vec3I> points) { return Bounds<int>(points); }
+
+    // Left and Top are the minimum and Width and Height the extent, matching AARect::Include; an empty span gives
+    // an empty rectangle at the origin
+    inline AARect Bounds(std::span<const Vec2I> points) {
+        struct Acc {
+            Vec2I Min{std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+            Vec2I Max{std::numeric_limits<int>::lowest(), std::numeric_limits<int>::lowest()};
+
+            void Add(const Acc& r) noexcept {
+                SIMD::Bounds2Scalar(r.Min.Data, 1, Min, Max);
+                SIMD::Bounds2Scalar(r.Max.Data, 1, Min, Max);
+            }
+        };
+        if (points.empty()) return AARect(0, 0);
+        static const auto kernel = SIMD::SelectBounds2();
+        const auto p = reinterpret_cast<const int*>(points.data());
+        const auto acc = SIMD::ReduceChunks<Acc>(points.size(), [&](size_t b, size_t e, Acc& a) {
+            kernel(p+b*2, e-b, a.Min, a.Max);
+        });
+        return AARect(acc.Min, acc.Max-acc.Min);
+    }
+
+    template <class T>
+    PointStats<T> Statistics(std::span<const Vec3<T>> points) {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int>);
+        using V = LengthType<T>;
+        const auto acc = SIMD::Reduce<T, true>(points);
+        PointStats<T> ret;
+        ret.Count = acc.Count;
+        ret.Bounds = acc.Bounds;
+        if (!acc.Count) return ret;
+        const auto inv = 1.0/double(acc.Count);
+        const double mean[3] = {acc.Sum[0]*inv, acc.Sum[1]*inv, acc.Sum[2]*inv};
+        const auto p = reinterpret_cast<const T*>(points.data());
+        ret.Centroid = Vec3<V>(V(p[0]+mean[0]), V(p[1]+mean[1]), V(p[2]+mean[2]));
+        constexpr int index[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+        for (auto r = 0; r<3; ++r)
+            for (auto c = 0; c<3; ++c) ret.Covariance(r, c) = V(acc.Outer[index[r][c]]*inv-mean[r]*mean[c]);
+        return ret;
+    }
+    inline PointStats<float> Statistics(std::span<const Vec3F> points) { return Statistics<float>(points); }
+    inline PointStats<double> Statistics(std::span<const Vec3D> points) { return Statistics<double>(points); }
+    inline PointStats<int> Statistics(std::span<const Vec3I> points) { return Statistics<int>(points); }
+}
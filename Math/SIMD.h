@@ -0,0 +1,6 @@
+#pragma once
+
+#include "SIMD/Config.h"
+#include "SIMD/F32x8.h"
+#include "SIMD/I32x8.h"
+#include "SIMD/CPU.h"
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Config.h"
+
+#if defined(MATH_SIMD_SSE2)
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
+namespace Math::SIMD {
+    // Instruction sets usable at runtime; AVX-class entries also require OS support for the register state
+    struct CPUFeatures {
+        bool SSE41 = false;
+        bool AVX2 = false;
+        bool FMA = false;
+        bool BMI2 = false;
+        bool F16C = false;
+        bool AVX512F = false;
+    };
+
+    inline CPUFeatures DetectCPU() noexcept {
+        CPUFeatures ret{};
+#if defined(MATH_SIMD_SSE2)
+        unsigned int r1[4]{}, r7[4]{};
+#   if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, 0, 0);
+        const auto max = static_cast<unsigned int>(info[0]);
+        __cpuidex(info, 1, 0);
+        for (auto i = 0; i<4; ++i) r1[i] = static_cast<unsigned int>(info[i]);
+        if (max>=7) {
+            __cpuidex(info, 7, 0);
+            for (auto i = 0; i<4; ++i) r7[i] = static_cast<unsigned int>(info[i]);
+        }
+#   else
+        const auto max = __get_cpuid_max(0, nullptr);
+        __get_cpuid(1, &r1[0], &r1[1], &r1[2], &r1[3]);
+        if (max>=7) __cpuid_count(7, 0, r7[0], r7[1], r7[2], r7[3]);
+#   endif
+        const auto bit = [](unsigned int reg, int b) noexcept { return ((reg >> b) & 1u)!=0; };
+        unsigned long long xcr0 = 0;
+        if (bit(r1[2], 27)) { // OSXSAVE
+#   if defined(_MSC_VER)
+            xcr0 = _xgetbv(0);
+#   else
+            unsigned int lo, hi;
+            __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            xcr0 = (static_cast<unsigned long long>(hi) << 32u) | lo;
+#   endif
+        }
+        const auto ymm = (xcr0 & 0x6u)==0x6u, zmm = (xcr0 & 0xE6u)==0xE6u;
+        ret.SSE41 = bit(r1[2], 19);
+        ret.FMA = ymm && bit(r1[2], 12);
+        ret.F16C = ymm && bit(r1[2], 29);
+        ret.AVX2 = ymm && bit(r7[1], 5);
+        ret.BMI2 = bit(r7[1], 8);
+        ret.AVX512F = zmm && bit(r7[1], 16);
+#endif
+        return ret;
+    }
+
+    inline const CPUFeatures& CPU() noexcept {
+        static const auto features = DetectCPU();
+        return features;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <type_traits>
+
+// Compile-time ISA selection. Define MATH_NO_SIMD to force the scalar paths.
+#if !defined(MATH_NO_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define MATH_SIMD_SSE2 1
+#   endif
+#   if defined(MATH_SIMD_SSE2) && (defined(__SSE4_1__) || defined(__AVX__))
+#       define MATH_SIMD_SSE41 1
+#   endif
+#   if defined(MATH_SIMD_SSE41) && defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#       define MATH_SIMD_AVX2 1
+#       define MATH_SIMD_FMA 1
+#   endif
+#   if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#       define MATH_SIMD_BMI2 1
+#   endif
+#endif
+
+// Per-function ISA override for kernels selected at runtime (see CPU.h)
+#if defined(_MSC_VER) && !defined(__clang__)
+#   define MATH_TARGET(isa)
+#else
+#   define MATH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+#   define MATH_SIMD_LEVEL 3
+#elif defined(MATH_SIMD_SSE41)
+#   define MATH_SIMD_LEVEL 2
+#elif defined(MATH_SIMD_SSE2)
+#   define MATH_SIMD_LEVEL 1
+#else
+#   define MATH_SIMD_LEVEL 0
+#endif
+
+#if MATH_SIMD_LEVEL > 0
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <immintrin.h>
+#   endif
+#endif
+
+#if defined(__cpp_lib_is_constant_evaluated)
+#   define MATH_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#   define MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "Config.h"
+
+namespace Math::SIMD {
+    // Eight float lanes: one ymm register on AVX2, two xmm registers on SSE, a plain array otherwise.
+    // Comparisons return all-ones/all-zeros lane masks usable with Select and the bitwise operators.
+    struct F32x8 {
+        static constexpr int Width = 8;
+#if defined(MATH_SIMD_AVX2)
+        __m256 V;
+
+        static F32x8 Load(const float* p) noexcept { return {_mm256_loadu_ps(p)}; }
+        static F32x8 Broadcast(float v) noexcept { return {_mm256_set1_ps(v)}; }
+        static F32x8 Zero() noexcept { return {_mm256_setzero_ps()}; }
+        void Store(float* p) const noexcept { _mm256_storeu_ps(p, V); }
+        // eight consecutive 4-float records <-> one register per field
+        static void Load4(const float* p, F32x8& a, F32x8& b, F32x8& c, F32x8& d) noexcept {
+            const auto r0 = _mm256_loadu_ps(p), r1 = _mm256_loadu_ps(p+8);
+            const auto r2 = _mm256_loadu_ps(p+16), r3 = _mm256_loadu_ps(p+24);
+            const auto q04 = _mm256_permute2f128_ps(r0, r2, 0x20), q15 = _mm256_permute2f128_ps(r0, r2, 0x31);
+            const auto q26 = _mm256_permute2f128_ps(r1, r3, 0x20), q37 = _mm256_permute2f128_ps(r1, r3, 0x31);
+            const auto t0 = _mm256_unpacklo_ps(q04, q15), t1 = _mm256_unpackhi_ps(q04, q15);
+            const auto t2 = _mm256_unpacklo_ps(q26, q37), t3 = _mm256_unpackhi_ps(q26, q37);
+            a.V = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            b.V = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            c.V = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            d.V = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        static void Store4(float* p, F32x8 a, F32x8 b, F32x8 c, F32x8 d) noexcept {
+            const auto t0 = _mm256_unpacklo_ps(a.V, b.V), t1 = _mm256_unpackhi_ps(a.V, b.V);
+            const auto t2 = _mm256_unpacklo_ps(c.V, d.V), t3 = _mm256_unpackhi_ps(c.V, d.V);
+            const auto q04 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const auto q15 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const auto q26 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const auto q37 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            _mm256_storeu_ps(p, _mm256_permute2f128_ps(q04, q15, 0x20));
+            _mm256_storeu_ps(p+8, _mm256_permute2f128_ps(q26, q37, 0x20));
+            _mm256_storeu_ps(p+16, _mm256_permute2f128_ps(q04, q15, 0x31));
+            _mm256_storeu_ps(p+24, _mm256_permute2f128_ps(q26, q37, 0x31));
+        }
+        int Mask() const noexcept { return _mm256_movemask_ps(V); }
+
+        F32x8 operator-() const noexcept { return {_mm256_xor_ps(V, _mm256_set1_ps(-0.0f))}; }
+        F32x8 operator+(F32x8 r) const noexcept { return {_mm256_add_ps(V, r.V)}; }
+        F32x8 operator-(F32x8 r) const noexcept { return {_mm256_sub_ps(V, r.V)}; }
+        F32x8 operator*(F32x8 r) const noexcept { return {_mm256_mul_ps(V, r.V)}; }
+        F32x8 operator/(F32x8 r) const noexcept { return {_mm256_div_ps(V, r.V)}; }
+        F32x8 operator&(F32x8 r) const noexcept { return {_mm256_and_ps(V, r.V)}; }
+        F32x8 operator|(F32x8 r) const noexcept { return {_mm256_or_ps(V, r.V)}; }
+        F32x8 operator^(F32x8 r) const noexcept { return {_mm256_xor_ps(V, r.V)}; }
+        F32x8 operator<(F32x8 r) const noexcept { return {_mm256_cmp_ps(V, r.V, _CMP_LT_OQ)}; }
+        F32x8 operator<=(F32x8 r) const noexcept { return {_mm256_cmp_ps(V, r.V, _CMP_LE_OQ)}; }
+        F32x8 operator>(F32x8 r) const noexcept { return {_mm256_cmp_ps(V, r.V, _CMP_GT_OQ)}; }
+        F32x8 operator>=(F32x8 r) const noexcept { return {_mm256_cmp_ps(V, r.V, _CMP_GE_OQ)}; }
+        F32x8 operator==(F32x8 r) const noexcept { return {_mm256_cmp_ps(V, r.V, _CMP_EQ_OQ)}; }
+
+        friend F32x8 MulAdd(F32x8 a, F32x8 b, F32x8 c) noexcept { return {_mm256_fmadd_ps(a.V, b.V, c.V)}; }
+        friend F32x8 Min(F32x8 a, F32x8 b) noexcept { return {_mm256_min_ps(a.V, b.V)}; }
+        friend F32x8 Max(F32x8 a, F32x8 b) noexcept { return {_mm256_max_ps(a.V, b.V)}; }
+        friend F32x8 Sqrt(F32x8 a) noexcept { return {_mm256_sqrt_ps(a.V)}; }
+        friend F32x8 Floor(F32x8 a) noexcept { return {_mm256_floor_ps(a.V)}; }
+        friend F32x8 AndNot(F32x8 mask, F32x8 a) noexcept { return {_mm256_andnot_ps(mask.V, a.V)}; }
+        friend F32x8 Select(F32x8 mask, F32x8 a, F32x8 b) noexcept { return {_mm256_blendv_ps(b.V, a.V, mask.V)}; }
+#elif defined(MATH_SIMD_SSE2)
+        __m128 L, H;
+
+        static F32x8 Load(const float* p) noexcept { return {_mm_loadu_ps(p), _mm_loadu_ps(p+4)}; }
+        static F32x8 Broadcast(float v) noexcept { return {_mm_set1_ps(v), _mm_set1_ps(v)}; }
+        static F32x8 Zero() noexcept { return {_mm_setzero_ps(), _mm_setzero_ps()}; }
+        void Store(float* p) const noexcept {
+            _mm_storeu_ps(p, L);
+            _mm_storeu_ps(p+4, H);
+        }
+        int Mask() const noexcept { return _mm_movemask_ps(L) | (_mm_movemask_ps(H) << 4); }
+        static void Load4(const float* p, F32x8& a, F32x8& b, F32x8& c, F32x8& d) noexcept {
+            a.L = _mm_loadu_ps(p), b.L = _mm_loadu_ps(p+4), c.L = _mm_loadu_ps(p+8), d.L = _mm_loadu_ps(p+12);
+            a.H = _mm_loadu_ps(p+16), b.H = _mm_loadu_ps(p+20), c.H = _mm_loadu_ps(p+24), d.H = _mm_loadu_ps(p+28);
+            _MM_TRANSPOSE4_PS(a.L, b.L, c.L, d.L);
+            _MM_TRANSPOSE4_PS(a.H, b.H, c.H, d.H);
+        }
+        static void Store4(float* p, F32x8 a, F32x8 b, F32x8 c, F32x8 d) noexcept {
+            _MM_TRANSPOSE4_PS(a.L, b.L, c.L, d.L);
+            _MM_TRANSPOSE4_PS(a.H, b.H, c.H, d.H);
+            _mm_storeu_ps(p, a.L), _mm_storeu_ps(p+4, b.L), _mm_storeu_ps(p+8, c.L), _mm_storeu_ps(p+12, d.L);
+            _mm_storeu_ps(p+16, a.H), _mm_storeu_ps(p+20, b.H), _mm_storeu_ps(p+24, c.H), _mm_storeu_ps(p+28, d.H);
+        }
+
+        F32x8 operator-() const noexcept { return *this ^ Broadcast(-0.0f); }
+        F32x8 operator+(F32x8 r) const noexcept { return {_mm_add_ps(L, r.L), _mm_add_ps(H, r.H)}; }
+        F32x8 operator-(F32x8 r) const noexcept { return {_mm_sub_ps(L, r.L), _mm_sub_ps(H, r.H)}; }
+        F32x8 operator*(F32x8 r) const noexcept { return {_mm_mul_ps(L, r.L), _mm_mul_ps(H, r.H)}; }
+        F32x8 operator/(F32x8 r) const noexcept { return {_mm_div_ps(L, r.L), _mm_div_ps(H, r.H)}; }
+        F32x8 operator&(F32x8 r) const noexcept { return {_mm_and_ps(L, r.L), _mm_and_ps(H, r.H)}; }
+        F32x8 operator|(F32x8 r) const noexcept { return {_mm_or_ps(L, r.L), _mm_or_ps(H, r.H)}; }
+        F32x8 operator^(F32x8 r) const noexcept { return {_mm_xor_ps(L, r.L), _mm_xor_ps(H, r.H)}; }
+        F32x8 operator<(F32x8 r) const noexcept { return {_mm_cmplt_ps(L, r.L), _mm_cmplt_ps(H, r.H)}; }
+        F32x8 operator<=(F32x8 r) const noexcept { return {_mm_cmple_ps(L, r.L), _mm_cmple_ps(H, r.H)}; }
+        F32x8 operator>(F32x8 r) const noexcept { return {_mm_cmpgt_ps(L, r.L), _mm_cmpgt_ps(H, r.H)}; }
+        F32x8 operator>=(F32x8 r) const noexcept { return {_mm_cmpge_ps(L, r.L), _mm_cmpge_ps(H, r.H)}; }
+        F32x8 operator==(F32x8 r) const noexcept { return {_mm_cmpeq_ps(L, r.L), _mm_cmpeq_ps(H, r.H)}; }
+
+        friend F32x8 MulAdd(F32x8 a, F32x8 b, F32x8 c) noexcept { return a*b+c; }
+        friend F32x8 Min(F32x8 a, F32x8 b) noexcept { return {_mm_min_ps(a.L, b.L), _mm_min_ps(a.H, b.H)}; }
+        friend F32x8 Max(F32x8 a, F32x8 b) noexcept { return {_mm_max_ps(a.L, b.L), _mm_max_ps(a.H, b.H)}; }
+        friend F32x8 Sqrt(F32x8 a) noexcept { return {_mm_sqrt_ps(a.L), _mm_sqrt_ps(a.H)}; }
+        friend F32x8 AndNot(F32x8 mask, F32x8 a) noexcept {
+            return {_mm_andnot_ps(mask.L, a.L), _mm_andnot_ps(mask.H, a.H)};
+        }
+        friend F32x8 Select(F32x8 mask, F32x8 a, F32x8 b) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_blendv_ps(b.L, a.L, mask.L), _mm_blendv_ps(b.H, a.H, mask.H)};
+#else
+            return (mask & a) | AndNot(mask, b);
+#endif
+        }
+        friend F32x8 Floor(F32x8 a) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_floor_ps(a.L), _mm_floor_ps(a.H)};
+#else
+            // only exact for |a| < 2^31, which covers every use in this library
+            const F32x8 t{_mm_cvtepi32_ps(_mm_cvttps_epi32(a.L)), _mm_cvtepi32_ps(_mm_cvttps_epi32(a.H))};
+            return t - (Broadcast(1.0f) & (a < t));
+#endif
+        }
+#else
+        float V[8];
+
+        static F32x8 Load(const float* p) noexcept {
+            F32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = p[i];
+            return ret;
+        }
+        static F32x8 Broadcast(float v) noexcept { return {{v, v, v, v, v, v, v, v}}; }
+        static F32x8 Zero() noexcept { return Broadcast(0.0f); }
+        void Store(float* p) const noexcept { for (auto i = 0; i<8; ++i) p[i] = V[i]; }
+        static void Load4(const float* p, F32x8& a, F32x8& b, F32x8& c, F32x8& d) noexcept {
+            for (auto i = 0; i<8; ++i) a.V[i] = p[i*4], b.V[i] = p[i*4+1], c.V[i] = p[i*4+2], d.V[i] = p[i*4+3];
+        }
+        static void Store4(float* p, F32x8 a, F32x8 b, F32x8 c, F32x8 d) noexcept {
+            for (auto i = 0; i<8; ++i) p[i*4] = a.V[i], p[i*4+1] = b.V[i], p[i*4+2] = c.V[i], p[i*4+3] = d.V[i];
+        }
+        int Mask() const noexcept {
+            auto ret = 0;
+            for (auto i = 0; i<8; ++i) ret |= int(Bits(V[i]) >> 31u) << i;
+            return ret;
+        }
+
+        F32x8 operator-() const noexcept { return Map([](float a) noexcept { return -a; }); }
+        F32x8 operator+(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return a+b; }); }
+        F32x8 operator-(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return a-b; }); }
+        F32x8 operator*(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return a*b; }); }
+        F32x8 operator/(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return a/b; }); }
+        F32x8 operator&(F32x8 r) const noexcept {
+            return Zip(r, [](float a, float b) noexcept { return Float(Bits(a) & Bits(b)); });
+        }
+        F32x8 operator|(F32x8 r) const noexcept {
+            return Zip(r, [](float a, float b) noexcept { return Float(Bits(a) | Bits(b)); });
+        }
+        F32x8 operator^(F32x8 r) const noexcept {
+            return Zip(r, [](float a, float b) noexcept { return Float(Bits(a) ^ Bits(b)); });
+        }
+        F32x8 operator<(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return Bool(a<b); }); }
+        F32x8 operator<=(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return Bool(a<=b); }); }
+        F32x8 operator>(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return Bool(a>b); }); }
+        F32x8 operator>=(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return Bool(a>=b); }); }
+        F32x8 operator==(F32x8 r) const noexcept { return Zip(r, [](float a, float b) noexcept { return Bool(a==b); }); }
+
+        friend F32x8 MulAdd(F32x8 a, F32x8 b, F32x8 c) noexcept { return a*b+c; }
+        friend F32x8 Min(F32x8 a, F32x8 b) noexcept { return a.Zip(b, [](float x, float y) noexcept { return y<x ? y : x; }); }
+        friend F32x8 Max(F32x8 a, F32x8 b) noexcept { return a.Zip(b, [](float x, float y) noexcept { return x<y ? y : x; }); }
+        friend F32x8 Sqrt(F32x8 a) noexcept { return a.Map([](float x) noexcept { return std::sqrt(x); }); }
+        friend F32x8 Floor(F32x8 a) noexcept { return a.Map([](float x) noexcept { return std::floor(x); }); }
+        friend F32x8 AndNot(F32x8 mask, F32x8 a) noexcept {
+            return mask.Zip(a, [](float m, float x) noexcept { return Float(~Bits(m) & Bits(x)); });
+        }
+        friend F32x8 Select(F32x8 mask, F32x8 a, F32x8 b) noexcept { return (mask & a) | AndNot(mask, b); }
+    private:
+        static uint32_t Bits(float v) noexcept {
+            uint32_t ret;
+            std::memcpy(&ret, &v, 4);
+            return ret;
+        }
+        static float Float(uint32_t v) noexcept {
+            float ret;
+            std::memcpy(&ret, &v, 4);
+            return ret;
+        }
+        static float Bool(bool v) noexcept { return Float(v ? ~0u : 0u); }
+        template <class F>
+        F32x8 Map(F f) const noexcept {
+            F32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = f(V[i]);
+            return ret;
+        }
+        template <class F>
+        F32x8 Zip(F32x8 r, F f) const noexcept {
+            F32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = f(V[i], r.V[i]);
+            return ret;
+        }
+    public:
+#endif
+        friend F32x8 Abs(F32x8 a) noexcept { return AndNot(Broadcast(-0.0f), a); }
+        F32x8& operator+=(F32x8 r) noexcept { return *this = *this+r; }
+        F32x8& operator-=(F32x8 r) noexcept { return *this = *this-r; }
+        F32x8& operator*=(F32x8 r) noexcept { return *this = *this*r; }
+    };
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "Config.h"
+#include "F32x8.h"
+
+namespace Math::SIMD {
+    // Eight int32 lanes: one ymm register on AVX2, two xmm registers on SSE, a plain array otherwise.
+    // Comparisons return all-ones/all-zeros lane masks usable with Select and the bitwise operators.
+    // >> is an arithmetic shift, so it floors signed lanes; ShiftRightLogical shifts in zeros.
+    // Truncate converts towards zero and is only defined for lanes in the int32 range.
+    struct I32x8 {
+        static constexpr int Width = 8;
+#if defined(MATH_SIMD_AVX2)
+        __m256i V;
+
+        static I32x8 Load(const int32_t* p) noexcept { return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))}; }
+        static I32x8 Broadcast(int32_t v) noexcept { return {_mm256_set1_epi32(v)}; }
+        static I32x8 Zero() noexcept { return {_mm256_setzero_si256()}; }
+        void Store(int32_t* p) const noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), V); }
+        // eight consecutive 3-int records <-> one register per field
+        static void Load3(const int32_t* p, I32x8& a, I32x8& b, I32x8& c) noexcept {
+            const auto f = reinterpret_cast<const float*>(p);
+            const auto m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f)), _mm_loadu_ps(f+12), 1);
+            const auto m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f+4)), _mm_loadu_ps(f+16), 1);
+            const auto m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f+8)), _mm_loadu_ps(f+20), 1);
+            const auto xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+            const auto yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+            a.V = _mm256_castps_si256(_mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0)));
+            b.V = _mm256_castps_si256(_mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+            c.V = _mm256_castps_si256(_mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1)));
+        }
+        static void Store3(int32_t* p, I32x8 a, I32x8 b, I32x8 c) noexcept {
+            const auto x = _mm256_castsi256_ps(a.V), y = _mm256_castsi256_ps(b.V), z = _mm256_castsi256_ps(c.V);
+            const auto rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+            const auto r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+            const auto r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto f = reinterpret_cast<float*>(p);
+            _mm_storeu_ps(f, _mm256_castps256_ps128(r03));
+            _mm_storeu_ps(f+4, _mm256_castps256_ps128(r14));
+            _mm_storeu_ps(f+8, _mm256_castps256_ps128(r25));
+            _mm_storeu_ps(f+12, _mm256_extractf128_ps(r03, 1));
+            _mm_storeu_ps(f+16, _mm256_extractf128_ps(r14, 1));
+            _mm_storeu_ps(f+20, _mm256_extractf128_ps(r25, 1));
+        }
+        int Mask() const noexcept { return _mm256_movemask_ps(_mm256_castsi256_ps(V)); }
+        static I32x8 Truncate(F32x8 v) noexcept { return {_mm256_cvttps_epi32(v.V)}; }
+        static I32x8 FromBits(F32x8 v) noexcept { return {_mm256_castps_si256(v.V)}; }
+        F32x8 ToFloat() const noexcept { return {_mm256_cvtepi32_ps(V)}; }
+        F32x8 AsFloat() const noexcept { return {_mm256_castsi256_ps(V)}; }
+
+        I32x8 operator-() const noexcept { return {_mm256_sub_epi32(_mm256_setzero_si256(), V)}; }
+        I32x8 operator+(I32x8 r) const noexcept { return {_mm256_add_epi32(V, r.V)}; }
+        I32x8 operator-(I32x8 r) const noexcept { return {_mm256_sub_epi32(V, r.V)}; }
+        I32x8 operator*(I32x8 r) const noexcept { return {_mm256_mullo_epi32(V, r.V)}; }
+        I32x8 operator&(I32x8 r) const noexcept { return {_mm256_and_si256(V, r.V)}; }
+        I32x8 operator|(I32x8 r) const noexcept { return {_mm256_or_si256(V, r.V)}; }
+        I32x8 operator^(I32x8 r) const noexcept { return {_mm256_xor_si256(V, r.V)}; }
+        I32x8 operator<<(int s) const noexcept { return {_mm256_sll_epi32(V, _mm_cvtsi32_si128(s))}; }
+        I32x8 operator>>(int s) const noexcept { return {_mm256_sra_epi32(V, _mm_cvtsi32_si128(s))}; }
+        I32x8 operator<<(I32x8 s) const noexcept { return {_mm256_sllv_epi32(V, s.V)}; }
+        I32x8 operator>>(I32x8 s) const noexcept { return {_mm256_srav_epi32(V, s.V)}; }
+        I32x8 ShiftRightLogical(int s) const noexcept { return {_mm256_srl_epi32(V, _mm_cvtsi32_si128(s))}; }
+        I32x8 operator<(I32x8 r) const noexcept { return {_mm256_cmpgt_epi32(r.V, V)}; }
+        I32x8 operator>(I32x8 r) const noexcept { return {_mm256_cmpgt_epi32(V, r.V)}; }
+        I32x8 operator==(I32x8 r) const noexcept { return {_mm256_cmpeq_epi32(V, r.V)}; }
+
+        friend I32x8 Min(I32x8 a, I32x8 b) noexcept { return {_mm256_min_epi32(a.V, b.V)}; }
+        friend I32x8 Max(I32x8 a, I32x8 b) noexcept { return {_mm256_max_epi32(a.V, b.V)}; }
+        friend I32x8 Abs(I32x8 a) noexcept { return {_mm256_abs_epi32(a.V)}; }
+        friend I32x8 AndNot(I32x8 mask, I32x8 a) noexcept { return {_mm256_andnot_si256(mask.V, a.V)}; }
+        friend I32x8 Select(I32x8 mask, I32x8 a, I32x8 b) noexcept { return {_mm256_blendv_epi8(b.V, a.V, mask.V)}; }
+#elif defined(MATH_SIMD_SSE2)
+        __m128i L, H;
+
+        static I32x8 Load(const int32_t* p) noexcept {
+            return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+4))};
+        }
+        static I32x8 Broadcast(int32_t v) noexcept { return {_mm_set1_epi32(v), _mm_set1_epi32(v)}; }
+        static I32x8 Zero() noexcept { return {_mm_setzero_si128(), _mm_setzero_si128()}; }
+        void Store(int32_t* p) const noexcept {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), L);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p+4), H);
+        }
+        static void Load3(const int32_t* p, I32x8& a, I32x8& b, I32x8& c) noexcept {
+            Deinterleave3(p, a.L, b.L, c.L);
+            Deinterleave3(p+12, a.H, b.H, c.H);
+        }
+        static void Store3(int32_t* p, I32x8 a, I32x8 b, I32x8 c) noexcept {
+            Interleave3(p, a.L, b.L, c.L);
+            Interleave3(p+12, a.H, b.H, c.H);
+        }
+        int Mask() const noexcept {
+            return _mm_movemask_ps(_mm_castsi128_ps(L)) | (_mm_movemask_ps(_mm_castsi128_ps(H)) << 4);
+        }
+        static I32x8 Truncate(F32x8 v) noexcept { return {_mm_cvttps_epi32(v.L), _mm_cvttps_epi32(v.H)}; }
+        static I32x8 FromBits(F32x8 v) noexcept { return {_mm_castps_si128(v.L), _mm_castps_si128(v.H)}; }
+        F32x8 ToFloat() const noexcept { return {_mm_cvtepi32_ps(L), _mm_cvtepi32_ps(H)}; }
+        F32x8 AsFloat() const noexcept { return {_mm_castsi128_ps(L), _mm_castsi128_ps(H)}; }
+
+        I32x8 operator-() const noexcept { return Zero()-*this; }
+        I32x8 operator+(I32x8 r) const noexcept { return {_mm_add_epi32(L, r.L), _mm_add_epi32(H, r.H)}; }
+        I32x8 operator-(I32x8 r) const noexcept { return {_mm_sub_epi32(L, r.L), _mm_sub_epi32(H, r.H)}; }
+        I32x8 operator*(I32x8 r) const noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_mullo_epi32(L, r.L), _mm_mullo_epi32(H, r.H)};
+#else
+            return {MulLo(L, r.L), MulLo(H, r.H)};
+#endif
+        }
+        I32x8 operator&(I32x8 r) const noexcept { return {_mm_and_si128(L, r.L), _mm_and_si128(H, r.H)}; }
+        I32x8 operator|(I32x8 r) const noexcept { return {_mm_or_si128(L, r.L), _mm_or_si128(H, r.H)}; }
+        I32x8 operator^(I32x8 r) const noexcept { return {_mm_xor_si128(L, r.L), _mm_xor_si128(H, r.H)}; }
+        I32x8 operator<<(int s) const noexcept {
+            const auto c = _mm_cvtsi32_si128(s);
+            return {_mm_sll_epi32(L, c), _mm_sll_epi32(H, c)};
+        }
+        I32x8 operator>>(int s) const noexcept {
+            const auto c = _mm_cvtsi32_si128(s);
+            return {_mm_sra_epi32(L, c), _mm_sra_epi32(H, c)};
+        }
+        I32x8 operator<<(I32x8 s) const noexcept { return Zip(s, [](int32_t a, int32_t b) noexcept { return int32_t(uint32_t(a) << b); }); }
+        I32x8 operator>>(I32x8 s) const noexcept { return Zip(s, [](int32_t a, int32_t b) noexcept { return a >> b; }); }
+        I32x8 ShiftRightLogical(int s) const noexcept {
+            const auto c = _mm_cvtsi32_si128(s);
+            return {_mm_srl_epi32(L, c), _mm_srl_epi32(H, c)};
+        }
+        I32x8 operator<(I32x8 r) const noexcept { return {_mm_cmplt_epi32(L, r.L), _mm_cmplt_epi32(H, r.H)}; }
+        I32x8 operator>(I32x8 r) const noexcept { return {_mm_cmpgt_epi32(L, r.L), _mm_cmpgt_epi32(H, r.H)}; }
+        I32x8 operator==(I32x8 r) const noexcept { return {_mm_cmpeq_epi32(L, r.L), _mm_cmpeq_epi32(H, r.H)}; }
+
+        friend I32x8 AndNot(I32x8 mask, I32x8 a) noexcept {
+            return {_mm_andnot_si128(mask.L, a.L), _mm_andnot_si128(mask.H, a.H)};
+        }
+        friend I32x8 Select(I32x8 mask, I32x8 a, I32x8 b) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_blendv_epi8(b.L, a.L, mask.L), _mm_blendv_epi8(b.H, a.H, mask.H)};
+#else
+            return (mask & a) | AndNot(mask, b);
+#endif
+        }
+        friend I32x8 Min(I32x8 a, I32x8 b) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_min_epi32(a.L, b.L), _mm_min_epi32(a.H, b.H)};
+#else
+            return Select(a<b, a, b);
+#endif
+        }
+        friend I32x8 Max(I32x8 a, I32x8 b) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return {_mm_max_epi32(a.L, b.L), _mm_max_epi32(a.H, b.H)};
+#else
+            return Select(a>b, a, b);
+#endif
+        }
+        friend I32x8 Abs(I32x8 a) noexcept {
+            const auto sign = a >> 31;
+            return (a^sign)-sign;
+        }
+    private:
+        // four 3-int records <-> one register per field
+        static void Deinterleave3(const int32_t* p, __m128i& x, __m128i& y, __m128i& z) noexcept {
+            const auto f = reinterpret_cast<const float*>(p);
+            const auto a = _mm_loadu_ps(f), b = _mm_loadu_ps(f+4), c = _mm_loadu_ps(f+8);
+            // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+            const auto xy = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+            const auto yz = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+            x = _mm_castps_si128(_mm_shuffle_ps(a, xy, _MM_SHUFFLE(2, 0, 3, 0)));
+            y = _mm_castps_si128(_mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+            z = _mm_castps_si128(_mm_shuffle_ps(yz, c, _MM_SHUFFLE(3, 0, 3, 1)));
+        }
+        static void Interleave3(int32_t* p, __m128i x, __m128i y, __m128i z) noexcept {
+            const auto fx = _mm_castsi128_ps(x), fy = _mm_castsi128_ps(y), fz = _mm_castsi128_ps(z);
+            const auto rxy = _mm_shuffle_ps(fx, fy, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto ryz = _mm_shuffle_ps(fy, fz, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto rzx = _mm_shuffle_ps(fz, fx, _MM_SHUFFLE(3, 1, 2, 0));
+            const auto f = reinterpret_cast<float*>(p);
+            _mm_storeu_ps(f, _mm_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(f+4, _mm_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm_storeu_ps(f+8, _mm_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        static __m128i MulLo(__m128i a, __m128i b) noexcept {
+            const auto even = _mm_mul_epu32(a, b);
+            const auto odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                      _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        }
+        template <class F>
+        I32x8 Zip(I32x8 r, F f) const noexcept {
+            alignas(16) int32_t a[8], b[8];
+            Store(a);
+            r.Store(b);
+            for (auto i = 0; i<8; ++i) a[i] = f(a[i], b[i]);
+            return Load(a);
+        }
+    public:
+#else
+        int32_t V[8];
+
+        static I32x8 Load(const int32_t* p) noexcept {
+            I32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = p[i];
+            return ret;
+        }
+        static I32x8 Broadcast(int32_t v) noexcept { return {{v, v, v, v, v, v, v, v}}; }
+        static I32x8 Zero() noexcept { return Broadcast(0); }
+        void Store(int32_t* p) const noexcept { for (auto i = 0; i<8; ++i) p[i] = V[i]; }
+        static void Load3(const int32_t* p, I32x8& a, I32x8& b, I32x8& c) noexcept {
+            for (auto i = 0; i<8; ++i) a.V[i] = p[i*3], b.V[i] = p[i*3+1], c.V[i] = p[i*3+2];
+        }
+        static void Store3(int32_t* p, I32x8 a, I32x8 b, I32x8 c) noexcept {
+            for (auto i = 0; i<8; ++i) p[i*3] = a.V[i], p[i*3+1] = b.V[i], p[i*3+2] = c.V[i];
+        }
+        int Mask() const noexcept {
+            auto ret = 0;
+            for (auto i = 0; i<8; ++i) ret |= int(uint32_t(V[i]) >> 31u) << i;
+            return ret;
+        }
+        static I32x8 Truncate(F32x8 v) noexcept {
+            I32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = int32_t(v.V[i]);
+            return ret;
+        }
+        static I32x8 FromBits(F32x8 v) noexcept {
+            I32x8 ret;
+            std::memcpy(ret.V, v.V, sizeof(ret.V));
+            return ret;
+        }
+        F32x8 ToFloat() const noexcept {
+            F32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = float(V[i]);
+            return ret;
+        }
+        F32x8 AsFloat() const noexcept {
+            F32x8 ret;
+            std::memcpy(ret.V, V, sizeof(V));
+            return ret;
+        }
+
+        // wrapping arithmetic, like the SIMD paths
+        I32x8 operator-() const noexcept { return Map([](int32_t a) noexcept { return int32_t(0u-uint32_t(a)); }); }
+        I32x8 operator+(I32x8 r) const noexcept {
+            return Zip(r, [](int32_t a, int32_t b) noexcept { return int32_t(uint32_t(a)+uint32_t(b)); });
+        }
+        I32x8 operator-(I32x8 r) const noexcept {
+            return Zip(r, [](int32_t a, int32_t b) noexcept { return int32_t(uint32_t(a)-uint32_t(b)); });
+        }
+        I32x8 operator*(I32x8 r) const noexcept {
+            return Zip(r, [](int32_t a, int32_t b) noexcept { return int32_t(uint32_t(a)*uint32_t(b)); });
+        }
+        I32x8 operator&(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return a & b; }); }
+        I32x8 operator|(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return a | b; }); }
+        I32x8 operator^(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return a ^ b; }); }
+        I32x8 operator<<(int s) const noexcept { return Map([s](int32_t a) noexcept { return int32_t(uint32_t(a) << s); }); }
+        I32x8 operator>>(int s) const noexcept { return Map([s](int32_t a) noexcept { return a >> s; }); }
+        I32x8 operator<<(I32x8 s) const noexcept { return Zip(s, [](int32_t a, int32_t b) noexcept { return int32_t(uint32_t(a) << b); }); }
+        I32x8 operator>>(I32x8 s) const noexcept { return Zip(s, [](int32_t a, int32_t b) noexcept { return a >> b; }); }
+        I32x8 ShiftRightLogical(int s) const noexcept { return Map([s](int32_t a) noexcept { return int32_t(uint32_t(a) >> s); }); }
+        I32x8 operator<(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return Bool(a<b); }); }
+        I32x8 operator>(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return Bool(a>b); }); }
+        I32x8 operator==(I32x8 r) const noexcept { return Zip(r, [](int32_t a, int32_t b) noexcept { return Bool(a==b); }); }
+
+        friend I32x8 Min(I32x8 a, I32x8 b) noexcept { return a.Zip(b, [](int32_t x, int32_t y) noexcept { return y<x ? y : x; }); }
+        friend I32x8 Max(I32x8 a, I32x8 b) noexcept { return a.Zip(b, [](int32_t x, int32_t y) noexcept { return x<y ? y : x; }); }
+        friend I32x8 Abs(I32x8 a) noexcept {
+            return a.Map([](int32_t x) noexcept { return x<0 ? int32_t(0u-uint32_t(x)) : x; });
+        }
+        friend I32x8 AndNot(I32x8 mask, I32x8 a) noexcept {
+            return mask.Zip(a, [](int32_t m, int32_t x) noexcept { return ~m & x; });
+        }
+        friend I32x8 Select(I32x8 mask, I32x8 a, I32x8 b) noexcept { return (mask & a) | AndNot(mask, b); }
+    private:
+        static int32_t Bool(bool v) noexcept { return v ? -1 : 0; }
+        template <class F>
+        I32x8 Map(F f) const noexcept {
+            I32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = f(V[i]);
+            return ret;
+        }
+        template <class F>
+        I32x8 Zip(I32x8 r, F f) const noexcept {
+            I32x8 ret;
+            for (auto i = 0; i<8; ++i) ret.V[i] = f(V[i], r.V[i]);
+            return ret;
+        }
+    public:
+#endif
+        I32x8& operator+=(I32x8 r) noexcept { return *this = *this+r; }
+        I32x8& operator-=(I32x8 r) noexcept { return *this = *this-r; }
+        I32x8& operator&=(I32x8 r) noexcept { return *this = *this & r; }
+    };
+}
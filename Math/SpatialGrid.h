@@ -0,0 +1,271 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "AABB.h"
+#include "Morton.h"
+#include "MortonMap.h"
+#include "Parallel.h"
+
+namespace Math {
+    // Uniform hash grid broadphase over points. Cell c covers [c * cellSize, (c + 1) * cellSize) on every axis.
+    // Occupied cells are kept in a MortonMap from cell to the head of an intrusive doubly-linked list of the points
+    // in it, so insert, move and remove are O(1) and queries only touch occupied cells. Handles are stable until
+    // removed; Rebuild() replaces everything and uses each point's index as its handle.
+    class SpatialGrid {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle None = ~0u;
+
+        explicit SpatialGrid(float cellSize = 1.0f) noexcept
+                :_CellSize(cellSize), _InvCellSize(1.0f/cellSize) { }
+
+        float CellSize() const noexcept { return _CellSize; }
+        // coordinates beyond the int range saturate
+        Vec3I Cell(const Vec3F& p) const noexcept {
+            return Vec3I(CellCoord(p.X*_InvCellSize), CellCoord(p.Y*_InvCellSize), CellCoord(p.Z*_InvCellSize));
+        }
+
+        // number of points
+        size_t Size() const noexcept { return _Size; }
+        // number of occupied cells
+        size_t CellCount() const noexcept { return _Heads.Size(); }
+        bool Valid(Handle h) const noexcept { return h<_Alive.size() && _Alive[h]; }
+        const Vec3F& Position(Handle h) const noexcept { return _Positions[h]; }
+
+        void Clear() noexcept {
+            _Heads.Clear();
+            _Positions.clear();
+            _Cells.clear();
+            _Next.clear();
+            _Prev.clear();
+            _Alive.clear();
+            _Free.clear();
+            _Size = 0;
+        }
+
+        Handle Insert(const Vec3F& p) {
+            Handle h;
+            if (_Free.empty()) {
+                h = Handle(_Positions.size());
+                _Positions.push_back(p);
+                _Cells.emplace_back();
+                _Next.push_back(None);
+                _Prev.push_back(None);
+                _Alive.push_back(1);
+            }
+            else {
+                h = _Free.back();
+                _Free.pop_back();
+                _Positions[h] = p;
+                _Alive[h] = 1;
+            }
+            _Cells[h] = Cell(p);
+            Link(h);
+            ++_Size;
+            return h;
+        }
+
+        // relinks only when the point crosses into another cell
+        void Move(Handle h, const Vec3F& p) {
+            _Positions[h] = p;
+            const auto cell = Cell(p);
+            if (cell==_Cells[h]) return;
+            Unlink(h);
+            _Cells[h] = cell;
+            Link(h);
+        }
+
+        void Remove(Handle h) noexcept {
+            Unlink(h);
+            _Alive[h] = 0;
+            _Free.push_back(h);
+            --_Size;
+        }
+
+        // Replaces the contents with positions, point i getting handle i. Cells and their Morton codes are computed
+        // in parallel and sorted, so each occupied cell is hashed once and its list is in ascending handle order.
+        void Rebuild(std::span<const Vec3F> positions) {
+            Clear();
+            const auto count = positions.size();
+            _Positions.assign(positions.begin(), positions.end());
+            _Cells.resize(count);
+            _Next.resize(count);
+            _Prev.resize(count);
+            _Alive.assign(count, 1);
+            _Size = count;
+            std::vector<uint64_t> keys(count);
+            Parallel::For(0, count, Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i) _Cells[i] = Cell(_Positions[i]);
+                Morton::Encode3(std::span<const Vec3I>(_Cells.data()+b, e-b), std::span<uint64_t>(keys.data()+b, e-b));
+            });
+            // sorting (code, index) pairs keeps the points of a cell in handle order
+            std::vector<std::pair<uint64_t, uint32_t>> order(count);
+            Parallel::For(0, count, Grain, [&](size_t b, size_t e) {
+                for (auto i = b; i<e; ++i) order[i] = {keys[i], uint32_t(i)};
+            });
+            std::sort(order.begin(), order.end());
+            auto cells = size_t(0);
+            for (auto i = size_t(0); i<count; ++i) cells += i==0 || order[i].first!=order[i-1].first;
+            _Heads.Reserve(cells);
+            for (auto i = size_t(0); i<count;) {
+                // equal codes can still be different cells far outside the 21-bit range, so split runs by cell
+                auto j = i+1;
+                const auto& cell = _Cells[order[i].second];
+                while (j<count && order[j].first==order[i].first && _Cells[order[j].second]==cell) ++j;
+                auto [it, inserted] = _Heads.Emplace(cell, order[i].second);
+                auto tail = inserted ? None : it->Value;
+                if (!inserted) {
+                    while (_Next[tail]!=None) tail = _Next[tail];
+                }
+                for (auto k = i; k<j; ++k) {
+                    const auto h = order[k].second;
+                    _Prev[h] = tail;
+                    _Next[h] = None;
+                    if (tail!=None) _Next[tail] = h;
+                    tail = h;
+                }
+                i = j;
+            }
+        }
+
+        // Calls fn(Handle, const Vec3F&) for every point within radius of center (inclusive)
+        template <class F>
+        void QueryRadius(const Vec3F& center, float radius, F&& fn) const {
+            const auto r2 = radius*radius;
+            const Vec3F r(radius, radius, radius);
+            ForEachInCells(Cell(center-r), Cell(center+r), [&](Handle h) {
+                const auto d = _Positions[h]-center;
+                if (d.Dot(d)<=r2) fn(h, _Positions[h]);
+            });
+        }
+
+        // Calls fn(Handle, const Vec3F&) for every point inside box (inclusive)
+        template <class F>
+        void QueryBox(const AABBF& box, F&& fn) const {
+            if (box.Empty()) return;
+            ForEachInCells(Cell(box.Min), Cell(box.Max), [&](Handle h) {
+                if (box.Contains(_Positions[h])) fn(h, _Positions[h]);
+            });
+        }
+
+        // Calls fn(Handle a, Handle b) once for every unordered pair of points at most radius apart. Each occupied
+        // cell is paired with itself and with the half of its neighbourhood that follows it in z, y, x order; when
+        // that neighbourhood holds more cells than are occupied, the occupied cells are compared pairwise instead.
+        template <class F>
+        void ForEachPair(float radius, F&& fn) const {
+            const auto r2 = radius*radius;
+            const auto reach = Reach(radius);
+            const auto side = double(2*reach+1);
+            const auto scan = (side*side*side-1)/2>double(_Heads.Size());
+            for (const auto& e : _Heads) {
+                for (auto a = e.Value; a!=None; a = _Next[a])
+                    for (auto b = _Next[a]; b!=None; b = _Next[b])
+                        if (DistanceSqr(a, b)<=r2) fn(a, b);
+                if (scan) {
+                    for (const auto& o : _Heads)
+                        if (Follows(o.Key, e.Key) && Near(o.Key, e.Key, reach)) PairCells(e.Value, o.Value, r2, fn);
+                    continue;
+                }
+                // keys are offset in 64 bits; cells past the int range cannot be occupied
+                for (auto dz = int64_t(0); dz<=reach; ++dz)
+                    for (auto dy = dz ? -reach : 0; dy<=reach; ++dy)
+                        for (auto dx = dz || dy ? -reach : 1; dx<=reach; ++dx) {
+                            const auto x = e.Key.X+dx, y = e.Key.Y+dy, z = e.Key.Z+dz;
+                            if (!InRange(x) || !InRange(y) || !InRange(z)) continue;
+                            if (const auto other = _Heads.Find(Vec3I(int(x), int(y), int(z))))
+                                PairCells(e.Value, *other, r2, fn);
+                        }
+            }
+        }
+    private:
+        static constexpr size_t Grain = 4096;
+
+        static int CellCoord(float v) noexcept {
+            const auto f = std::floor(v);
+            if (f>=2147483648.0f) return std::numeric_limits<int>::max();
+            if (!(f>=-2147483648.0f)) return std::numeric_limits<int>::lowest();
+            return int(f);
+        }
+        static bool InRange(int64_t v) noexcept {
+            return v>=std::numeric_limits<int>::lowest() && v<=std::numeric_limits<int>::max();
+        }
+
+        // neighbourhood radius in cells, at most the extent of the occupied cells, where no further pair can be
+        int64_t Reach(float radius) const noexcept {
+            const auto cells = std::ceil(radius*_InvCellSize);
+            if (!(cells>0.0f) || _Heads.Empty()) return 0;
+            Vec3I min = _Heads.begin()->Key, max = min;
+            for (const auto& e : _Heads)
+                for (auto a = 0; a<3; ++a) {
+                    min.Data[a] = std::min(min.Data[a], e.Key.Data[a]);
+                    max.Data[a] = std::max(max.Data[a], e.Key.Data[a]);
+                }
+            auto extent = int64_t(0);
+            for (auto a = 0; a<3; ++a) extent = std::max(extent, int64_t(max.Data[a])-min.Data[a]);
+            return cells>=float(extent) ? extent : int64_t(cells);
+        }
+
+        // whether a comes after b in z, y, x order
+        static bool Follows(const Vec3I& a, const Vec3I& b) noexcept {
+            if (a.Z!=b.Z) return a.Z>b.Z;
+            if (a.Y!=b.Y) return a.Y>b.Y;
+            return a.X>b.X;
+        }
+        static bool Near(const Vec3I& a, const Vec3I& b, int64_t reach) noexcept {
+            for (auto i = 0; i<3; ++i)
+                if (std::abs(int64_t(a.Data[i])-b.Data[i])>reach) return false;
+            return true;
+        }
+
+        template <class F>
+        void PairCells(Handle first, Handle second, float r2, F& fn) const {
+            for (auto a = first; a!=None; a = _Next[a])
+                for (auto b = second; b!=None; b = _Next[b])
+                    if (DistanceSqr(a, b)<=r2) fn(a, b);
+        }
+
+        float DistanceSqr(Handle a, Handle b) const noexcept {
+            const auto d = _Positions[a]-_Positions[b];
+            return d.Dot(d);
+        }
+
+        template <class F>
+        void ForEachInCells(const Vec3I& min, const Vec3I& max, F&& fn) const {
+            _Heads.ForEachInBox(min, max, [&](const Vec3I&, const Handle& head) {
+                for (auto h = head; h!=None; h = _Next[h]) fn(h);
+            });
+        }
+
+        void Link(Handle h) {
+            auto [it, inserted] = _Heads.Emplace(_Cells[h], h);
+            _Prev[h] = None;
+            _Next[h] = inserted ? None : it->Value;
+            if (!inserted) {
+                _Prev[it->Value] = h;
+                it->Value = h;
+            }
+        }
+
+        void Unlink(Handle h) noexcept {
+            const auto prev = _Prev[h], next = _Next[h];
+            if (next!=None) _Prev[next] = prev;
+            if (prev!=None) _Next[prev] = next;
+            else if (next!=None) *_Heads.Find(_Cells[h]) = next;
+            else _Heads.Erase(_Cells[h]);
+        }
+
+        float _CellSize, _InvCellSize;
+        MortonMap<Handle> _Heads;
+        std::vector<Vec3F> _Positions;
+        std::vector<Vec3I> _Cells;
+        std::vector<Handle> _Next, _Prev;
+        std::vector<uint8_t> _Alive;
+        std::vector<Handle> _Free;
+        size_t _Size = 0;
+    };
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <span>
+#include <algorithm>
+#include "Matrix.h"
+#include "SIMD/CPU.h"
+
+// Batched transforms under the column-vector convention (v' = m * v):
+//   TransformPoints      Vec3, w = 1, result w dropped (affine use, no perspective divide)
+//   TransformVectors     Vec3, w = 0
+//   TransformHomogeneous Vec4
+// in and out may be the same span; otherwise they must not overlap. min(in.size(), out.size()) elements are written.
+// The float overloads pick a kernel once per process from cpuid: AVX-512F, AVX2+FMA, SSE2 or scalar.
+namespace Math {
+    namespace SIMD {
+        using Transform3Kernel = void (*)(const Mat4F&, const float*, float*, size_t) noexcept;
+        using Transform4Kernel = void (*)(const Mat4F&, const float*, float*, size_t) noexcept;
+
+        template <bool Translate>
+        void Transform3Scalar(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i, in += 3, out += 3) {
+                const auto x = in[0], y = in[1], z = in[2];
+                for (auto r = 0; r<3; ++r) {
+                    const auto v = m(r, 0)*x+m(r, 1)*y+m(r, 2)*z;
+                    out[r] = Translate ? v+m(r, 3) : v;
+                }
+            }
+        }
+
+        inline void Transform4Scalar(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            for (auto i = 0u; i<n; ++i, in += 4, out += 4) {
+                const auto x = in[0], y = in[1], z = in[2], w = in[3];
+                for (auto r = 0; r<4; ++r) out[r] = m(r, 0)*x+m(r, 1)*y+m(r, 2)*z+m(r, 3)*w;
+            }
+        }
+
+#if defined(MATH_SIMD_SSE2)
+        template <bool Translate>
+        void Transform3SSE(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            // 16-byte stores spill into the next element's x, so the last element goes through the scalar path
+            const auto c0 = _mm_setr_ps(m(0, 0), m(1, 0), m(2, 0), 0.0f);
+            const auto c1 = _mm_setr_ps(m(0, 1), m(1, 1), m(2, 1), 0.0f);
+            const auto c2 = _mm_setr_ps(m(0, 2), m(1, 2), m(2, 2), 0.0f);
+            const auto c3 = Translate ? _mm_setr_ps(m(0, 3), m(1, 3), m(2, 3), 0.0f) : _mm_setzero_ps();
+            auto i = 0u;
+            for (; i+1<n; ++i, in += 3, out += 3) {
+                const auto x = _mm_set1_ps(in[0]), y = _mm_set1_ps(in[1]), z = _mm_set1_ps(in[2]);
+                const auto r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c0), _mm_mul_ps(y, c1)),
+                        _mm_add_ps(_mm_mul_ps(z, c2), c3));
+                // carry the next input x through the spilled lane so in-place use stays correct
+                const auto next = _mm_set_ss(in[3]);
+                _mm_storeu_ps(out, _mm_shuffle_ps(r, _mm_shuffle_ps(r, next, _MM_SHUFFLE(0, 0, 2, 2)),
+                        _MM_SHUFFLE(2, 0, 1, 0)));
+            }
+            if (i<n) Transform3Scalar<Translate>(m, in, out, 1);
+        }
+
+        inline void Transform4SSE(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            const auto c0 = _mm_setr_ps(m(0, 0), m(1, 0), m(2, 0), m(3, 0));
+            const auto c1 = _mm_setr_ps(m(0, 1), m(1, 1), m(2, 1), m(3, 1));
+            const auto c2 = _mm_setr_ps(m(0, 2), m(1, 2), m(2, 2), m(3, 2));
+            const auto c3 = _mm_setr_ps(m(0, 3), m(1, 3), m(2, 3), m(3, 3));
+            for (auto i = 0u; i<n; ++i, in += 4, out += 4) {
+                const auto v = _mm_loadu_ps(in);
+                const auto r = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), c0), _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), c1)),
+                        _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), c2), _mm_mul_ps(_mm_shuffle_ps(v, v, 0xFF), c3)));
+                _mm_storeu_ps(out, r);
+            }
+        }
+
+        // 8 interleaved xyz triples <-> x, y, z lanes
+        MATH_TARGET("avx2,fma")
+        inline void Deinterleave3(const float* p, __m256& x, __m256& y, __m256& z) noexcept {
+            const auto m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p+12), 1);
+            const auto m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p+4)), _mm_loadu_ps(p+16), 1);
+            const auto m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p+8)), _mm_loadu_ps(p+20), 1);
+            const auto xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+            const auto yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+            x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline void Interleave3(float* p, __m256 x, __m256 y, __m256 z) noexcept {
+            const auto rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+            const auto rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+            const auto r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+            const auto r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+            const auto r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(p, _mm256_castps256_ps128(r03));
+            _mm_storeu_ps(p+4, _mm256_castps256_ps128(r14));
+            _mm_storeu_ps(p+8, _mm256_castps256_ps128(r25));
+            _mm_storeu_ps(p+12, _mm256_extractf128_ps(r03, 1));
+            _mm_storeu_ps(p+16, _mm256_extractf128_ps(r14, 1));
+            _mm_storeu_ps(p+20, _mm256_extractf128_ps(r25, 1));
+        }
+
+        template <bool Translate>
+        MATH_TARGET("avx2,fma")
+        void Transform3AVX2(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            __m256 c[3][4];
+            for (auto r = 0; r<3; ++r)
+                for (auto k = 0; k<4; ++k) c[r][k] = _mm256_set1_ps(m(r, k));
+            auto i = 0u;
+            for (; i+8<=n; i += 8, in += 24, out += 24) {
+                __m256 v[3], o[3];
+                Deinterleave3(in, v[0], v[1], v[2]);
+                for (auto r = 0; r<3; ++r) {
+                    auto acc = Translate ? _mm256_fmadd_ps(v[0], c[r][0], c[r][3]) : _mm256_mul_ps(v[0], c[r][0]);
+                    acc = _mm256_fmadd_ps(v[1], c[r][1], acc);
+                    o[r] = _mm256_fmadd_ps(v[2], c[r][2], acc);
+                }
+                Interleave3(out, o[0], o[1], o[2]);
+            }
+            Transform3Scalar<Translate>(m, in, out, n-i);
+        }
+
+        MATH_TARGET("avx2,fma")
+        inline void Transform4AVX2(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            // two points per register; each 128-bit half is transformed independently
+            const auto c0 = _mm256_setr_ps(m(0, 0), m(1, 0), m(2, 0), m(3, 0), m(0, 0), m(1, 0), m(2, 0), m(3, 0));
+            const auto c1 = _mm256_setr_ps(m(0, 1), m(1, 1), m(2, 1), m(3, 1), m(0, 1), m(1, 1), m(2, 1), m(3, 1));
+            const auto c2 = _mm256_setr_ps(m(0, 2), m(1, 2), m(2, 2), m(3, 2), m(0, 2), m(1, 2), m(2, 2), m(3, 2));
+            const auto c3 = _mm256_setr_ps(m(0, 3), m(1, 3), m(2, 3), m(3, 3), m(0, 3), m(1, 3), m(2, 3), m(3, 3));
+            auto i = 0u;
+            for (; i+4<=n; i += 4, in += 16, out += 16) {
+                const auto a = _mm256_loadu_ps(in), b = _mm256_loadu_ps(in+8);
+                auto ra = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), c0);
+                auto rb = _mm256_mul_ps(_mm256_shuffle_ps(b, b, 0x00), c0);
+                ra = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), c1, ra);
+                rb = _mm256_fmadd_ps(_mm256_shuffle_ps(b, b, 0x55), c1, rb);
+                ra = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), c2, ra);
+                rb = _mm256_fmadd_ps(_mm256_shuffle_ps(b, b, 0xAA), c2, rb);
+                ra = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), c3, ra);
+                rb = _mm256_fmadd_ps(_mm256_shuffle_ps(b, b, 0xFF), c3, rb);
+                _mm256_storeu_ps(out, ra);
+                _mm256_storeu_ps(out+8, rb);
+            }
+            Transform4Scalar(m, in, out, n-i);
+        }
+
+        // permutex2var index tables for 16 interleaved xyz triples in three zmm registers (a, b, c).
+        // Gather: lane i of component k is element 3i+k; pass one picks from a:b, pass two from (pass one):c.
+        // Scatter: element j of output register o is component j%3 of lane (16o+j)/3, built the same way.
+        struct Interleave3x16Tables {
+            alignas(64) int GatherAB[3][16], GatherC[3][16];
+            alignas(64) int ScatterXY[3][16], ScatterZ[3][16];
+
+            constexpr Interleave3x16Tables() noexcept: GatherAB{}, GatherC{}, ScatterXY{}, ScatterZ{} {
+                for (auto k = 0; k<3; ++k)
+                    for (auto i = 0; i<16; ++i) {
+                        const auto e = 3*i+k;
+                        GatherAB[k][i] = e<32 ? e : 0;
+                        GatherC[k][i] = e<32 ? i : 16+(e-32);
+                    }
+                for (auto o = 0; o<3; ++o)
+                    for (auto j = 0; j<16; ++j) {
+                        const auto e = 16*o+j, k = e%3, lane = e/3;
+                        ScatterXY[o][j] = k==0 ? lane : k==1 ? 16+lane : 0;
+                        ScatterZ[o][j] = k==2 ? 16+lane : j;
+                    }
+            }
+        };
+
+        inline constexpr Interleave3x16Tables Interleave3x16{};
+
+        template <bool Translate>
+        MATH_TARGET("avx512f")
+        void Transform3AVX512(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            __m512 c[3][4];
+            for (auto r = 0; r<3; ++r)
+                for (auto k = 0; k<4; ++k) c[r][k] = _mm512_set1_ps(m(r, k));
+            __m512i gab[3], gc[3], sxy[3], sz[3];
+            for (auto k = 0; k<3; ++k) {
+                gab[k] = _mm512_load_si512(Interleave3x16.GatherAB[k]);
+                gc[k] = _mm512_load_si512(Interleave3x16.GatherC[k]);
+                sxy[k] = _mm512_load_si512(Interleave3x16.ScatterXY[k]);
+                sz[k] = _mm512_load_si512(Interleave3x16.ScatterZ[k]);
+            }
+            auto i = 0u;
+            for (; i+16<=n; i += 16, in += 48, out += 48) {
+                const auto a = _mm512_loadu_ps(in), b = _mm512_loadu_ps(in+16), cc = _mm512_loadu_ps(in+32);
+                __m512 v[3], o[3];
+                for (auto k = 0; k<3; ++k)
+                    v[k] = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, gab[k], b), gc[k], cc);
+                for (auto r = 0; r<3; ++r) {
+                    auto acc = Translate ? _mm512_fmadd_ps(v[0], c[r][0], c[r][3]) : _mm512_mul_ps(v[0], c[r][0]);
+                    acc = _mm512_fmadd_ps(v[1], c[r][1], acc);
+                    o[r] = _mm512_fmadd_ps(v[2], c[r][2], acc);
+                }
+                for (auto k = 0; k<3; ++k)
+                    _mm512_storeu_ps(out+16*k, _mm512_permutex2var_ps(
+                            _mm512_permutex2var_ps(o[0], sxy[k], o[1]), sz[k], o[2]));
+            }
+            Transform3AVX2<Translate>(m, in, out, n-i);
+        }
+
+        MATH_TARGET("avx512f")
+        inline void Transform4AVX512(const Mat4F& m, const float* in, float* out, size_t n) noexcept {
+            // four points per register
+            float cols[4][16];
+            for (auto k = 0; k<4; ++k)
+                for (auto l = 0; l<16; ++l) cols[k][l] = m(l%4, k);
+            const auto c0 = _mm512_loadu_ps(cols[0]), c1 = _mm512_loadu_ps(cols[1]);
+            const auto c2 = _mm512_loadu_ps(cols[2]), c3 = _mm512_loadu_ps(cols[3]);
+            auto i = 0u;
+            for (; i+8<=n; i += 8, in += 32, out += 32) {
+                const auto a = _mm512_loadu_ps(in), b = _mm512_loadu_ps(in+16);
+                auto ra = _mm512_mul_ps(_mm512_shuffle_ps(a, a, 0x00), c0);
+                auto rb = _mm512_mul_ps(_mm512_shuffle_ps(b, b, 0x00), c0);
+                ra = _mm512_fmadd_ps(_mm512_shuffle_ps(a, a, 0x55), c1, ra);
+                rb = _mm512_fmadd_ps(_mm512_shuffle_ps(b, b, 0x55), c1, rb);
+                ra = _mm512_fmadd_ps(_mm512_shuffle_ps(a, a, 0xAA), c2, ra);
+                rb = _mm512_fmadd_ps(_mm512_shuffle_ps(b, b, 0xAA), c2, rb);
+                ra = _mm512_fmadd_ps(_mm512_shuffle_ps(a, a, 0xFF), c3, ra);
+                rb = _mm512_fmadd_ps(_mm512_shuffle_ps(b, b, 0xFF), c3, rb);
+                _mm512_storeu_ps(out, ra);
+                _mm512_storeu_ps(out+16, rb);
+            }
+            Transform4AVX2(m, in, out, n-i);
+        }
+#endif
+
+        template <bool Translate>
+        Transform3Kernel SelectTransform3() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX512F && cpu.AVX2 && cpu.FMA) return &Transform3AVX512<Translate>;
+            if (cpu.AVX2 && cpu.FMA) return &Transform3AVX2<Translate>;
+            return &Transform3SSE<Translate>;
+#else
+            return &Transform3Scalar<Translate>;
+#endif
+        }
+
+        inline Transform4Kernel SelectTransform4() noexcept {
+#if defined(MATH_SIMD_SSE2)
+            const auto& cpu = CPU();
+            if (cpu.AVX512F && cpu.AVX2 && cpu.FMA) return &Transform4AVX512;
+            if (cpu.AVX2 && cpu.FMA) return &Transform4AVX2;
+            return &Transform4SSE;
+#else
+            return &Transform4Scalar;
+#endif
+        }
+    }
+
+    inline void TransformPoints(const Mat4F& m, std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        static const auto kernel = SIMD::SelectTransform3<true>();
+        kernel(m, reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+
+    inline void TransformVectors(const Mat4F& m, std::span<const Vec3F> in, std::span<Vec3F> out) noexcept {
+        static const auto kernel = SIMD::SelectTransform3<false>();
+        kernel(m, reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+
+    inline void TransformHomogeneous(const Mat4F& m, std::span<const Vec4F> in, std::span<Vec4F> out) noexcept {
+        static const auto kernel = SIMD::SelectTransform4();
+        kernel(m, reinterpret_cast<const float*>(in.data()), reinterpret_cast<float*>(out.data()), std::min(in.size(), out.size()));
+    }
+
+    template <class T>
+    void TransformPoints(const Mat<T, 4, 4>& m, std::span<const Vec3<T>> in, std::span<Vec3<T>> out) noexcept {
+        for (auto i = 0u; i<std::min(in.size(), out.size()); ++i) {
+            const auto r = m*Vec4<T>(in[i].X, in[i].Y, in[i].Z, T(1));
+            out[i] = Vec3<T>(r.X, r.Y, r.Z);
+        }
+    }
+
+    template <class T>
+    void TransformVectors(const Mat<T, 4, 4>& m, std::span<const Vec3<T>> in, std::span<Vec3<T>> out) noexcept {
+        for (auto i = 0u; i<std::min(in.size(), out.size()); ++i) {
+            const auto r = m*Vec4<T>(in[i].X, in[i].Y, in[i].Z, T(0));
+            out[i] = Vec3<T>(r.X, r.Y, r.Z);
+        }
+    }
+
+    template <class T>
+    void TransformHomogeneous(const Mat<T, 4, 4>& m, std::span<const Vec4<T>> in, std::span<Vec4<T>> out) noexcept {
+        for (auto i = 0u; i<std::min(in.size(), out.size()); ++i) out[i] = m*in[i];
+    }
+}
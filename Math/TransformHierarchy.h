@@ -0,0 +1,209 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "Affine.h"
+#include "Parallel.h"
+
+namespace Math {
+    // Scene graph of affine transforms: world(node) = world(parent) * local(node), with roots taking world = local.
+    // Nodes live in structure-of-arrays storage in breadth-first order, so every level is a contiguous range and
+    // children of one parent are adjacent. Update() walks the levels top-down and recomputes only nodes whose local
+    // transform changed or whose parent's world changed. Each level runs in parallel on the default thread pool,
+    // and runs of siblings under a changed parent go through the batched Compose kernel.
+    // Adding or removing nodes only flags the layout; the next Update() reorders the arrays in one pass.
+    class TransformHierarchy {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle None = ~0u;
+
+        TransformHierarchy() noexcept = default;
+
+        // parent must be a valid handle or None; the new node's world is computed by the next Update()
+        Handle Add(const Affine3F& local = {}, Handle parent = None) {
+            Handle h;
+            if (_Free.empty()) {
+                h = Handle(_Nodes.size());
+                _Nodes.emplace_back();
+            }
+            else {
+                h = _Free.back();
+                _Free.pop_back();
+            }
+            const auto level = parent==None ? 0u : _Nodes[parent].Level+1;
+            _Nodes[h] = {uint32_t(_Handles.size()), level, true};
+            _Handles.push_back(h);
+            _Parent.push_back(parent==None ? None : _Nodes[parent].Dense);
+            _Local.push_back(local);
+            _World.push_back(local);
+            _Dirty.push_back(1);
+            _Changed.push_back(0);
+            _AnyDirty = true;
+            _LayoutDirty = true;
+            return h;
+        }
+        Handle Add(const Vec3F& translation, const QuatF& rotation, const Vec3F& scale, Handle parent = None) {
+            return Add(Affine3F::FromTRS(translation, rotation, scale), parent);
+        }
+
+        // Removes node and its whole subtree. The handles of descendants stay valid until the next Update().
+        void Remove(Handle node) noexcept {
+            _Nodes[node].Alive = false;
+            _LayoutDirty = true;
+        }
+
+        bool Valid(Handle node) const noexcept { return node<_Nodes.size() && _Nodes[node].Alive; }
+        // number of nodes, including removed ones until the next Update()
+        size_t Size() const noexcept { return _Handles.size(); }
+        uint32_t Level(Handle node) const noexcept { return _Nodes[node].Level; }
+        Handle Parent(Handle node) const noexcept {
+            const auto p = _Parent[_Nodes[node].Dense];
+            return p==None ? None : _Handles[p];
+        }
+
+        const Affine3F& Local(Handle node) const noexcept { return _Local[_Nodes[node].Dense]; }
+        void SetLocal(Handle node, const Affine3F& local) noexcept {
+            const auto d = _Nodes[node].Dense;
+            _Local[d] = local;
+            _Dirty[d] = 1;
+            _AnyDirty = true;
+        }
+        void SetLocal(Handle node, const Vec3F& translation, const QuatF& rotation, const Vec3F& scale) noexcept {
+            SetLocal(node, Affine3F::FromTRS(translation, rotation, scale));
+        }
+
+        // as of the last Update()
+        const Affine3F& World(Handle node) const noexcept { return _World[_Nodes[node].Dense]; }
+        Mat4F WorldMat4(Handle node) const noexcept { return World(node).ToMat4(); }
+
+        // Level-ordered arrays as of the last Update(): node i has parent index Parents()[i] (None for roots) and
+        // handle Handles()[i]; level l covers [LevelStarts()[l], LevelStarts()[l + 1]).
+        std::span<const Handle> Handles() const noexcept { return _Handles; }
+        std::span<const uint32_t> Parents() const noexcept { return _Parent; }
+        std::span<const uint32_t> LevelStarts() const noexcept { return _LevelStart; }
+        std::span<const Affine3F> Locals() const noexcept { return _Local; }
+        std::span<const Affine3F> Worlds() const noexcept { return _World; }
+
+        void Update() {
+            if (_LayoutDirty) Rebuild();
+            if (!_AnyDirty) return;
+            for (auto l = size_t(0); l+1<_LevelStart.size(); ++l)
+                Parallel::For(_LevelStart[l], _LevelStart[l+1], Grain, [this](size_t b, size_t e) { Propagate(b, e); });
+            _AnyDirty = false;
+        }
+    private:
+        static constexpr size_t Grain = 1024;
+
+        struct Node {
+            uint32_t Dense = 0, Level = 0;
+            bool Alive = false;
+        };
+
+        void Propagate(size_t b, size_t e) noexcept {
+            for (auto i = b; i<e;) {
+                const auto p = _Parent[i];
+                if (p==None) {
+                    if (_Dirty[i]) _World[i] = _Local[i];
+                    _Changed[i] = _Dirty[i];
+                    _Dirty[i] = 0;
+                    ++i;
+                    continue;
+                }
+                auto j = i+1;
+                while (j<e && _Parent[j]==p) ++j;
+                if (_Changed[p]) {
+                    Compose(_World[p], std::span<const Affine3F>(_Local.data()+i, j-i),
+                            std::span<Affine3F>(_World.data()+i, j-i));
+                    std::fill(_Changed.begin()+ptrdiff_t(i), _Changed.begin()+ptrdiff_t(j), uint8_t(1));
+                }
+                else {
+                    for (auto k = i; k<j; ++k) {
+                        if (_Dirty[k]) _World[k] = _World[p]*_Local[k];
+                        _Changed[k] = _Dirty[k];
+                    }
+                }
+                std::fill(_Dirty.begin()+ptrdiff_t(i), _Dirty.begin()+ptrdiff_t(j), uint8_t(0));
+                i = j;
+            }
+        }
+
+        // Drops removed subtrees and restores breadth-first order with siblings grouped by parent
+        void Rebuild() {
+            const auto count = _Handles.size();
+            // parents come before children in level order, so one pass over it settles removal of whole subtrees
+            std::vector<uint32_t> levels(count), byLevel(count), start;
+            for (auto i = size_t(0); i<count; ++i) {
+                levels[i] = _Nodes[_Handles[i]].Level;
+                if (start.size()<levels[i]+2) start.resize(levels[i]+2);
+                ++start[levels[i]+1];
+            }
+            for (auto l = size_t(1); l<start.size(); ++l) start[l] += start[l-1];
+            for (auto i = size_t(0); i<count; ++i) byLevel[start[levels[i]]++] = uint32_t(i);
+            std::vector<uint8_t> alive(count);
+            for (const auto i : byLevel)
+                alive[i] = _Nodes[_Handles[i]].Alive && (_Parent[i]==None || alive[_Parent[i]]);
+            // children of each node in CSR form, in current order
+            std::vector<uint32_t> first(count+1), children;
+            for (auto i = size_t(0); i<count; ++i)
+                if (alive[i] && _Parent[i]!=None) ++first[_Parent[i]+1];
+            for (auto i = size_t(0); i<count; ++i) first[i+1] += first[i];
+            children.resize(first[count]);
+            {
+                auto fill = first;
+                for (auto i = size_t(0); i<count; ++i)
+                    if (alive[i] && _Parent[i]!=None) children[fill[_Parent[i]]++] = uint32_t(i);
+            }
+            std::vector<uint32_t> order;
+            order.reserve(count);
+            for (auto i = size_t(0); i<count; ++i)
+                if (alive[i] && _Parent[i]==None) order.push_back(uint32_t(i));
+            for (auto i = size_t(0); i<order.size(); ++i)
+                order.insert(order.end(), children.begin()+first[order[i]], children.begin()+first[order[i]+1]);
+
+            std::vector<uint32_t> dense(count, None);
+            for (auto i = size_t(0); i<order.size(); ++i) dense[order[i]] = uint32_t(i);
+            for (auto i = size_t(0); i<count; ++i)
+                if (!alive[i]) {
+                    _Nodes[_Handles[i]].Alive = false;
+                    _Free.push_back(_Handles[i]);
+                }
+            std::vector<uint32_t> parent;
+            parent.reserve(order.size());
+            _LevelStart.clear();
+            for (auto i = size_t(0); i<order.size(); ++i) {
+                const auto o = order[i];
+                parent.push_back(_Parent[o]==None ? None : dense[_Parent[o]]);
+                while (_LevelStart.size()<=levels[o]) _LevelStart.push_back(uint32_t(i));
+            }
+            _LevelStart.push_back(uint32_t(order.size()));
+            _Parent.swap(parent);
+            Permute(_Handles, order);
+            Permute(_Local, order);
+            Permute(_World, order);
+            Permute(_Dirty, order);
+            for (auto i = size_t(0); i<_Handles.size(); ++i) _Nodes[_Handles[i]].Dense = uint32_t(i);
+            _Changed.assign(_Handles.size(), 0);
+            _LayoutDirty = false;
+        }
+
+        template <class V>
+        static void Permute(std::vector<V>& v, const std::vector<uint32_t>& order) {
+            std::vector<V> ret;
+            ret.reserve(order.size());
+            for (const auto o : order) ret.push_back(v[o]);
+            v.swap(ret);
+        }
+
+        std::vector<Node> _Nodes;
+        std::vector<Handle> _Free;
+        // level-ordered, indexed by dense position
+        std::vector<Handle> _Handles;
+        std::vector<uint32_t> _Parent;
+        std::vector<Affine3F> _Local, _World;
+        std::vector<uint8_t> _Dirty, _Changed;
+        std::vector<uint32_t> _LevelStart;
+        bool _AnyDirty = false, _LayoutDirty = false;
+    };
+}
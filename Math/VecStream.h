@@ -0,0 +1,209 @@
+#pragma once
+
+#include <new>
+#include <span>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "Matrix.h"
+#include "SIMD.h"
+
+namespace Math {
+    // Non-owning structure-of-arrays view: one pointer per component lane, Size() elements each.
+    // Float kernels run one or two F32x8 blocks (8 or 16 elements) per iteration and finish the tail with scalar code.
+    template <size_t D, class T>
+    class VecStreamView {
+    public:
+        using ValueType = Vec<D, T>;
+
+        constexpr VecStreamView() noexcept = default;
+        constexpr VecStreamView(T* const (&lanes)[D], size_t size) noexcept
+                :_Size(size) { for (auto d = 0u; d<D; ++d) _Lanes[d] = lanes[d]; }
+
+        constexpr size_t Size() const noexcept { return _Size; }
+        std::span<T> Lane(size_t d) const noexcept { return {_Lanes[d], _Size}; }
+        std::span<T> operator[](size_t d) const noexcept { return Lane(d); }
+
+        ValueType Get(size_t i) const noexcept {
+            ValueType ret{VectorUninitialized};
+            for (auto d = 0u; d<D; ++d) ret.Data[d] = _Lanes[d][i];
+            return ret;
+        }
+        void Set(size_t i, const ValueType& v) const noexcept { for (auto d = 0u; d<D; ++d) _Lanes[d][i] = v.Data[d]; }
+
+        // AoS <-> SoA transposition; the view keeps its size, in/out must hold at least Size() elements
+        void Gather(std::span<const ValueType> in) const noexcept { for (auto i = size_t(0); i<_Size; ++i) Set(i, in[i]); }
+        void Scatter(std::span<ValueType> out) const noexcept { for (auto i = size_t(0); i<_Size; ++i) out[i] = Get(i); }
+
+        void Add(const VecStreamView<D, T>& r) const noexcept {
+            for (auto d = 0u; d<D; ++d) {
+                auto i = size_t(0);
+                if constexpr (std::is_same_v<T, float>) {
+                    for (; i+16<=_Size; i += 16) {
+                        (SIMD::F32x8::Load(_Lanes[d]+i)+SIMD::F32x8::Load(r._Lanes[d]+i)).Store(_Lanes[d]+i);
+                        (SIMD::F32x8::Load(_Lanes[d]+i+8)+SIMD::F32x8::Load(r._Lanes[d]+i+8)).Store(_Lanes[d]+i+8);
+                    }
+                }
+                for (; i<_Size; ++i) _Lanes[d][i] += r._Lanes[d][i];
+            }
+        }
+
+        void Scale(T s) const noexcept {
+            for (auto d = 0u; d<D; ++d) {
+                auto i = size_t(0);
+                if constexpr (std::is_same_v<T, float>) {
+                    const auto vs = SIMD::F32x8::Broadcast(s);
+                    for (; i+16<=_Size; i += 16) {
+                        (SIMD::F32x8::Load(_Lanes[d]+i)*vs).Store(_Lanes[d]+i);
+                        (SIMD::F32x8::Load(_Lanes[d]+i+8)*vs).Store(_Lanes[d]+i+8);
+                    }
+                }
+                for (; i<_Size; ++i) _Lanes[d][i] *= s;
+            }
+        }
+
+        // out must hold at least Size() elements
+        void Dot(const VecStreamView<D, T>& r, std::span<T> out) const noexcept {
+            assert(out.size()>=_Size);
+            auto i = size_t(0);
+            if constexpr (std::is_same_v<T, float>) {
+                for (; i+8<=_Size; i += 8) {
+                    auto acc = SIMD::F32x8::Load(_Lanes[0]+i)*SIMD::F32x8::Load(r._Lanes[0]+i);
+                    for (auto d = 1u; d<D; ++d)
+                        acc = MulAdd(SIMD::F32x8::Load(_Lanes[d]+i), SIMD::F32x8::Load(r._Lanes[d]+i), acc);
+                    acc.Store(out.data()+i);
+                }
+            }
+            for (; i<_Size; ++i) {
+                T acc = _Lanes[0][i]*r._Lanes[0][i];
+                for (auto d = 1u; d<D; ++d) acc += _Lanes[d][i]*r._Lanes[d][i];
+                out[i] = acc;
+            }
+        }
+
+        void LengthSqr(std::span<T> out) const noexcept { Dot(*this, out); }
+
+        // zero-length elements are left as zero
+        void Normalize() const noexcept {
+            auto i = size_t(0);
+            if constexpr (std::is_same_v<T, float>) {
+                const auto zero = SIMD::F32x8::Zero(), one = SIMD::F32x8::Broadcast(1.0f);
+                for (; i+8<=_Size; i += 8) {
+                    SIMD::F32x8 v[D];
+                    for (auto d = 0u; d<D; ++d) v[d] = SIMD::F32x8::Load(_Lanes[d]+i);
+                    auto len = v[0]*v[0];
+                    for (auto d = 1u; d<D; ++d) len = MulAdd(v[d], v[d], len);
+                    const auto inv = Select(len>zero, one/Sqrt(len), zero);
+                    for (auto d = 0u; d<D; ++d) (v[d]*inv).Store(_Lanes[d]+i);
+                }
+            }
+            for (; i<_Size; ++i) {
+                T len = _Lanes[0][i]*_Lanes[0][i];
+                for (auto d = 1u; d<D; ++d) len += _Lanes[d][i]*_Lanes[d][i];
+                if (len>T(0)) {
+                    const T inv = T(1)/std::sqrt(len);
+                    for (auto d = 0u; d<D; ++d) _Lanes[d][i] *= inv;
+                }
+            }
+        }
+
+        // Column-vector convention: v' = m * v. Three-component streams are points (w = 1, result w dropped).
+        void Transform(const Mat<T, 4, 4>& m) const noexcept {
+            static_assert(D==3 || D==4, "Transform requires a 3 or 4 component stream");
+            auto i = size_t(0);
+            if constexpr (std::is_same_v<T, float>) {
+                SIMD::F32x8 c[D][4];
+                for (auto r = 0u; r<D; ++r)
+                    for (auto k = 0u; k<4; ++k) c[r][k] = SIMD::F32x8::Broadcast(m(r, k));
+                for (; i+8<=_Size; i += 8) {
+                    SIMD::F32x8 v[4];
+                    for (auto d = 0u; d<D; ++d) v[d] = SIMD::F32x8::Load(_Lanes[d]+i);
+                    for (auto r = 0u; r<D; ++r) {
+                        auto acc = c[r][3];
+                        if constexpr (D==4) acc = v[3]*acc;
+                        acc = MulAdd(v[0], c[r][0], acc);
+                        acc = MulAdd(v[1], c[r][1], acc);
+                        MulAdd(v[2], c[r][2], acc).Store(_Lanes[r]+i);
+                    }
+                }
+            }
+            for (; i<_Size; ++i) {
+                T v[4] = {_Lanes[0][i], _Lanes[1][i], _Lanes[2][i], T(1)};
+                if constexpr (D==4) v[3] = _Lanes[3][i];
+                for (auto r = 0u; r<D; ++r)
+                    _Lanes[r][i] = m(r, 0)*v[0]+m(r, 1)*v[1]+m(r, 2)*v[2]+m(r, 3)*v[3];
+            }
+        }
+    protected:
+        T* _Lanes[D] {};
+        size_t _Size = 0;
+    };
+
+    // Owning structure-of-arrays container. Every lane is 64-byte aligned and padded to a multiple of 16 elements.
+    template <size_t D, class T>
+    class VecStream : public VecStreamView<D, T> {
+        using View = VecStreamView<D, T>;
+    public:
+        static constexpr size_t Padding = 16;
+        static constexpr size_t Alignment = 64;
+
+        VecStream() noexcept = default;
+        explicit VecStream(size_t size) { Resize(size); }
+        explicit VecStream(std::span<const Vec<D, T>> in) {
+            Resize(in.size());
+            View::Gather(in);
+        }
+        VecStream(const VecStream& r) : VecStream() { *this = r; }
+        VecStream(VecStream&& r) noexcept : VecStream() { Swap(r); }
+        VecStream& operator=(const VecStream& r) {
+            if (this!=&r) {
+                Resize(r._Size);
+                for (auto d = 0u; d<D; ++d) std::copy_n(r._Lanes[d], r._Size, this->_Lanes[d]);
+            }
+            return *this;
+        }
+        VecStream& operator=(VecStream&& r) noexcept {
+            Swap(r);
+            return *this;
+        }
+        ~VecStream() noexcept { Release(); }
+
+        size_t Capacity() const noexcept { return _Capacity; }
+
+        // new elements are zero; existing elements are kept
+        void Resize(size_t size) {
+            if (size>_Capacity) {
+                const auto capacity = std::max((size+Padding-1)/Padding*Padding, _Capacity*2);
+                auto block = static_cast<T*>(::operator new(sizeof(T)*capacity*D, std::align_val_t{Alignment}));
+                std::fill_n(block, capacity*D, T(0));
+                for (auto d = 0u; d<D; ++d) std::copy_n(this->_Lanes[d], this->_Size, block+d*capacity);
+                Release();
+                for (auto d = 0u; d<D; ++d) this->_Lanes[d] = block+d*capacity;
+                _Capacity = capacity;
+            }
+            else if (size<this->_Size) {
+                for (auto d = 0u; d<D; ++d) std::fill(this->_Lanes[d]+size, this->_Lanes[d]+this->_Size, T(0));
+            }
+            this->_Size = size;
+        }
+
+        void Swap(VecStream& r) noexcept {
+            std::swap(static_cast<View&>(*this), static_cast<View&>(r));
+            std::swap(_Capacity, r._Capacity);
+        }
+    private:
+        void Release() noexcept {
+            if (this->_Lanes[0]) ::operator delete(this->_Lanes[0], std::align_val_t{Alignment});
+            for (auto d = 0u; d<D; ++d) this->_Lanes[d] = nullptr;
+        }
+
+        size_t _Capacity = 0;
+    };
+
+    template <class T>
+    using Vec3Stream = VecStream<3, T>;
+    template <class T>
+    using Vec4Stream = VecStream<4, T>;
+    using Vec3FStream = Vec3Stream<float>;
+    using Vec4FStream = Vec4Stream<float>;
+}
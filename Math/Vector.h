@@ -4,7 +4,9 @@
 #include "Vector/2.h"
 #include "Vector/3.h"
 #include "Vector/4.h"
+#include "Vector/4F.h"
 #include "Vector/Generic.h"
+#include "Morton.h"
 
 namespace Math {
     template <class T, class ...U>
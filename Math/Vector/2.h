@@ -55,7 +55,7 @@ namespace Math {
         constexpr T LengthSqr() const noexcept { return X*X+Y*Y; }
         constexpr bool operator==(const Vec& r) const noexcept { return (X==r.X) && (Y==r.Y); }
         constexpr T Dot(const Vec& r) const noexcept { return X*r.X+Y*r.Y; }
-        T Length() noexcept { return sqrt(LengthSqr()); }
+        LengthType<T> Length() const noexcept { return std::sqrt(LengthType<T>(LengthSqr())); }
     };
 
     template <class T>
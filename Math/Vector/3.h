@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include "Base.h"
 
 namespace Math {
@@ -69,7 +70,7 @@ namespace Math {
         constexpr T LengthSqr() const noexcept { return X*X+Y*Y+Z*Z; }
         constexpr bool operator==(const Vec& r) const noexcept { return (X==r.X) && (Y==r.Y) && (Z==r.Z); }
         constexpr T Dot(const Vec& r) const noexcept { return X*r.X+Y*r.Y+Z*r.Z; }
-        T Length() noexcept { return sqrt(LengthSqr()); }
+        LengthType<T> Length() const noexcept { return std::sqrt(LengthType<T>(LengthSqr())); }
     };
 
     template <class T>
@@ -83,35 +84,3 @@ namespace Math {
     using Vec3D = Vec3<double>;
     using Vec3ED = Vec3<long double>;
 }
-
-namespace std {
-    template <>
-    struct hash<Math::Vec3I> {
-        using argument_type = Math::Vec3I;
-        using result_type = std::size_t;
-
-        result_type operator()(argument_type const& s) const noexcept {
-            size_t x = s.X;
-            x = (x) & 0xFFFF00000000FFFF;
-            x = (x | (x << 16)) & 0x00FF0000FF0000FF;
-            x = (x | (x << 8)) & 0xF00F00F00F00F00F;
-            x = (x | (x << 4)) & 0x30C30C30C30C30C3;
-            x = (x | (x << 2)) & 0x9249249249249249;
-
-            size_t y = s.Y;
-            y = (y) & 0xFFFF00000000FFFF;
-            y = (y | (y << 16)) & 0x00FF0000FF0000FF;
-            y = (y | (y << 8)) & 0xF00F00F00F00F00F;
-            y = (y | (y << 4)) & 0x30C30C30C30C30C3;
-            y = (y | (y << 2)) & 0x9249249249249249;
-
-            size_t z = s.Z;
-            z = (z) & 0xFFFF00000000FFFF;
-            z = (z | (z << 16)) & 0x00FF0000FF0000FF;
-            z = (z | (z << 8)) & 0xF00F00F00F00F00F;
-            z = (z | (z << 4)) & 0x30C30C30C30C30C3;
-            z = (z | (z << 2)) & 0x9249249249249249;
-            return x | (y << 1) | (z << 2);
-        }
-    };
-}
@@ -26,7 +26,7 @@ namespace Math {
                 :X(r.X), Y(r.Y), Z(r.Z), T(r.T) { }
         constexpr Vec operator-() const noexcept { return Vec(-X, -Y, -Z, -T); }
         constexpr Vec operator+(const Vec& r) const noexcept { return Vec(X+r.X, Y+r.Y, Z+r.Z, T+r.T); }
-        constexpr Vec operator-(const Vec& r) const noexcept { return Vec(X-r.X, Y-r.Y, Z-r.Z); }
+        constexpr Vec operator-(const Vec& r) const noexcept { return Vec(X-r.X, Y-r.Y, Z-r.Z, T-r.T); }
         template <class U, class = EnableIfNotVectorOrMatrix<U>>
         constexpr Vec operator*(const U& r) const noexcept { return Vec(X*r, Y*r, Z*r, T*r); }
         template <class U>
@@ -64,9 +64,9 @@ namespace Math {
             return *this;
         }
         constexpr V LengthSqr() const noexcept { return X*X+Y*Y+Z*Z+T*T; }
-        constexpr bool operator==(const Vec& r) const noexcept { return (X==r.T) && (Y==r.T) && (Z==r.T) && (T==r.T); }
+        constexpr bool operator==(const Vec& r) const noexcept { return (X==r.X) && (Y==r.Y) && (Z==r.Z) && (T==r.T); }
         constexpr V Dot(const Vec& r) const noexcept { return X*r.X+Y*r.Y+Z*r.Z+T*r.T; }
-        V Length() noexcept { return sqrt(LengthSqr()); }
+        LengthType<V> Length() const noexcept { return std::sqrt(LengthType<V>(LengthSqr())); }
     };
 
     template <class T>
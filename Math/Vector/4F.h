@@ -0,0 +1,106 @@
+#pragma once
+
+#include "4.h"
+#include "../SIMD/Config.h"
+
+#if MATH_SIMD_LEVEL > 0
+namespace Math {
+    template <>
+    union Vec<4, float> {
+        alignas(16) float Data[4];
+        struct {
+            float X, Y, Z, T;
+        };
+        constexpr Vec() noexcept
+                :Data{0.0f, 0.0f, 0.0f, 0.0f} { }
+        constexpr Vec(Vec&&) noexcept = default;
+        constexpr Vec(const Vec&) noexcept = default;
+        Vec& operator=(Vec&&) noexcept = default;
+        Vec& operator=(const Vec&) noexcept = default;
+        constexpr explicit Vec(VectorUninitializedT) noexcept
+                :Data{} { }
+        template <class Q, class W, class ...U>
+        constexpr explicit Vec(Q&& arg0, W&& arg1, U&& ... args) noexcept
+                :Data{static_cast<float>(std::forward<Q>(arg0)), static_cast<float>(std::forward<W>(arg1)),
+                static_cast<float>(std::forward<U>(args))...} { }
+        template <class U, class = std::enable_if_t<std::is_convertible_v<U, float>>>
+        constexpr explicit Vec(const Vec<4, U>& r) noexcept
+                :Data{static_cast<float>(r.Data[0]), static_cast<float>(r.Data[1]),
+                static_cast<float>(r.Data[2]), static_cast<float>(r.Data[3])} { }
+        explicit Vec(__m128 r) noexcept { _mm_store_ps(Data, r); }
+
+        __m128 Load() const noexcept { return _mm_load_ps(Data); }
+        void Store(__m128 r) noexcept { _mm_store_ps(Data, r); }
+
+        constexpr Vec operator-() const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED()) return Vec(-Data[0], -Data[1], -Data[2], -Data[3]);
+            return Vec(_mm_xor_ps(Load(), _mm_set1_ps(-0.0f)));
+        }
+        constexpr Vec operator+(const Vec& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED())
+                return Vec(Data[0]+r.Data[0], Data[1]+r.Data[1], Data[2]+r.Data[2], Data[3]+r.Data[3]);
+            return Vec(_mm_add_ps(Load(), r.Load()));
+        }
+        constexpr Vec operator-(const Vec& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED())
+                return Vec(Data[0]-r.Data[0], Data[1]-r.Data[1], Data[2]-r.Data[2], Data[3]-r.Data[3]);
+            return Vec(_mm_sub_ps(Load(), r.Load()));
+        }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        constexpr Vec operator*(const U& r) const noexcept {
+            const auto s = static_cast<float>(r);
+            if (MATH_IS_CONSTANT_EVALUATED()) return Vec(Data[0]*s, Data[1]*s, Data[2]*s, Data[3]*s);
+            return Vec(_mm_mul_ps(Load(), _mm_set1_ps(s)));
+        }
+        template <class U>
+        constexpr Vec operator/(const U& r) const noexcept {
+            const auto s = static_cast<float>(r);
+            if (MATH_IS_CONSTANT_EVALUATED()) return Vec(Data[0]/s, Data[1]/s, Data[2]/s, Data[3]/s);
+            return Vec(_mm_div_ps(Load(), _mm_set1_ps(s)));
+        }
+        constexpr auto& operator[](size_t index) noexcept { return Data[index]; }
+        constexpr auto& operator[](size_t index) const noexcept { return Data[index]; }
+        Vec& operator+=(const Vec& r) noexcept {
+            Store(_mm_add_ps(Load(), r.Load()));
+            return *this;
+        }
+        Vec& operator-=(const Vec& r) noexcept {
+            Store(_mm_sub_ps(Load(), r.Load()));
+            return *this;
+        }
+        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        Vec& operator*=(const U& r) noexcept {
+            Store(_mm_mul_ps(Load(), _mm_set1_ps(static_cast<float>(r))));
+            return *this;
+        }
+        template <class U>
+        Vec& operator/=(const U& r) noexcept {
+            Store(_mm_div_ps(Load(), _mm_set1_ps(static_cast<float>(r))));
+            return *this;
+        }
+        constexpr float LengthSqr() const noexcept { return Dot(*this); }
+        constexpr bool operator==(const Vec& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED())
+                return (Data[0]==r.Data[0]) && (Data[1]==r.Data[1]) && (Data[2]==r.Data[2]) && (Data[3]==r.Data[3]);
+            return _mm_movemask_ps(_mm_cmpeq_ps(Load(), r.Load()))==0xF;
+        }
+        constexpr float Dot(const Vec& r) const noexcept {
+            if (MATH_IS_CONSTANT_EVALUATED())
+                return Data[0]*r.Data[0]+Data[1]*r.Data[1]+Data[2]*r.Data[2]+Data[3]*r.Data[3];
+            return _mm_cvtss_f32(DotSplat(Load(), r.Load()));
+        }
+        float Length() const noexcept { return std::sqrt(LengthSqr()); }
+
+        // dot product broadcast to all four lanes
+        static __m128 DotSplat(__m128 l, __m128 r) noexcept {
+#if defined(MATH_SIMD_SSE41)
+            return _mm_dp_ps(l, r, 0xFF);
+#else
+            const auto m = _mm_mul_ps(l, r);
+            const auto s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+#endif
+        }
+    };
+}
+#endif
@@ -18,6 +18,10 @@ namespace Math {
     template <class T>
     using EnableIfNotVectorOrMatrix = std::enable_if_t<IsNotVectorOrMatrix<T>::value>;
 
+    // floating-point vectors measure lengths in their own type, integer vectors in double
+    template <class T>
+    using LengthType = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
     struct VectorUninitializedT{};
 
     constexpr VectorUninitializedT VectorUninitialized = {};
@@ -40,7 +40,7 @@ namespace Math {
             for (auto i = 0u; i<D; ++i) ret.Data[i] = Data[i]-r.Data[i];
             return ret;
         }
-        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        template <class U, class = EnableIfNotVectorOrMatrix<std::decay_t<U>>>
         constexpr Vec operator*(U&& r) const noexcept {
             Vec ret{VectorUninitialized};
             for (auto i = 0u; i<D; ++i) ret.Data[i] = Data[i]*r;
@@ -60,14 +60,14 @@ namespace Math {
             for (auto i = 0u; i<D; ++i) Data[i] -= r.Data[i];
             return *this;
         }
-        template <class U, class = EnableIfNotVectorOrMatrix<U>>
+        template <class U, class = EnableIfNotVectorOrMatrix<std::decay_t<U>>>
         Vec& operator*=(U&& r) noexcept {
-            for (auto i = 0u; i<D; ++i) Data[i] *= r.Data[i];
+            for (auto i = 0u; i<D; ++i) Data[i] *= r;
             return *this;
         }
         template <class U>
         Vec& operator/=(U&& r) noexcept {
-            for (auto i = 0u; i<D; ++i) Data[i] /= r.Data[i];
+            for (auto i = 0u; i<D; ++i) Data[i] /= r;
             return *this;
         }
         constexpr T LengthSqr() const noexcept {
@@ -85,6 +85,6 @@ namespace Math {
             for (auto i = 0u; i<D; ++i) ret += Data[i]*r.Data[i];
             return ret;
         }
-        T Length() noexcept { return sqrt(LengthSqr()); }
+        LengthType<T> Length() const noexcept { return std::sqrt(LengthType<T>(LengthSqr())); }
     };
 }
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+#include "Vector.h"
+#include "SIMD.h"
+
+namespace Math {
+    // One cell visited by a voxel traversal. Distance is the ray parameter t at which the ray enters the cell
+    // (0 for the starting cell), so it is a length when the direction is unit. Normal is the unit normal of the face
+    // crossed to enter the cell, pointing back towards the previous cell, or zero for the starting cell.
+    template <class T>
+    struct VoxelStep {
+        Vec3I Cell, Normal;
+        T Distance;
+    };
+
+    // Amanatides-Woo traversal of the unit grid (cell c covers [c, c + 1) on every axis) along origin + t * direction,
+    // visiting cells in order for 0 <= t <= maxDistance. Use as a range or drive it by hand with Valid/Current/Next:
+    //     for (const auto& s : VoxelRay(origin, direction, reach)) if (Solid(s.Cell)) break;
+    // Scale origin and distances by 1 / cellSize for other grids.
+    template <class T>
+    class VoxelRay {
+    public:
+        VoxelRay(const Vec3<T>& origin, const Vec3<T>& direction,
+                 T maxDistance = std::numeric_limits<T>::infinity()) noexcept
+                :_MaxDistance(maxDistance) {
+            constexpr auto inf = std::numeric_limits<T>::infinity();
+            _Current.Distance = T(0);
+            for (auto a = 0; a<3; ++a) {
+                const auto o = origin.Data[a], d = direction.Data[a], cell = std::floor(o);
+                _Current.Cell.Data[a] = int(cell);
+                _Step[a] = d>T(0) ? 1 : (d<T(0) ? -1 : 0);
+                _Delta[a] = _Step[a] ? std::abs(T(1)/d) : inf;
+                _Next[a] = d>T(0) ? (cell+T(1)-o)*_Delta[a] : (d<T(0) ? (o-cell)*_Delta[a] : inf);
+            }
+        }
+
+        // true while the current cell is entered within maxDistance
+        bool Valid() const noexcept {
+            return _Current.Distance<=_MaxDistance && _Current.Distance<std::numeric_limits<T>::infinity();
+        }
+        const VoxelStep<T>& Current() const noexcept { return _Current; }
+        // moves into the next cell along the ray; ties step the lowest axis first
+        void Next() noexcept {
+            const auto axis = _Next[0]<=_Next[1] ? (_Next[0]<=_Next[2] ? 0 : 2) : (_Next[1]<=_Next[2] ? 1 : 2);
+            _Current.Distance = _Next[axis];
+            _Current.Cell.Data[axis] += _Step[axis];
+            _Current.Normal = Vec3I();
+            _Current.Normal.Data[axis] = -_Step[axis];
+            _Next[axis] += _Delta[axis];
+        }
+
+        class Iterator {
+        public:
+            using value_type = VoxelStep<T>;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() noexcept = default;
+            explicit Iterator(VoxelRay* ray) noexcept : _Ray(ray) { }
+            const VoxelStep<T>& operator*() const noexcept { return _Ray->_Current; }
+            const VoxelStep<T>* operator->() const noexcept { return &_Ray->_Current; }
+            Iterator& operator++() noexcept {
+                _Ray->Next();
+                return *this;
+            }
+            void operator++(int) noexcept { _Ray->Next(); }
+            bool operator==(std::default_sentinel_t) const noexcept { return !_Ray->Valid(); }
+        private:
+            VoxelRay* _Ray = nullptr;
+        };
+
+        // single pass: iterating advances the traversal itself
+        Iterator begin() noexcept { return Iterator(this); }
+        std::default_sentinel_t end() const noexcept { return {}; }
+    private:
+        VoxelStep<T> _Current{};
+        T _MaxDistance;
+        T _Next[3], _Delta[3];
+        int _Step[3];
+    };
+
+    // Up to 8 float rays traversed in lockstep: every Next() advances each lane by one cell, choosing the step axis
+    // per lane with compares and masks instead of branches. Cells are kept as exact floats, so coordinates must stay
+    // within +-2^24. Lanes beyond the loaded rays are never active.
+    class VoxelRayPacket8 {
+    public:
+        VoxelRayPacket8(std::span<const Vec3F> origins, std::span<const Vec3F> directions,
+                        float maxDistance = std::numeric_limits<float>::infinity()) noexcept {
+            using SIMD::F32x8;
+            constexpr auto inf = std::numeric_limits<float>::infinity();
+            const auto n = std::min<size_t>(std::min(origins.size(), directions.size()), 8);
+            float cell[3][8]{}, step[3][8]{}, delta[3][8], next[3][8], limit[8];
+            for (auto i = size_t(0); i<8; ++i) {
+                limit[i] = i<n ? maxDistance : -1.0f;
+                for (auto a = 0; a<3; ++a) {
+                    const auto o = i<n ? origins[i].Data[a] : 0.0f, d = i<n ? directions[i].Data[a] : 0.0f;
+                    cell[a][i] = std::floor(o);
+                    step[a][i] = d>0.0f ? 1.0f : (d<0.0f ? -1.0f : 0.0f);
+                    delta[a][i] = d!=0.0f ? std::abs(1.0f/d) : inf;
+                    next[a][i] = d>0.0f ? (cell[a][i]+1.0f-o)*delta[a][i] : (d<0.0f ? (o-cell[a][i])*delta[a][i] : inf);
+                }
+            }
+            for (auto a = 0; a<3; ++a) {
+                _Cell[a] = F32x8::Load(cell[a]);
+                _Step[a] = F32x8::Load(step[a]);
+                _Delta[a] = F32x8::Load(delta[a]);
+                _Next[a] = F32x8::Load(next[a]);
+                _Normal[a] = F32x8::Zero();
+            }
+            _Distance = F32x8::Zero();
+            _Limit = F32x8::Load(limit);
+        }
+
+        // bit i is set while lane i's current cell is entered within maxDistance
+        int Active() const noexcept {
+            const auto inf = SIMD::F32x8::Broadcast(std::numeric_limits<float>::infinity());
+            return ((_Distance<=_Limit) & (_Distance<inf)).Mask();
+        }
+        void Next() noexcept {
+            using SIMD::F32x8;
+            const auto x = (_Next[0]<=_Next[1]) & (_Next[0]<=_Next[2]);
+            const auto y = AndNot(x, _Next[1]<=_Next[2]);
+            const F32x8 pick[3] = {x, y, AndNot(x, _Next[2]<_Next[1])};
+            _Distance = Min(_Next[0], Min(_Next[1], _Next[2]));
+            for (auto a = 0; a<3; ++a) {
+                _Cell[a] = _Cell[a]+(pick[a] & _Step[a]);
+                _Normal[a] = pick[a] & -_Step[a];
+                _Next[a] = _Next[a]+(pick[a] & _Delta[a]);
+            }
+        }
+
+        // current cell, entry normal and distance of every lane
+        void Current(VoxelStep<float> (&out)[8]) const noexcept {
+            float lanes[7][8];
+            for (auto a = 0; a<3; ++a) {
+                _Cell[a].Store(lanes[a]);
+                _Normal[a].Store(lanes[3+a]);
+            }
+            _Distance.Store(lanes[6]);
+            for (auto i = 0; i<8; ++i) {
+                out[i].Cell = Vec3I(int(lanes[0][i]), int(lanes[1][i]), int(lanes[2][i]));
+                out[i].Normal = Vec3I(int(lanes[3][i]), int(lanes[4][i]), int(lanes[5][i]));
+                out[i].Distance = lanes[6][i];
+            }
+        }
+    private:
+        SIMD::F32x8 _Cell[3], _Step[3], _Delta[3], _Next[3], _Normal[3], _Distance, _Limit;
+    };
+}
@@ -0,0 +1,160 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstring>
+#include "Check.h"
+#include "Math/Affine.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(18);
+
+    // small integers keep every product and sum exact, so all kernels must agree bit for bit whatever their
+    // association order or FMA use
+    Affine3F IntegerAffine() {
+        std::uniform_int_distribution<int> d(-8, 8);
+        Mat<float, 3, 4> m;
+        for (auto i = 0; i<3; ++i)
+            for (auto j = 0; j<4; ++j) m[i].Data[j] = float(d(Rng));
+        return Affine3F(m);
+    }
+
+    Affine3F RandomTRS() {
+        std::uniform_real_distribution<float> d(-1.0f, 1.0f), s(0.5f, 2.0f);
+        const Vec3F axis(d(Rng), d(Rng), d(Rng));
+        const auto q = Quat<float>::AxisAngle(axis/axis.Length(), 3.0f*d(Rng));
+        return Affine3F::FromTRS(Vec3F(10.0f*d(Rng), 10.0f*d(Rng), 10.0f*d(Rng)), q, Vec3F(s(Rng), s(Rng), s(Rng)));
+    }
+
+    bool Same(std::span<const Affine3F> a, std::span<const Affine3F> b) {
+        return a.size()==b.size() && !std::memcmp(a.data(), b.data(), a.size_bytes());
+    }
+
+    bool Near(const Affine3F& a, const Affine3F& b, float tolerance) {
+        for (auto i = 0; i<3; ++i)
+            for (auto j = 0; j<4; ++j)
+                if (!(std::abs(a(i, j)-b(i, j))<=tolerance*(1.0f+std::abs(b(i, j))))) return false;
+        return true;
+    }
+
+    bool Near(const Vec3F& a, const Vec3F& b, float tolerance) {
+        for (auto i = 0; i<3; ++i)
+            if (!(std::abs(a.Data[i]-b.Data[i])<=tolerance*(1.0f+std::abs(b.Data[i])))) return false;
+        return true;
+    }
+
+    Affine3D ToDouble(const Affine3F& a) {
+        Affine3D ret;
+        for (auto i = 0; i<3; ++i)
+            for (auto j = 0; j<4; ++j) ret(i, j) = a(i, j);
+        return ret;
+    }
+
+    void CheckKernel(SIMD::ComposeAffineKernel kernel, std::span<const Affine3F> l, std::span<const Affine3F> r) {
+        std::vector<Affine3F> pairwise(l.size()), broadcast(l.size()), pairwiseRef(l.size()), broadcastRef(l.size());
+        for (auto i = size_t(0); i<l.size(); ++i) {
+            pairwiseRef[i] = l[i]*r[i];
+            broadcastRef[i] = l[0]*r[i];
+        }
+        const auto f = [](auto span) { return reinterpret_cast<const float*>(span.data()); };
+        kernel(f(l), 12, f(r), reinterpret_cast<float*>(pairwise.data()), l.size());
+        kernel(f(l), 0, f(r), reinterpret_cast<float*>(broadcast.data()), l.size());
+        MATH_CHECK(Same(pairwise, pairwiseRef));
+        MATH_CHECK(Same(broadcast, broadcastRef));
+    }
+
+    void CheckKernels() {
+        for (const auto n : {size_t(1), size_t(2), size_t(7), size_t(64)}) {
+            std::vector<Affine3F> l(n), r(n);
+            for (auto& m : l) m = IntegerAffine();
+            for (auto& m : r) m = IntegerAffine();
+            CheckKernel(&SIMD::ComposeAffineScalar, l, r);
+#if defined(MATH_SIMD_SSE2)
+            CheckKernel(&SIMD::ComposeAffineSSE, l, r);
+            if (SIMD::CPU().AVX2 && SIMD::CPU().FMA) CheckKernel(&SIMD::ComposeAffineAVX2, l, r);
+#endif
+        }
+    }
+
+    // the public spans: shortest length wins, in-place on either side, broadcast parent reading out's storage
+    void CheckCompose() {
+        std::vector<Affine3F> l(33), r(33);
+        for (auto& m : l) m = IntegerAffine();
+        for (auto& m : r) m = IntegerAffine();
+        std::vector<Affine3F> ref(33);
+        for (auto i = size_t(0); i<ref.size(); ++i) ref[i] = l[i]*r[i];
+
+        const auto sentinel = Affine3F::FromTranslation(Vec3F(123.0f, 0.0f, 0.0f));
+        std::vector<Affine3F> out(34, sentinel);
+        Compose(std::span<const Affine3F>(l), std::span<const Affine3F>(r).first(32), out);
+        MATH_CHECK(Same(std::span<const Affine3F>(out).first(32), std::span<const Affine3F>(ref).first(32)));
+        MATH_CHECK(out[32]==sentinel && out[33]==sentinel);
+
+        auto inL = l;
+        Compose(std::span<const Affine3F>(inL), std::span<const Affine3F>(r), inL);
+        MATH_CHECK(Same(inL, ref));
+        auto inR = r;
+        Compose(std::span<const Affine3F>(l), std::span<const Affine3F>(inR), inR);
+        MATH_CHECK(Same(inR, ref));
+
+        auto children = r;
+        Compose(children[0], std::span<const Affine3F>(children), children);
+        auto mismatches = 0;
+        for (auto i = size_t(0); i<r.size(); ++i) mismatches += !(children[i]==r[0]*r[i]);
+        MATH_CHECK(mismatches==0);
+
+        std::vector<Affine3D> ld(5), rd(5), outd(5);
+        for (auto i = size_t(0); i<ld.size(); ++i) {
+            ld[i] = ToDouble(l[i]);
+            rd[i] = ToDouble(r[i]);
+        }
+        Compose(std::span<const Affine3D>(ld), std::span<const Affine3D>(rd), std::span<Affine3D>(outd));
+        mismatches = 0;
+        for (auto i = size_t(0); i<outd.size(); ++i) mismatches += !(outd[i]==ld[i]*rd[i]);
+        MATH_CHECK(mismatches==0);
+    }
+
+    // the 3x4 product, inverse and point transforms against the Mat4 forms
+    void CheckAlgebra() {
+        auto bad = 0;
+        for (auto i = 0; i<200; ++i) {
+            const auto a = RandomTRS(), b = RandomTRS();
+            bad += !Near(a*b, Affine3F(a.ToMat4()*b.ToMat4()), 1e-5f);
+            bad += !Near(a*a.Inverse(), Affine3F(), 1e-4f);
+            bad += !Near(a.Inverse()*a, Affine3F(), 1e-4f);
+
+            const auto p = Vec3F(float(i%7)-3.0f, float(i%5)-2.0f, float(i%3)-1.0f);
+            const auto m = a.ToMat4();
+            const Vec4F hp = m*Vec4F(p.Data[0], p.Data[1], p.Data[2], 1.0f);
+            bad += !Near(a.TransformPoint(p), Vec3F(hp.Data[0], hp.Data[1], hp.Data[2]), 1e-5f);
+            bad += !Near(a.TransformVector(p), a.TransformPoint(p)-a.Translation(), 1e-4f);
+        }
+        MATH_CHECK(bad==0);
+
+        // FromTRS is T * R * S
+        const auto q = Quat<float>::AxisAngle(Vec3F(0.0f, 0.6f, 0.8f), 0.7f);
+        const Vec3F t(1.0f, -2.0f, 3.0f), s(2.0f, 0.5f, 1.5f);
+        MATH_CHECK(std::abs(Affine3F::FromTRS(t, q, s).Determinant()-1.5f)<1e-5f);
+        MATH_CHECK(Near(Affine3F::FromTRS(t, q, s),
+                        Affine3F::FromTranslation(t)*Affine3F::FromRotation(q)*Affine3F::FromScale(s), 1e-6f));
+
+        std::vector<Vec3F> points(19), batch(19);
+        for (auto i = size_t(0); i<points.size(); ++i) points[i] = Vec3F(float(i), -float(i)/2.0f, 1.0f);
+        const auto a = RandomTRS();
+        TransformPoints(a, points, batch);
+        auto mismatches = 0;
+        for (auto i = size_t(0); i<points.size(); ++i) mismatches += !Near(batch[i], a.TransformPoint(points[i]), 1e-5f);
+        TransformVectors(a, points, batch);
+        for (auto i = size_t(0); i<points.size(); ++i)
+            mismatches += !Near(batch[i], a.TransformVector(points[i]), 1e-5f);
+        MATH_CHECK(mismatches==0);
+    }
+}
+
+int main() {
+    CheckKernels();
+    CheckCompose();
+    CheckAlgebra();
+    return Tests::Finish();
+}
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "Check.h"
+#include "Math/BVH.h"
+
+using namespace Math;
+
+namespace {
+    std::vector<AABBF> RandomBoxes(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-100.0f, 100.0f), extent(0.0f, 3.0f);
+        std::vector<AABBF> ret(count);
+        for (auto& b : ret) {
+            const Vec3F min(pos(rng), pos(rng), pos(rng));
+            b = AABBF(min, min+Vec3F(extent(rng), extent(rng), extent(rng)));
+        }
+        return ret;
+    }
+
+    // every primitive once, children inside their parent, leaf boxes inside their leaf
+    void CheckStructure(const BVH& bvh, std::span<const AABBF> boxes) {
+        const auto nodes = bvh.Nodes();
+        const auto indices = bvh.Indices();
+        std::vector<int> seen(boxes.size());
+        auto bad = 0;
+        for (const auto& node : nodes) {
+            if (node.Leaf()) {
+                for (auto p = node.Offset; p<node.Offset+node.Count; ++p) {
+                    ++seen[indices[p]];
+                    bad += !node.Bounds().Contains(boxes[indices[p]]);
+                }
+                continue;
+            }
+            bad += !node.Bounds().Contains(nodes[node.Offset].Bounds());
+            bad += !node.Bounds().Contains(nodes[node.Offset+1].Bounds());
+        }
+        MATH_CHECK(bad==0);
+        MATH_CHECK(std::all_of(seen.begin(), seen.end(), [](int n) { return n==1; }));
+    }
+
+    // nearest entry distance of the ray into b within [0, tMax], or infinity
+    float Enter(const Vec3F& o, const Vec3F& d, const AABBF& b, float tMax) {
+        auto t0 = 0.0, t1 = double(tMax);
+        for (auto a = 0; a<3; ++a) {
+            if (d.Data[a]==0.0f) {
+                if (o.Data[a]<b.Min.Data[a] || o.Data[a]>b.Max.Data[a]) return INFINITY;
+                continue;
+            }
+            auto n = (double(b.Min.Data[a])-o.Data[a])/d.Data[a], f = (double(b.Max.Data[a])-o.Data[a])/d.Data[a];
+            if (n>f) std::swap(n, f);
+            t0 = std::max(t0, n);
+            t1 = std::min(t1, f);
+        }
+        return t0<=t1 ? float(t0) : INFINITY;
+    }
+
+    void CheckQueries(const BVH& bvh, std::span<const AABBF> boxes, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-110.0f, 110.0f), dir(-1.0f, 1.0f), extent(0.0f, 20.0f);
+        auto overlapMismatches = 0, rayMismatches = 0;
+        for (auto q = 0; q<64; ++q) {
+            const Vec3F min(pos(rng), pos(rng), pos(rng));
+            const AABBF query(min, min+Vec3F(extent(rng), extent(rng), extent(rng)));
+            std::vector<uint32_t> got, want;
+            bvh.ForEachOverlap(query, [&](uint32_t i) { got.push_back(i); });
+            for (auto i = 0u; i<boxes.size(); ++i)
+                if (boxes[i].Overlaps(query)) want.push_back(i);
+            std::sort(got.begin(), got.end());
+            overlapMismatches += got!=want;
+
+            // one ray in four is axis-aligned so the zero-direction lanes are exercised
+            Vec3F d(dir(rng), dir(rng), dir(rng));
+            if (q%4==0) d.Data[q/4%3] = 0.0f;
+            const auto hit = bvh.Raycast(min, d, 500.0f);
+            auto nearest = INFINITY;
+            for (const auto& b : boxes) nearest = std::min(nearest, Enter(min, d, b, 500.0f));
+            rayMismatches += std::isinf(nearest) ? bool(hit) : !(hit && std::abs(hit.T-nearest)<=1e-3f*(1.0f+nearest));
+        }
+        MATH_CHECK(overlapMismatches==0);
+        MATH_CHECK(rayMismatches==0);
+    }
+}
+
+int main() {
+    // below and above the parallel grain
+    for (const auto count : {size_t(1), size_t(5), size_t(1000), size_t(40000)}) {
+        auto boxes = RandomBoxes(count, uint32_t(count));
+        BVH bvh(boxes);
+        CheckStructure(bvh, boxes);
+        CheckQueries(bvh, boxes, 7);
+
+        // the build is deterministic
+        const BVH again(boxes);
+        MATH_CHECK(std::equal(bvh.Indices().begin(), bvh.Indices().end(), again.Indices().begin(), again.Indices().end()));
+
+        // refit after every box moved
+        for (auto& b : boxes) {
+            b.Min += Vec3F(1.5f, -0.5f, 2.0f);
+            b.Max += Vec3F(1.5f, -0.5f, 2.0f);
+        }
+        bvh.Refit(boxes);
+        CheckStructure(bvh, boxes);
+        CheckQueries(bvh, boxes, 8);
+    }
+    MATH_CHECK(!BVH(std::span<const AABBF>()).Raycast(Vec3F(), Vec3F(1, 0, 0)));
+    return Tests::Finish();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal self-contained test support: MATH_CHECK records a failure and keeps going, Finish turns the count into the
+// process exit code.
+namespace Tests {
+    inline int& Failures() noexcept {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline void Fail(const char* expr, const char* file, int line) noexcept {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        ++Failures();
+    }
+
+    inline int Finish() noexcept {
+        if (Failures()) std::fprintf(stderr, "%d check(s) failed\n", Failures());
+        return Failures() ? 1 : 0;
+    }
+}
+
+#define MATH_CHECK(expr) ((expr) ? void(0) : Tests::Fail(#expr, __FILE__, __LINE__))
@@ -0,0 +1,110 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <limits>
+#include "Check.h"
+#include "Math/ChunkCoord.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(23);
+
+    // both signs, small values around chunk edges and the int limits
+    std::vector<Vec3I> RandomCoords(size_t count) {
+        std::uniform_int_distribution<int> any(std::numeric_limits<int>::lowest(), std::numeric_limits<int>::max());
+        std::uniform_int_distribution<int> small(-70, 70);
+        std::vector<Vec3I> ret(count);
+        for (auto i = size_t(0); i<count; ++i)
+            for (auto a = 0; a<3; ++a) {
+                auto& v = ret[i].Data[a];
+                switch ((i+size_t(a))%4) {
+                    case 0: v = any(Rng); break;
+                    case 1: v = small(Rng); break;
+                    case 2: v = i%8<4 ? std::numeric_limits<int>::lowest() : std::numeric_limits<int>::max(); break;
+                    default: v = -1;
+                }
+            }
+        return ret;
+    }
+
+    int* Ints(std::vector<Vec3I>& v) { return reinterpret_cast<int*>(v.data()); }
+    const int* Ints(const std::vector<Vec3I>& v) { return reinterpret_cast<const int*>(v.data()); }
+
+    // the per-vector forms against floor division in 64 bits
+    void CheckScalar() {
+        auto bad = 0;
+        for (const auto& c : RandomCoords(3000))
+            for (const auto s : {0, 1, 4, 17, 30}) {
+                const auto split = SplitChunkLocal(c, s);
+                for (auto a = 0; a<3; ++a) {
+                    const auto v = int64_t(c.Data[a]), size = int64_t(1) << s;
+                    const auto chunk = int64_t(std::floor(double(v)/double(size)));
+                    bad += split.Chunk.Data[a]!=chunk || split.Local.Data[a]!=v-chunk*size;
+                }
+                bad += !(split.Chunk==FloorDivPow2(c, Vec3I(s, s, s))) || !(split.Local==ModPow2(c, Vec3I(s, s, s)));
+            }
+        MATH_CHECK(bad==0);
+        MATH_CHECK(SplitChunkLocal(Vec3I(-1, 16, -17), 4).Chunk==Vec3I(-1, 1, -2));
+        MATH_CHECK(SplitChunkLocal(Vec3I(-1, 16, -17), 4).Local==Vec3I(15, 0, 15));
+    }
+
+    // a kernel against the per-vector form, for per-axis shifts, every tail length, either output alone and
+    // in place on either output
+    void CheckKernel(SIMD::ChunkSplitKernel kernel) {
+        auto bad = 0;
+        for (const auto& shift : {Vec3I(0, 0, 0), Vec3I(4, 4, 4), Vec3I(1, 5, 30), Vec3I(30, 0, 7)})
+            for (auto n = size_t(0); n<=40; n += n<20 ? 1 : 7) {
+                const auto in = RandomCoords(n);
+                std::vector<Vec3I> chunk(n), local(n);
+                kernel(Ints(in), shift, Ints(chunk), Ints(local), n);
+                for (auto i = size_t(0); i<n; ++i) {
+                    const auto split = SplitChunkLocal(in[i], shift);
+                    bad += !(chunk[i]==split.Chunk) || !(local[i]==split.Local);
+                }
+
+                std::vector<Vec3I> only(n), inPlace = in;
+                kernel(Ints(in), shift, Ints(only), nullptr, n);
+                bad += only!=chunk;
+                kernel(Ints(in), shift, nullptr, Ints(only), n);
+                bad += only!=local;
+                kernel(Ints(inPlace), shift, Ints(inPlace), Ints(only), n);
+                bad += inPlace!=chunk || only!=local;
+                inPlace = in;
+                kernel(Ints(inPlace), shift, Ints(only), Ints(inPlace), n);
+                bad += only!=chunk || inPlace!=local;
+            }
+        MATH_CHECK(bad==0);
+    }
+
+    // the public span overloads through the dispatched kernel, with mismatched span lengths
+    void CheckSpans() {
+        const auto in = RandomCoords(101);
+        const Vec3I shift(3, 9, 0);
+        const Vec3I sentinel(12345, 12345, 12345);
+        std::vector<Vec3I> chunk(101, sentinel), local(99, sentinel), out(120, sentinel);
+        SplitChunkLocal(in, shift, chunk, local);
+        auto bad = 0;
+        for (auto i = size_t(0); i<chunk.size(); ++i) {
+            const auto split = SplitChunkLocal(in[i], shift);
+            bad += i<99 ? !(chunk[i]==split.Chunk) || !(local[i]==split.Local) : !(chunk[i]==sentinel);
+        }
+        FloorDivPow2(in, 5, out);
+        for (auto i = size_t(0); i<out.size(); ++i) bad += !(out[i]==(i<in.size() ? FloorDivPow2(in[i], 5) : sentinel));
+        auto inPlace = in;
+        ModPow2(inPlace, shift, inPlace);
+        for (auto i = size_t(0); i<in.size(); ++i) bad += !(inPlace[i]==ModPow2(in[i], shift));
+        MATH_CHECK(bad==0);
+    }
+}
+
+int main() {
+    CheckScalar();
+    CheckKernel(&SIMD::ChunkSplitScalar);
+    CheckKernel(&SIMD::ChunkSplitI32x8);
+#if defined(MATH_SIMD_SSE2)
+    if (SIMD::CPU().AVX2) CheckKernel(&SIMD::ChunkSplitAVX2);
+#endif
+    CheckSpans();
+    return Tests::Finish();
+}
@@ -0,0 +1,133 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstring>
+#include "Check.h"
+#include "Math/Codec.h"
+#include "Math/Matrix.h"
+
+using namespace Math;
+using namespace Math::Codec;
+
+namespace {
+    std::mt19937 Rng(9);
+
+    // Encodes in through output buffers of random sizes, then decodes the bytes fed back in random pieces, carrying
+    // the unread tail of each piece in front of the next as the streaming contract requires
+    template <class V, class E, class D>
+    std::vector<V> RoundTrip(std::span<const V> in, E& encoder, D& decoder) {
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> buffer(4*E::MaxElementSize);
+        for (auto read = size_t(0); read<in.size();) {
+            const auto size = E::MaxElementSize+Rng()%(3*E::MaxElementSize);
+            const auto p = encoder.Encode(in.subspan(read), std::span<uint8_t>(buffer.data(), size));
+            if (!p.Read) break;
+            read += p.Read;
+            bytes.insert(bytes.end(), buffer.begin(), buffer.begin()+std::ptrdiff_t(p.Written));
+        }
+        std::vector<V> out(in.size());
+        std::vector<uint8_t> pending;
+        auto written = size_t(0), fed = size_t(0);
+        while (fed<bytes.size() || !pending.empty()) {
+            const auto piece = std::min(bytes.size()-fed, size_t(1+Rng()%40));
+            pending.insert(pending.end(), bytes.begin()+std::ptrdiff_t(fed), bytes.begin()+std::ptrdiff_t(fed+piece));
+            fed += piece;
+            const auto p = decoder.Decode(pending, std::span<V>(out).subspan(written, std::min<size_t>(out.size()-written, 1+Rng()%7)));
+            written += p.Written;
+            pending.erase(pending.begin(), pending.begin()+std::ptrdiff_t(p.Read));
+            if (fed==bytes.size() && !p.Read) break;
+        }
+        out.resize(written);
+        return out;
+    }
+
+    template <class V>
+    bool SameBits(std::span<const V> a, std::span<const V> b) {
+        return a.size()==b.size() && std::memcmp(a.data(), b.data(), a.size_bytes())==0;
+    }
+
+    void CheckVarint() {
+        uint8_t buffer[MaxVarintSize];
+        auto bad = 0;
+        for (const auto v : {uint64_t(0), uint64_t(127), uint64_t(128), uint64_t(1) << 35u, ~uint64_t(0)}) {
+            const auto n = PutVarint(v, buffer);
+            uint64_t back;
+            bad += n!=VarintSize(v) || GetVarint(buffer, n, back)!=n || back!=v || GetVarint(buffer, n-1, back)!=0;
+        }
+        for (const auto v : {int64_t(0), int64_t(-1), int64_t(1), INT64_MIN, INT64_MAX}) bad += UnZigZag(ZigZag(v))!=v;
+        MATH_CHECK(bad==0);
+    }
+
+    void CheckMortonDelta() {
+        std::vector<Vec3I> points;
+        std::uniform_int_distribution<int> coord(-(1 << 20), (1 << 20)-1), local(-50, 50);
+        for (auto i = 0; i<700; ++i) points.push_back(i%3 ? Vec3I(local(Rng), local(Rng), local(Rng)) : Vec3I(coord(Rng), coord(Rng), coord(Rng)));
+        auto sorted = points;
+        MortonSort(std::span<Vec3I>(sorted));
+        auto ordered = true;
+        for (auto i = size_t(1); i<sorted.size(); ++i) ordered &= Morton::Encode3(sorted[i-1])<=Morton::Encode3(sorted[i]);
+        MATH_CHECK(ordered);
+        for (const auto& input : {points, sorted}) {
+            MortonDeltaEncoder<Vec3I> encoder;
+            MortonDeltaDecoder<Vec3I> decoder;
+            MATH_CHECK(SameBits<Vec3I>(RoundTrip<Vec3I>(input, encoder, decoder), input));
+        }
+        std::vector<Vec2I> flat;
+        for (auto i = 0; i<300; ++i) flat.push_back(Vec2I(int(Rng()), int(Rng())));
+        MortonDeltaEncoder<Vec2I> encoder;
+        MortonDeltaDecoder<Vec2I> decoder;
+        MATH_CHECK(SameBits<Vec2I>(RoundTrip<Vec2I>(flat, encoder, decoder), flat));
+    }
+
+    template <class V>
+    std::vector<V> SmoothSeries(size_t count) {
+        std::vector<V> ret(count);
+        std::normal_distribution<float> noise(0.0f, 0.01f);
+        float state[sizeof(V)/sizeof(float)]{};
+        for (auto& v : ret) {
+            for (auto& s : state) s += noise(Rng);
+            std::memcpy(&v, state, sizeof(V));
+        }
+        return ret;
+    }
+
+    void CheckXorDelta() {
+        // lossless for every bit pattern, NaNs and infinities included
+        auto series = SmoothSeries<Vec3F>(500);
+        series[10] = Vec3F(std::numeric_limits<float>::quiet_NaN(), -0.0f, std::numeric_limits<float>::infinity());
+        XorDeltaEncoder<Vec3F> encoder;
+        XorDeltaDecoder<Vec3F> decoder;
+        MATH_CHECK(SameBits<Vec3F>(RoundTrip<Vec3F>(series, encoder, decoder), series));
+        const auto matrices = SmoothSeries<Mat4F>(100);
+        XorDeltaEncoder<Mat4F> matEncoder;
+        XorDeltaDecoder<Mat4F> matDecoder;
+        MATH_CHECK(SameBits<Mat4F>(RoundTrip<Mat4F>(matrices, matEncoder, matDecoder), matrices));
+    }
+
+    void CheckQuantizedDelta() {
+        const auto series = SmoothSeries<Vec4F>(500);
+        const auto step = 1.0f/1024.0f;
+        QuantizedDeltaEncoder<Vec4F> encoder(step);
+        QuantizedDeltaDecoder<Vec4F> decoder(step);
+        const auto out = RoundTrip<Vec4F>(series, encoder, decoder);
+        MATH_CHECK(out.size()==series.size());
+        auto worst = 0.0f;
+        for (auto i = size_t(0); i<std::min(out.size(), series.size()); ++i)
+            for (auto k = 0; k<4; ++k) worst = std::max(worst, std::abs(out[i].Data[k]-series[i].Data[k]));
+        MATH_CHECK(worst<=step*0.5001f);
+
+        // Reset restarts the stream on both sides
+        encoder.Reset();
+        decoder.Reset();
+        MATH_CHECK(RoundTrip<Vec4F>(std::span<const Vec4F>(series).first(50), encoder, decoder).size()==50);
+    }
+}
+
+int main() {
+    CheckVarint();
+    CheckMortonDelta();
+    CheckXorDelta();
+    CheckQuantizedDelta();
+    return Tests::Finish();
+}
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "Math/Frustum.h"
+
+using namespace Math;
+
+namespace {
+    // OpenGL-style perspective looking down -z from the origin, rotated a little so no plane is axis-aligned
+    FrustumF MakeFrustum() {
+        const auto f = 1.0f/std::tan(0.5f), near = 0.5f, far = 40.0f, c = std::cos(0.3f), s = std::sin(0.3f);
+        Mat4F proj{}, rot = Mat4F::Identity();
+        proj(0, 0) = f/1.5f;
+        proj(1, 1) = f;
+        proj(2, 2) = (far+near)/(near-far);
+        proj(2, 3) = 2.0f*far*near/(near-far);
+        proj(3, 2) = -1.0f;
+        rot(0, 0) = c, rot(0, 2) = s, rot(2, 0) = -s, rot(2, 2) = c;
+        return FrustumF(proj*rot);
+    }
+
+    // Classification of box grown (or shrunk, for negative pad) by pad on every side. A result that changes between
+    // the two is too close to a plane to compare across kernels that round differently.
+    Containment Padded(const FrustumF& f, const AABBF& box, float pad) {
+        return f.Classify(AABBF(box.Min-Vec3F(pad, pad, pad), box.Max+Vec3F(pad, pad, pad)));
+    }
+
+    bool Bit(std::span<const uint64_t> bits, size_t i) noexcept { return bits[i/64] >> i%64 & 1; }
+
+    void CheckCull() {
+        const auto f = MakeFrustum();
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> pos(-45.0f, 45.0f), extent(0.01f, 4.0f);
+        auto mismatches = 0, visibleCount = 0, insideCount = 0;
+        for (const auto count : {size_t(1), size_t(7), size_t(64), size_t(65), size_t(131), size_t(1000)}) {
+            std::vector<AABBF> boxes;
+            std::vector<Vec3F> centers;
+            std::vector<float> radii;
+            for (auto i = size_t(0); i<count; ++i) {
+                const Vec3F min(pos(rng), pos(rng), pos(rng)), e(extent(rng), extent(rng), extent(rng));
+                boxes.push_back(AABBF(min, min+e));
+                centers.push_back(min);
+                radii.push_back(e.X);
+            }
+            // one spare word, preset, to check nothing past the count is written
+            const auto words = (count+63)/64;
+            std::vector<uint64_t> visible(words+1, ~uint64_t(0)), inside(words+1, ~uint64_t(0));
+            Cull(f, boxes, visible, inside);
+            for (auto i = size_t(0); i<count; ++i) {
+                const auto grown = Padded(f, boxes[i], 1e-3f), shrunk = Padded(f, boxes[i], -1e-3f);
+                if (grown!=shrunk) continue;
+                mismatches += Bit(visible, i)!=(grown!=Containment::Outside) || Bit(inside, i)!=(grown==Containment::Inside);
+                visibleCount += Bit(visible, i);
+                insideCount += Bit(inside, i);
+            }
+            for (auto i = count; i<words*64; ++i) mismatches += Bit(visible, i) || Bit(inside, i);
+            mismatches += visible[words]!=~uint64_t(0) || inside[words]!=~uint64_t(0);
+
+            Cull(f, centers, radii, visible, inside);
+            for (auto i = size_t(0); i<count; ++i) {
+                const auto grown = f.Classify(centers[i], radii[i]+1e-3f), shrunk = f.Classify(centers[i], radii[i]-1e-3f);
+                if (grown!=shrunk) continue;
+                mismatches += Bit(visible, i)!=(grown!=Containment::Outside) || Bit(inside, i)!=(grown==Containment::Inside);
+            }
+        }
+        MATH_CHECK(visibleCount>0 && insideCount>0);
+        MATH_CHECK(mismatches==0);
+    }
+
+    // every clearly visible cell once, no clearly outside one, and the inside flag only on cells inside
+    void CheckCells() {
+        const auto f = MakeFrustum();
+        const Vec3I lo(-30, -30, -45), hi(30, 30, 5);
+        const Vec3F cellSize(1.0f, 1.0f, 1.0f);
+        std::vector<int> seen(size_t(60*60*50));
+        auto mismatches = 0;
+        ForEachVisibleCell(f, lo, hi, cellSize, [&](const Vec3I& c, bool inside) {
+            if (c.X<lo.X || c.Y<lo.Y || c.Z<lo.Z || c.X>=hi.X || c.Y>=hi.Y || c.Z>=hi.Z) {
+                ++mismatches;
+                return;
+            }
+            ++seen[size_t(((c.Z-lo.Z)*60+c.Y-lo.Y)*60+c.X-lo.X)];
+            const auto box = AABBF(Vec3F(float(c.X), float(c.Y), float(c.Z)), Vec3F(float(c.X+1), float(c.Y+1), float(c.Z+1)));
+            mismatches += Padded(f, box, 1e-3f)==Containment::Outside;
+            mismatches += inside && Padded(f, box, -1e-3f)!=Containment::Inside;
+        });
+        auto visible = 0;
+        for (auto z = lo.Z; z<hi.Z; ++z)
+            for (auto y = lo.Y; y<hi.Y; ++y)
+                for (auto x = lo.X; x<hi.X; ++x) {
+                    const auto n = seen[size_t(((z-lo.Z)*60+y-lo.Y)*60+x-lo.X)];
+                    const auto box = AABBF(Vec3F(float(x), float(y), float(z)), Vec3F(float(x+1), float(y+1), float(z+1)));
+                    mismatches += n>1 || (n==0 && Padded(f, box, -1e-3f)!=Containment::Outside);
+                    visible += n;
+                }
+        MATH_CHECK(visible>0);
+        MATH_CHECK(mismatches==0);
+
+        // the whole int range: extents overflow int, and only the cells near the frustum may be visited
+        const auto min = std::numeric_limits<int>::lowest(), max = std::numeric_limits<int>::max();
+        auto far = 0, count = 0;
+        ForEachVisibleCell(f, Vec3I(min, min, min), Vec3I(max, max, max), cellSize, [&](const Vec3I& c, bool) {
+            far += std::abs(c.X)>64 || std::abs(c.Y)>64 || std::abs(c.Z)>64;
+            ++count;
+        });
+        MATH_CHECK(count>0);
+        MATH_CHECK(far==0);
+    }
+}
+
+int main() {
+    CheckCull();
+    CheckCells();
+    return Tests::Finish();
+}
@@ -0,0 +1,69 @@
+#include <array>
+#include <memory>
+#include <vector>
+#include "Check.h"
+#include "Math/Matrix.h"
+
+using namespace Math;
+
+namespace {
+    // small integer entries keep every partial sum exact, so any summation order must match the naive loop
+    template <class T>
+    T Entry(size_t i, size_t j, size_t seed) noexcept { return T(int((i*7+j*13+seed*5) % 17)-8); }
+
+    template <class T>
+    void CheckRaw(size_t m, size_t n, size_t k, size_t pad) {
+        const auto lda = k+pad, ldb = n+pad, ldc = n+pad;
+        std::vector<T> a(m*lda), b(k*ldb), c(m*ldc, T(99));
+        for (auto i = size_t(0); i<m; ++i)
+            for (auto p = size_t(0); p<k; ++p) a[i*lda+p] = Entry<T>(i, p, 1);
+        for (auto p = size_t(0); p<k; ++p)
+            for (auto j = size_t(0); j<n; ++j) b[p*ldb+j] = Entry<T>(p, j, 2);
+        Gemm<T>(m, n, k, a.data(), lda, b.data(), ldb, c.data(), ldc);
+        auto mismatches = 0;
+        for (auto i = size_t(0); i<m; ++i) {
+            for (auto j = size_t(0); j<n; ++j) {
+                T expected{};
+                for (auto p = size_t(0); p<k; ++p) expected += a[i*lda+p]*b[p*ldb+j];
+                mismatches += c[i*ldc+j]!=expected;
+            }
+            // padding past n is left alone
+            for (auto j = n; j<ldc; ++j) mismatches += c[i*ldc+j]!=T(99);
+        }
+        MATH_CHECK(mismatches==0);
+    }
+
+    template <class T, int R, int C, int Cr>
+    void CheckMat() {
+        const auto a = std::make_unique<Mat<T, R, C>>(), b = std::make_unique<Mat<T, C, Cr>>();
+        for (auto i = 0; i<R; ++i)
+            for (auto j = 0; j<C; ++j) (*a)(i, j) = Entry<T>(i, j, 3);
+        for (auto i = 0; i<C; ++i)
+            for (auto j = 0; j<Cr; ++j) (*b)(i, j) = Entry<T>(i, j, 4);
+        const auto blocked = std::make_unique<Mat<T, R, Cr>>(Gemm(*a, *b));
+        const auto plain = std::make_unique<Mat<T, R, Cr>>(*a**b);
+        auto mismatches = 0;
+        for (auto i = 0; i<R; ++i)
+            for (auto j = 0; j<Cr; ++j) mismatches += (*blocked)(i, j)!=(*plain)(i, j);
+        MATH_CHECK(mismatches==0);
+    }
+
+    template <class T>
+    void CheckType() {
+        // edge tiles on every side, several KC panels, and one product large enough to go parallel
+        for (const auto [m, n, k] : {std::array<size_t, 3>{1, 1, 1}, {5, 7, 3}, {13, 33, 17}, {73, 70, 300},
+                                     {150, 40, 520}, {0, 4, 4}, {4, 4, 0}})
+            CheckRaw<T>(m, n, k, 0);
+        CheckRaw<T>(37, 29, 41, 3);
+        CheckRaw<T>(256, 256, 256, 0);
+        CheckMat<T, 3, 4, 5>();
+        CheckMat<T, 40, 33, 50>();
+    }
+}
+
+int main() {
+    CheckType<float>();
+    CheckType<double>();
+    CheckType<int>();
+    return Tests::Finish();
+}
@@ -0,0 +1,141 @@
+#include <vector>
+#include <algorithm>
+#include "Check.h"
+#include "Math/Grid3.h"
+
+using namespace Math;
+
+namespace {
+    // every padded cell maps to its own slot below Capacity(), and the per-axis parts sum to the index
+    template <GridLayout L>
+    void CheckIndex(const Vec3I& size, int border) {
+        const GridIndex3<L> index(size, border);
+        const auto padded = index.Padded();
+        std::vector<uint8_t> used(index.Capacity());
+        auto bad = 0;
+        auto cells = size_t(0);
+        for (auto z = padded.Min.Z; z<=padded.Max.Z; ++z)
+            for (auto y = padded.Min.Y; y<=padded.Max.Y; ++y)
+                for (auto x = padded.Min.X; x<=padded.Max.X; ++x) {
+                    const auto i = index(x, y, z);
+                    bad += i>=used.size() || used[i]++;
+                    bad += i!=index(Vec3I(x, y, z)) || i!=index.Axis(0, x)+index.Axis(1, y)+index.Axis(2, z);
+                    ++cells;
+                }
+        MATH_CHECK(bad==0);
+        MATH_CHECK(cells==size_t(size.X+2*border)*size_t(size.Y+2*border)*size_t(size.Z+2*border));
+        // tile padding stays within one tile per axis
+        const auto tile = L==GridLayout::Linear ? 1 : L==GridLayout::Tiled4 ? 4 : 8;
+        MATH_CHECK(index.Capacity()<=size_t(size.X+2*border+tile-1)*size_t(size.Y+2*border+tile-1)*
+                                     size_t(size.Z+2*border+tile-1));
+    }
+
+    template <class G>
+    void Number(G& grid) {
+        grid.ForEach(grid.Padded(), [](const Vec3I& c, int& v) { v = c.X+100*c.Y+10000*c.Z; });
+    }
+
+    // neighbour indices against direct indexing; ForEachNeighbourhood visits exactly the cells whose whole
+    // neighbourhood is stored, in x-fastest order
+    template <class G>
+    void CheckNeighbours(G& grid) {
+        Number(grid);
+        const auto& data = grid.Data();
+        auto bad = 0;
+        const auto inner = grid.Padded().Expand(Vec3I(-1, -1, -1));
+        for (auto z = inner.Min.Z; z<=inner.Max.Z; ++z)
+            for (auto y = inner.Min.Y; y<=inner.Max.Y; ++y)
+                for (auto x = inner.Min.X; x<=inner.Max.X; ++x) {
+                    const Vec3I c(x, y, z);
+                    const auto n = grid.template NeighbourIndices<26>(c);
+                    for (auto i = 0; i<26; ++i) bad += data[n[size_t(i)]]!=grid[c+GridNeighbourOffsets[size_t(i)]];
+                    auto k = 0;
+                    grid.template ForEachNeighbour<6>(c, [&](const Vec3I& d, int& v) {
+                        bad += d!=GridNeighbourOffsets[size_t(k++)] || &v!=&grid[c+d];
+                    });
+                    bad += k!=6;
+                }
+        MATH_CHECK(bad==0);
+
+        // a box reaching past the padded grid is clipped to the cells with all neighbours stored
+        AABBI box(grid.Padded().Min-Vec3I(3, 3, 3), grid.Padded().Max+Vec3I(3, 3, 3));
+        std::vector<Vec3I> visited;
+        grid.template ForEachNeighbourhood<18>(box, [&](const Vec3I& c, size_t i, const std::array<size_t, 18>& n) {
+            visited.push_back(c);
+            bad += i!=grid.Index()(c);
+            for (auto j = 0; j<18; ++j) bad += data[n[size_t(j)]]!=grid[c+GridNeighbourOffsets[size_t(j)]];
+        });
+        MATH_CHECK(bad==0);
+        std::vector<Vec3I> expected;
+        if (!inner.Empty())
+            for (auto z = inner.Min.Z; z<=inner.Max.Z; ++z)
+                for (auto y = inner.Min.Y; y<=inner.Max.Y; ++y)
+                    for (auto x = inner.Min.X; x<=inner.Max.X; ++x) expected.emplace_back(x, y, z);
+        MATH_CHECK(visited==expected);
+    }
+
+    // Fill and Copy clip to the padded grids; Copy between layouts moves the same cells
+    template <GridLayout A, GridLayout B>
+    void CheckCopy() {
+        DynamicGrid3<int, A, 1> src(Vec3I(13, 7, 9));
+        DynamicGrid3<int, B, 2> dst(Vec3I(10, 11, 5), -1);
+        Number(src);
+        const AABBI srcBox(Vec3I(-1, 2, 0), Vec3I(12, 6, 9));
+        const Vec3I dstMin(3, -4, 1);
+        dst.Copy(src, srcBox, dstMin);
+        auto bad = 0;
+        dst.ForEach(dst.Padded(), [&](const Vec3I& c, int& v) {
+            const auto s = c-(dstMin-srcBox.Min);
+            const auto inside = srcBox.Contains(s) && src.Padded().Contains(s);
+            bad += v!=(inside ? src[s] : -1);
+        });
+        MATH_CHECK(bad==0);
+
+        dst.Fill(AABBI(Vec3I(-10, 0, 0), Vec3I(3, 0, 100)), 7);
+        bad = 0;
+        dst.ForEach(dst.Padded(), [&](const Vec3I& c, int& v) {
+            bad += (c.X<=3 && c.Y==0 && c.Z>=0)!=(v==7);
+        });
+        MATH_CHECK(bad==0);
+    }
+
+    template <GridLayout L>
+    void CheckLayout() {
+        for (const auto border : {0, 1, 2})
+            for (const auto& size : {Vec3I(1, 1, 1), Vec3I(16, 16, 16), Vec3I(13, 7, 9), Vec3I(30, 2, 5),
+                                     Vec3I(0, 4, 4)})
+                CheckIndex<L>(size, border);
+
+        DynamicGrid3<int, L> grid(Vec3I(13, 7, 9));
+        CheckNeighbours(grid);
+        grid.Resize(Vec3I(6, 17, 4));
+        CheckNeighbours(grid);
+        DynamicGrid3<int, L, 2> wide(Vec3I(5, 5, 5));
+        CheckNeighbours(wide);
+
+        // default template arguments, including the border, for every layout
+        using Fixed = Grid3<int, 12, 5, 8, L>;
+        static Fixed fixed;
+        MATH_CHECK(fixed.Padded()==AABBI(Vec3I(-1, -1, -1), Vec3I(12, 5, 8)));
+        MATH_CHECK(fixed.Data().size()==Fixed::Index().Capacity());
+        CheckNeighbours(fixed);
+    }
+}
+
+int main() {
+    CheckLayout<GridLayout::Linear>();
+    CheckLayout<GridLayout::Tiled4>();
+    CheckLayout<GridLayout::Morton>();
+    CheckCopy<GridLayout::Linear, GridLayout::Linear>();
+    CheckCopy<GridLayout::Linear, GridLayout::Morton>();
+    CheckCopy<GridLayout::Morton, GridLayout::Tiled4>();
+
+    // Morton tiles: 8 cells where the padded extents fill them, 4 where 8 would store more
+    MATH_CHECK(GridIndex3<GridLayout::Morton>(Vec3I(30, 30, 30), 1).Capacity()==32*32*32);
+    MATH_CHECK(GridIndex3<GridLayout::Morton>(Vec3I(16, 16, 16), 1).Capacity()==20*20*20);
+    MATH_CHECK(GridIndex3<GridLayout::Morton>(Vec3I(16, 16, 16), 0).Capacity()==16*16*16);
+    // within a tile neighbouring cells are near in storage
+    const GridIndex3<GridLayout::Morton> morton(Vec3I(32, 32, 32), 0);
+    MATH_CHECK(morton(1, 1, 1)==7 && morton(7, 7, 7)==511 && morton(8, 0, 0)==512);
+    return Tests::Finish();
+}
@@ -0,0 +1,98 @@
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include "Check.h"
+#include "Math/Packed.h"
+#include "Math/MappedArray.h"
+
+using namespace Math;
+
+namespace {
+    const auto Dir = std::filesystem::temp_directory_path()/"MathMappedArrayTest";
+
+    std::vector<uint8_t> ReadBytes(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+    void WriteBytes(const std::filesystem::path& path, const std::vector<uint8_t>& bytes) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+
+    template <class E>
+    MappedArrayError OpenError(const std::filesystem::path& path) {
+        auto error = MappedArrayError::None;
+        const auto array = MappedArray<E>::Open(path, &error);
+        MATH_CHECK(!array==(error!=MappedArrayError::None));
+        return error;
+    }
+
+    template <class E>
+    void CheckRoundTrip(const std::vector<E>& data, const char* name) {
+        const auto path = Dir/name;
+        MATH_CHECK(MappedArray<E>::Write(path, data));
+        const auto array = MappedArray<E>::Open(path);
+        MATH_CHECK(array && array->Size()==data.size());
+        if (array && array->Size()==data.size())
+            MATH_CHECK(std::memcmp(array->Data().data(), data.data(), data.size()*sizeof(E))==0);
+    }
+
+    void CheckRoundTrips() {
+        CheckRoundTrip<float>({1.0f, -2.5f, 3.0f}, "float.bin");
+        CheckRoundTrip<int>({1, -2, 3, 4}, "int.bin");
+        CheckRoundTrip<Vec3F>({Vec3F(1, 2, 3), Vec3F(4, 5, 6)}, "vec3f.bin");
+        CheckRoundTrip<Mat4F>({Mat4F::Identity(), Mat4F::Identity()*2.0f}, "mat4f.bin");
+        CheckRoundTrip<Vec3H>({Vec3H(Half(1.0f), Half(-2.0f), Half(0.5f))}, "vec3h.bin");
+        CheckRoundTrip<Vec4UN8>({Vec4UN8(UNorm8(0.0f), UNorm8(0.5f), UNorm8(1.0f), UNorm8(0.25f))}, "vec4un8.bin");
+        CheckRoundTrip<Vec3F>({}, "empty-array.bin");
+    }
+
+    void CheckRejections() {
+        const auto vec3f = Dir/"vec3f.bin";
+        MATH_CHECK(OpenError<Vec4F>(vec3f)==MappedArrayError::Type);
+        MATH_CHECK(OpenError<Vec3I>(vec3f)==MappedArrayError::Type);
+        MATH_CHECK((OpenError<Mat<float, 3, 1>>(vec3f)==MappedArrayError::Type));
+        // same size and lane count, different scalar kinds
+        MATH_CHECK(OpenError<Vec3<uint16_t>>(Dir/"vec3h.bin")==MappedArrayError::Type);
+        MATH_CHECK(OpenError<Vec3SN16>(Dir/"vec3h.bin")==MappedArrayError::Type);
+        MATH_CHECK(OpenError<Vec4<uint8_t>>(Dir/"vec4un8.bin")==MappedArrayError::Type);
+
+        MATH_CHECK(OpenError<Vec3F>(Dir/"missing.bin")==MappedArrayError::Open);
+        WriteBytes(Dir/"zero.bin", {});
+        MATH_CHECK(OpenError<Vec3F>(Dir/"zero.bin")==MappedArrayError::Truncated);
+
+        const auto good = ReadBytes(vec3f);
+        auto bytes = good;
+        bytes.resize(40);
+        WriteBytes(Dir/"bad.bin", bytes);
+        MATH_CHECK(OpenError<Vec3F>(Dir/"bad.bin")==MappedArrayError::Truncated);
+        bytes = good;
+        bytes.pop_back();
+        WriteBytes(Dir/"bad.bin", bytes);
+        MATH_CHECK(OpenError<Vec3F>(Dir/"bad.bin")==MappedArrayError::Truncated);
+
+        const auto patch = [&](size_t offset, auto value, MappedArrayError expected) {
+            auto copy = good;
+            std::memcpy(copy.data()+offset, &value, sizeof(value));
+            WriteBytes(Dir/"bad.bin", copy);
+            MATH_CHECK(OpenError<Vec3F>(Dir/"bad.bin")==expected);
+        };
+        patch(offsetof(MappedArrayHeader, Magic), char('X'), MappedArrayError::Magic);
+        patch(offsetof(MappedArrayHeader, Version), uint16_t(MappedArrayHeader::CurrentVersion+1), MappedArrayError::Version);
+        patch(offsetof(MappedArrayHeader, Endian), uint8_t(MappedArrayHeader::NativeEndian==MappedArrayHeader::Little
+                ? MappedArrayHeader::Big : MappedArrayHeader::Little), MappedArrayError::Endian);
+        patch(offsetof(MappedArrayHeader, Alignment), uint16_t(alignof(Vec3F)*2), MappedArrayError::Type);
+        patch(offsetof(MappedArrayHeader, Count), uint64_t(3), MappedArrayError::Truncated);
+        patch(offsetof(MappedArrayHeader, DataOffset), uint64_t(8), MappedArrayError::Truncated);
+    }
+}
+
+int main() {
+    std::filesystem::create_directories(Dir);
+    CheckRoundTrips();
+    CheckRejections();
+    std::filesystem::remove_all(Dir);
+    return Tests::Finish();
+}
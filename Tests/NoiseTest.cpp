@@ -0,0 +1,121 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include "Check.h"
+#include "Math/Noise.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(24);
+
+    uint32_t Bits(float v) {
+        uint32_t ret;
+        std::memcpy(&ret, &v, sizeof(ret));
+        return ret;
+    }
+
+    template <class V>
+    std::vector<V> RandomPoints(size_t count, float extent) {
+        std::uniform_real_distribution<float> d(-extent, extent);
+        std::vector<V> ret(count);
+        for (auto& p : ret)
+            for (auto& c : p.Data) c = d(Rng);
+        return ret;
+    }
+
+    // the span forms take the eight-wide path and must match the single-point forms bit for bit, tails included
+    template <class V>
+    void CheckPoints(const Noise::Fractal& fractal) {
+        for (const auto count : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(13), size_t(3000)}) {
+            const auto points = RandomPoints<V>(count, 300.0f);
+            std::vector<float> fbm(count+1, -7.0f), perlin(count);
+            Noise::Fbm(std::span<const V>(points), 5, fractal, fbm);
+            Noise::Perlin(std::span<const V>(points), 9, perlin);
+            auto mismatches = 0;
+            for (auto i = size_t(0); i<count; ++i) {
+                mismatches += Bits(fbm[i])!=Bits(Noise::Fbm(points[i], 5, fractal));
+                mismatches += Bits(perlin[i])!=Bits(Noise::Perlin(points[i], 9));
+            }
+            MATH_CHECK(mismatches==0);
+            MATH_CHECK(fbm[count]==-7.0f);
+        }
+    }
+
+    // grid samples against Fbm at (origin + c) * frequency
+    void CheckGrids(const Noise::Fractal& fractal) {
+        const Vec2I origin2(-37, 12), size2(29, 11);
+        std::vector<float> out2(size_t(size2.X*size2.Y));
+        Noise::Fbm(origin2, size2, 0.173f, 3, fractal, out2);
+        auto mismatches = 0;
+        for (auto y = 0; y<size2.Y; ++y)
+            for (auto x = 0; x<size2.X; ++x) {
+                const auto p = Vec2F(float(origin2.X+x), float(origin2.Y+y))*0.173f;
+                mismatches += Bits(out2[size_t(y*size2.X+x)])!=Bits(Noise::Fbm(p, 3, fractal));
+            }
+
+        const Vec3I origin3(5, -9, -100), size3(17, 6, 5);
+        std::vector<float> out3(size_t(size3.X*size3.Y*size3.Z));
+        Noise::Fbm(origin3, size3, 0.05f, 8, fractal, out3);
+        for (auto z = 0; z<size3.Z; ++z)
+            for (auto y = 0; y<size3.Y; ++y)
+                for (auto x = 0; x<size3.X; ++x) {
+                    const auto p = Vec3F(float(origin3.X+x), float(origin3.Y+y), float(origin3.Z+z))*0.05f;
+                    mismatches += Bits(out3[size_t((z*size3.Y+y)*size3.X+x)])!=Bits(Noise::Fbm(p, 8, fractal));
+                }
+        MATH_CHECK(mismatches==0);
+
+        // a short output stops mid-row and leaves the rest alone
+        std::vector<float> partial(40, -7.0f);
+        Noise::Fbm(origin3, size3, 0.05f, 8, fractal, std::span<float>(partial).first(39));
+        mismatches = 0;
+        for (auto i = size_t(0); i<39; ++i) mismatches += Bits(partial[i])!=Bits(out3[i]);
+        MATH_CHECK(mismatches==0);
+        MATH_CHECK(partial[39]==-7.0f);
+        Noise::Fbm(origin3, Vec3I(0, 6, 5), 0.05f, 8, fractal, partial);
+        MATH_CHECK(partial[0]==out3[0]);
+    }
+
+    // lattice corners have zero noise, values stay in about [-1, 1], seeds decorrelate, and the noise is continuous
+    void CheckShape() {
+        auto bad = 0;
+        for (auto i = -20; i<=20; ++i) {
+            bad += Noise::Perlin(Vec2F(float(i), float(3*i)), 1)!=0.0f;
+            bad += Noise::Perlin(Vec3F(float(i), float(-i), 7.0f), 1)!=0.0f;
+        }
+        MATH_CHECK(bad==0);
+
+        auto min = 0.0f, max = 0.0f, maxStep = 0.0f;
+        auto differs = 0;
+        for (const auto& p : RandomPoints<Vec3F>(20000, 1000.0f)) {
+            const auto v = Noise::Perlin(p, 0);
+            min = std::min(min, v);
+            max = std::max(max, v);
+            differs += v!=Noise::Perlin(p, 1);
+            maxStep = std::max(maxStep, std::abs(v-Noise::Perlin(p+Vec3F(1e-3f, 0.0f, 0.0f), 0)));
+        }
+        MATH_CHECK(min>=-1.1f && max<=1.1f && min<-0.6f && max>0.6f);
+        MATH_CHECK(differs>19000);
+        MATH_CHECK(maxStep<0.01f);
+    }
+
+    // fixed values guard the claim that every build produces the same bits
+    void CheckGolden() {
+        MATH_CHECK(Bits(Noise::Perlin(Vec2F(0.5f, 0.25f), 0))==0x3ea21800u);
+        MATH_CHECK(Bits(Noise::Perlin(Vec3F(-3.3f, 10.7f, 0.125f), 42))==0xbde1e8f8u);
+        MATH_CHECK(Bits(Noise::Fbm(Vec3F(123.456f, -78.9f, 0.001f), 7))==0xbd06f9c1u);
+    }
+}
+
+int main() {
+    for (const auto& fractal : {Noise::Fractal{1}, Noise::Fractal{}, Noise::Fractal{6, 1.9f, 0.6f}}) {
+        CheckPoints<Vec2F>(fractal);
+        CheckPoints<Vec3F>(fractal);
+        CheckGrids(fractal);
+    }
+    CheckShape();
+    CheckGolden();
+    return Tests::Finish();
+}
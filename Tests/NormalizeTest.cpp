@@ -0,0 +1,57 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstring>
+#include "Check.h"
+#include "Math/Normalize.h"
+
+using namespace Math;
+
+namespace {
+    constexpr auto Inf = std::numeric_limits<float>::infinity();
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+    template <size_t D>
+    std::vector<Vec<D, float>> Inputs() {
+        // degenerate lanes mixed with ordinary ones, more than one register's worth and a scalar tail
+        const float special[] = {0.0f, -0.0f, Inf, -Inf, NaN, 1e-30f, 1e30f, 3.0f, -0.25f, 1.0f};
+        std::vector<Vec<D, float>> ret;
+        for (auto i = 0u; i<61; ++i) {
+            Vec<D, float> v{VectorUninitialized};
+            for (auto d = 0u; d<D; ++d) v.Data[d] = special[(i*(d+3)+d) % std::size(special)];
+            ret.push_back(v);
+        }
+        return ret;
+    }
+
+    template <size_t D, Precision P>
+    void CheckSafe(float tolerance) {
+        const auto in = Inputs<D>();
+        std::vector<Vec<D, float>> out(in.size());
+        NormalizeSafe<P>(std::span<const Vec<D, float>>(in), out);
+        auto degenerate = 0, mismatches = 0;
+        for (auto i = size_t(0); i<in.size(); ++i) {
+            const auto expected = NormalizeSafe<P>(in[i]);
+            const auto len = in[i].LengthSqr();
+            if (!(len>=std::numeric_limits<float>::min() && len<=std::numeric_limits<float>::max())) {
+                ++degenerate;
+                mismatches += std::memcmp(out[i].Data, expected.Data, sizeof(expected.Data))!=0;
+            }
+            else
+                for (auto d = 0u; d<D; ++d)
+                    mismatches += !(std::abs(out[i].Data[d]-expected.Data[d])<=tolerance);
+        }
+        MATH_CHECK(degenerate>0);
+        MATH_CHECK(mismatches==0);
+    }
+}
+
+int main() {
+    CheckSafe<3, Precision::Exact>(1e-6f);
+    CheckSafe<3, Precision::Newton>(1e-5f);
+    CheckSafe<3, Precision::Estimate>(1e-3f);
+    CheckSafe<4, Precision::Exact>(1e-6f);
+    CheckSafe<4, Precision::Newton>(1e-5f);
+    CheckSafe<4, Precision::Estimate>(1e-3f);
+    return Tests::Finish();
+}
@@ -0,0 +1,48 @@
+#include <vector>
+#include <cstring>
+#include "Check.h"
+#include "Math/Packed.h"
+
+using namespace Math;
+
+namespace {
+    bool SameBits(const Vec3F& a, const Vec3F& b) noexcept { return !std::memcmp(a.Data, b.Data, sizeof(a.Data)); }
+
+    // the span form picks the AVX2 kernel where available; it must match the scalar form bit for bit
+    template <int Bits>
+    void CheckOctahedral(const std::vector<OctahedralStorage<Bits>>& packed) {
+        std::vector<Vec3F> batch(packed.size());
+        UnpackOctahedral<Bits>(std::span<const OctahedralStorage<Bits>>(packed), batch);
+        auto mismatches = 0;
+        for (auto i = size_t(0); i<packed.size(); ++i) mismatches += !SameBits(batch[i], UnpackOctahedral<Bits>(packed[i]));
+        MATH_CHECK(mismatches==0);
+
+        std::vector<OctahedralStorage<Bits>> repacked(batch.size());
+        PackOctahedral<Bits>(std::span<const Vec3F>(batch), repacked);
+        mismatches = 0;
+        for (auto i = size_t(0); i<batch.size(); ++i) mismatches += repacked[i]!=PackOctahedral<Bits>(batch[i]);
+        MATH_CHECK(mismatches==0);
+
+#if defined(MATH_SIMD_SSE2)
+        if (SIMD::CPU().AVX2 && SIMD::CPU().FMA) {
+            std::vector<float> avx(packed.size()*3), scalar(packed.size()*3);
+            SIMD::UnpackOctahedralAVX2<Bits>(packed.data(), avx.data(), packed.size());
+            SIMD::UnpackOctahedralScalar<Bits>(packed.data(), scalar.data(), packed.size());
+            MATH_CHECK(!std::memcmp(avx.data(), scalar.data(), avx.size()*sizeof(float)));
+        }
+#endif
+    }
+}
+
+int main() {
+    // every 8-bit code
+    std::vector<uint16_t> p8(1 << 16);
+    for (auto i = size_t(0); i<p8.size(); ++i) p8[i] = uint16_t(i);
+    CheckOctahedral<8>(p8);
+
+    // a strided sweep over the 16-bit codes, which covers both signs and the folded half
+    std::vector<uint32_t> p16;
+    for (auto i = uint64_t(0); i<(uint64_t(1) << 32u); i += 4099) p16.push_back(uint32_t(i));
+    CheckOctahedral<16>(p16);
+    return Tests::Finish();
+}
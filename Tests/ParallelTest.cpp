@@ -0,0 +1,46 @@
+#include <atomic>
+#include "Check.h"
+#include "Math/Parallel.h"
+
+using namespace Math;
+
+int main() {
+    // a loop body that starts another loop on the same pool runs it inline
+    {
+        Parallel::ThreadPool pool(3);
+        std::atomic<size_t> sum{0};
+        pool.For(16, [&](size_t i) {
+            pool.For(100, [&](size_t j) { sum += i*100+j; });
+        });
+        MATH_CHECK(sum==1600*1599/2);
+    }
+    // nesting across pools, back into the outer one
+    {
+        Parallel::ThreadPool a(2), b(2);
+        std::atomic<size_t> count{0};
+        a.For(8, [&](size_t) {
+            b.For(8, [&](size_t) {
+                a.For(8, [&](size_t) { ++count; });
+            });
+        });
+        MATH_CHECK(count==8*8*8);
+    }
+    // the range helper on the default pool, nested in itself
+    {
+        std::atomic<size_t> count{0};
+        Parallel::For(0, 1000, 10, [&](size_t b, size_t e) {
+            for (auto i = b; i<e; ++i) Parallel::For(0, 10, 1, [&](size_t b2, size_t e2) { count += e2-b2; });
+        });
+        MATH_CHECK(count==10000);
+    }
+    // a pool stays usable after nested loops
+    {
+        Parallel::ThreadPool pool(3);
+        for (auto round = 0; round<100; ++round) {
+            std::atomic<size_t> count{0};
+            pool.For(64, [&](size_t) { pool.For(4, [&](size_t) { ++count; }); });
+            MATH_CHECK(count==256);
+        }
+    }
+    return Tests::Finish();
+}
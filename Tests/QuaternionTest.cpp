@@ -0,0 +1,42 @@
+#include <cmath>
+#include <vector>
+#include "Check.h"
+#include "Math/Quaternion.h"
+
+using namespace Math;
+
+namespace {
+    // b is a rotated in the plane of a and an orthogonal unit quaternion, so dot(a, b) = cos(phi) sweeps [-1, 1]
+    void CheckSlerp() {
+        const QuatF axis[2] = {QuatF(Vec4F(0.5f, -0.5f, 0.5f, 0.5f)), QuatF(Vec4F(0.5f, 0.5f, -0.5f, 0.5f))};
+        std::vector<QuatF> a, b;
+        for (auto k = 0; k<=256; ++k) {
+            const auto phi = 3.14159265358979*k/256.0;
+            a.push_back(axis[0]);
+            b.push_back(QuatF(axis[0].AsVec()*float(std::cos(phi))+axis[1].AsVec()*float(std::sin(phi))));
+        }
+        std::vector<QuatF> out(a.size());
+        auto worst = 0.0;
+        for (auto step = 0; step<=64; ++step) {
+            const auto t = float(step)/64.0f;
+            Slerp(std::span<const QuatF>(a), b, t, out);
+            for (auto i = size_t(0); i<a.size(); ++i) {
+                // reference in double with std::sin along the shorter arc
+                const auto pa = a[i].AsVec(), pb = b[i].AsVec();
+                auto d = 0.0;
+                for (auto c = 0; c<4; ++c) d += double(pa.Data[c])*pb.Data[c];
+                const auto sign = d<0.0 ? -1.0 : 1.0;
+                const auto theta = std::acos(std::min(1.0, std::abs(d))), s = std::sin(theta);
+                const auto ca = s>1e-9 ? std::sin((1.0-t)*theta)/s : 1.0-t, cb = s>1e-9 ? std::sin(t*theta)/s : t;
+                for (auto c = 0; c<4; ++c)
+                    worst = std::max(worst, std::abs(out[i].AsVec().Data[c]-(pa.Data[c]*ca+sign*pb.Data[c]*cb)));
+            }
+        }
+        MATH_CHECK(worst<2e-6);
+    }
+}
+
+int main() {
+    CheckSlerp();
+    return Tests::Finish();
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "Math/Ray.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(11);
+
+    Vec3F RandomVec(float lo, float hi) {
+        std::uniform_real_distribution<float> d(lo, hi);
+        return Vec3F(d(Rng), d(Rng), d(Rng));
+    }
+
+    // one ray in four has a zero direction component, so the SafeInverse lanes are exercised
+    RayF RandomRay(int i) {
+        auto d = RandomVec(-1.0f, 1.0f);
+        if (i%4==0) d.Data[i/4%3] = 0.0f;
+        return RayF(RandomVec(-4.0f, 4.0f), d);
+    }
+
+    AABBF RandomBox() {
+        const auto min = RandomVec(-3.0f, 3.0f);
+        return AABBF(min, min+RandomVec(0.0f, 2.0f));
+    }
+
+    float Lane(SIMD::F32x8 v, int lane) {
+        float out[8];
+        v.Store(out);
+        return out[lane];
+    }
+
+    // the slab tests do the same operations in the same order, so the 8-wide forms match the scalar one exactly
+    void CheckBoxes() {
+        auto mismatches = 0, hits = 0;
+        for (auto round = 0; round<200; ++round) {
+            std::vector<RayF> rays;
+            for (auto i = 0; i<8; ++i) rays.push_back(RandomRay(round*8+i));
+            // a short packet leaves lanes unused
+            const auto used = round%5==0 ? 5 : 8;
+            const auto packet = RayPacket8::Load(std::span<const RayF>(rays).first(used), 0.0f, 6.0f);
+            const auto box = RandomBox();
+            SIMD::F32x8 tEnter;
+            const auto mask = IntersectBox(packet, box, tEnter);
+            for (auto i = 0; i<8; ++i) {
+                float t;
+                const auto hit = i<used && IntersectBox(rays[i], SafeInverse(rays[i].Direction), box, 0.0f, 6.0f, t);
+                hits += hit;
+                mismatches += hit!=bool(mask >> i & 1) || (hit && t!=Lane(tEnter, i));
+            }
+
+            std::vector<AABBF> boxes;
+            for (auto i = 0; i<used; ++i) boxes.push_back(RandomBox());
+            const auto& ray = rays[0];
+            const auto inv = SafeInverse(ray.Direction);
+            const auto boxMask = IntersectBoxes(ray, inv, BoxPacket8::Load(boxes), 0.0f, 6.0f, tEnter);
+            for (auto i = 0; i<8; ++i) {
+                float t;
+                const auto hit = i<used && IntersectBox(ray, inv, boxes[i], 0.0f, 6.0f, t);
+                mismatches += hit!=bool(boxMask >> i & 1) || (hit && t!=Lane(tEnter, i));
+            }
+        }
+        MATH_CHECK(hits>0);
+        MATH_CHECK(mismatches==0);
+    }
+
+    // the triangle kernels may fuse multiply-adds, so results agree to rounding and hits only differ on edges
+    void CheckTriangles() {
+        auto mismatches = 0, hits = 0;
+        for (auto round = 0; round<200; ++round) {
+            std::vector<Vec3F> tris;
+            for (auto i = 0; i<24; ++i) tris.push_back(RandomVec(-3.0f, 3.0f));
+            std::vector<RayF> rays;
+            // aimed near the centroids so a good share of the tests hit
+            for (auto i = 0; i<8; ++i) {
+                const auto origin = RandomVec(-4.0f, 4.0f);
+                const auto target = (tris[i*3]+tris[i*3+1]+tris[i*3+2])/3.0f+RandomVec(-0.5f, 0.5f);
+                rays.push_back(RayF(origin, target-origin));
+            }
+            // the packet form, eight rays against the first triangle
+            SIMD::F32x8 t8, u8, v8;
+            const auto rayMask = IntersectTriangle(RayPacket8::Load(rays, 0.0f, 10.0f), tris[0], tris[1], tris[2], t8, u8, v8);
+            for (auto i = 0; i<8; ++i) {
+                float t, u, v;
+                const auto hit = IntersectTriangle(rays[i], tris[0], tris[1], tris[2], 0.0f, 10.0f, t, u, v);
+                const auto edge = std::min({std::abs(u), std::abs(v), std::abs(1.0f-u-v)})<1e-4f;
+                if (hit!=bool(rayMask >> i & 1)) mismatches += !edge;
+                else if (hit) mismatches += !(std::abs(t-Lane(t8, i))<=1e-4f*(1.0f+t));
+            }
+            // one ray against all eight triangles
+            const auto& ray = rays[round%8];
+            const auto triMask = IntersectTriangles(ray, TrianglePacket8::Load(tris), 0.0f, 10.0f, t8, u8, v8);
+            for (auto i = 0; i<8; ++i) {
+                float t, u, v;
+                const auto hit = IntersectTriangle(ray, tris[i*3], tris[i*3+1], tris[i*3+2], 0.0f, 10.0f, t, u, v);
+                hits += hit;
+                const auto edge = std::min({std::abs(u), std::abs(v), std::abs(1.0f-u-v)})<1e-4f;
+                if (hit!=bool(triMask >> i & 1)) mismatches += !edge;
+                else if (hit) mismatches += !(std::abs(t-Lane(t8, i))<=1e-4f*(1.0f+t) && std::abs(u-Lane(u8, i))<=1e-4f);
+            }
+        }
+        MATH_CHECK(hits>0);
+        MATH_CHECK(mismatches==0);
+    }
+
+    void CheckRaycast() {
+        std::vector<Vec3F> tris;
+        for (auto i = 0; i<3*37; ++i) tris.push_back(RandomVec(-3.0f, 3.0f));
+        auto mismatches = 0;
+        for (auto r = 0; r<300; ++r) {
+            const RayF ray(RandomVec(-4.0f, 4.0f), RandomVec(-1.0f, 1.0f));
+            const auto hit = Raycast(ray, tris);
+            auto nearest = std::numeric_limits<float>::infinity();
+            for (auto i = size_t(0); i<tris.size(); i += 3) {
+                float t, u, v;
+                if (IntersectTriangle(ray, tris[i], tris[i+1], tris[i+2], 0.0f, nearest, t, u, v)) nearest = t;
+            }
+            mismatches += std::isinf(nearest) ? bool(hit) : !(hit && std::abs(hit.T-nearest)<=1e-4f*(1.0f+nearest));
+        }
+        MATH_CHECK(mismatches==0);
+    }
+}
+
+int main() {
+    CheckBoxes();
+    CheckTriangles();
+    CheckRaycast();
+    return Tests::Finish();
+}
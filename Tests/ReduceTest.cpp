@@ -0,0 +1,149 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "Check.h"
+#include "Math/Reduce.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(25);
+
+    // integer-valued coordinates keep every moment sum exact, so the kernels must agree exactly; offset moves the
+    // cloud far from the origin
+    template <class T>
+    std::vector<Vec3<T>> RandomPoints(size_t count, bool integer, double offset = 0.0) {
+        std::uniform_int_distribution<int> i(-1000, 1000);
+        std::uniform_real_distribution<double> r(-50.0, 50.0);
+        std::vector<Vec3<T>> ret(count);
+        for (auto& p : ret)
+            for (auto& c : p.Data) c = T((integer ? double(i(Rng)) : r(Rng))+offset);
+        return ret;
+    }
+
+    template <class T>
+    AABB<T> BruteBounds(const std::vector<Vec3<T>>& points) {
+        AABB<T> ret;
+        for (const auto& p : points) ret.Include(p);
+        return ret;
+    }
+
+    template <class T>
+    bool SameBounds(const AABB<T>& a, const AABB<T>& b) {
+        return (a.Empty() && b.Empty()) || (a.Min==b.Min && a.Max==b.Max);
+    }
+
+    template <class T, bool Moments>
+    bool SamePartial(const SIMD::ReducePartial<T>& a, const SIMD::ReducePartial<T>& b, double tolerance) {
+        auto ret = a.Count==b.Count && SameBounds(a.Bounds, b.Bounds);
+        const auto close = [&](double x, double y) { return std::abs(x-y)<=tolerance*(1.0+std::abs(y)); };
+        for (auto i = 0; Moments && i<3; ++i) ret = ret && close(a.Sum[i], b.Sum[i]);
+        for (auto i = 0; Moments && i<6; ++i) ret = ret && close(a.Outer[i], b.Outer[i]);
+        return ret;
+    }
+
+    // the dispatched kernel against the scalar one for every tail length, with and without moments
+    template <class T, bool Moments>
+    void CheckKernel(SIMD::ReduceKernel<T> kernel) {
+        auto bad = 0;
+        for (auto n = size_t(0); n<=80; n += n<20 ? 1 : 15)
+            for (const auto integer : {true, false}) {
+                if (std::is_same_v<T, int> && !integer) continue;
+                const auto points = RandomPoints<T>(n, integer);
+                const auto p = reinterpret_cast<const T*>(points.data());
+                const double shift[3] = {3.0, -7.0, 11.0};
+                SIMD::ReducePartial<T> ref, acc;
+                SIMD::ReduceScalar<T, Moments>(p, n, shift, ref);
+                kernel(p, n, shift, acc);
+                bad += !SamePartial<T, Moments>(acc, ref, integer ? 0.0 : 1e-12);
+            }
+        MATH_CHECK(bad==0);
+    }
+
+    template <class T>
+    void CheckKernels() {
+        CheckKernel<T, false>(&SIMD::ReduceScalar<T, false>);
+        CheckKernel<T, true>(&SIMD::ReduceScalar<T, true>);
+        CheckKernel<T, false>(SIMD::SelectReduce<T, false>());
+        CheckKernel<T, true>(SIMD::SelectReduce<T, true>());
+#if defined(MATH_SIMD_SSE2)
+        if (SIMD::CPU().AVX2 && SIMD::CPU().FMA) {
+            CheckKernel<T, false>(&SIMD::ReduceAVX2<T, false>);
+            CheckKernel<T, true>(&SIMD::ReduceAVX2<T, true>);
+        }
+#endif
+    }
+
+    // Bounds and Statistics against brute force, on small spans and on spans split into several chunks
+    template <class T>
+    void CheckPublic(double offset) {
+        using V = LengthType<T>;
+        for (const auto count : {size_t(0), size_t(1), size_t(9), 3*ReduceGrain+17}) {
+            const auto points = RandomPoints<T>(count, std::is_same_v<T, int>, offset);
+            const std::span<const Vec3<T>> span(points);
+            MATH_CHECK(SameBounds(Bounds(span), BruteBounds(points)));
+
+            const auto stats = Statistics(span);
+            MATH_CHECK(stats.Count==count);
+            MATH_CHECK(SameBounds(stats.Bounds, BruteBounds(points)));
+            if (!count) continue;
+            // two-pass reference in long double
+            long double mean[3]{}, cov[3][3]{};
+            for (const auto& p : points)
+                for (auto a = 0; a<3; ++a) mean[a] += p.Data[a];
+            for (auto& m : mean) m /= count;
+            for (const auto& p : points)
+                for (auto r = 0; r<3; ++r)
+                    for (auto c = 0; c<3; ++c) cov[r][c] += (p.Data[r]-mean[r])*(p.Data[c]-mean[c]);
+            const auto tolerance = std::is_same_v<V, float> ? 1e-4 : 1e-9;
+            auto bad = 0;
+            for (auto r = 0; r<3; ++r) {
+                bad += !(std::abs(double(stats.Centroid.Data[r]-mean[r]))<=tolerance*(1.0+std::abs(double(mean[r]))));
+                for (auto c = 0; c<3; ++c) {
+                    const auto expected = double(cov[r][c]/count);
+                    bad += !(std::abs(double(stats.Covariance(r, c))-expected)<=tolerance*(1.0+std::abs(expected)));
+                }
+            }
+            MATH_CHECK(bad==0);
+        }
+    }
+
+    void CheckBounds2() {
+        MATH_CHECK(Bounds(std::span<const Vec2I>()).Size()==Vec2I(0, 0));
+        MATH_CHECK(Bounds(std::span<const Vec2I>()).Echo()==Vec2I(0, 0));
+        std::uniform_int_distribution<int> d(std::numeric_limits<int>::lowest()/2, std::numeric_limits<int>::max()/2);
+        for (const auto count : {size_t(1), size_t(3), size_t(4), size_t(11), 2*ReduceGrain+5}) {
+            std::vector<Vec2I> points(count);
+            for (auto& p : points) p = Vec2I(d(Rng), d(Rng)/1000);
+            Vec2I min = points[0], max = points[0];
+            for (const auto& p : points)
+                for (auto a = 0; a<2; ++a) {
+                    min.Data[a] = std::min(min.Data[a], p.Data[a]);
+                    max.Data[a] = std::max(max.Data[a], p.Data[a]);
+                }
+            const auto rect = Bounds(std::span<const Vec2I>(points));
+            MATH_CHECK(rect.Echo()==min && rect.Size()==max-min);
+
+            Vec2I kmin = points[0], kmax = points[0];
+            SIMD::SelectBounds2()(points.data()->Data, count, kmin, kmax);
+            MATH_CHECK(kmin==min && kmax==max);
+        }
+    }
+}
+
+int main() {
+    CheckKernels<float>();
+    CheckKernels<double>();
+    CheckKernels<int>();
+    CheckPublic<float>(0.0);
+    CheckPublic<double>(0.0);
+    CheckPublic<int>(0.0);
+    // moments are taken relative to the first point, so a far cloud keeps its covariance
+    CheckPublic<float>(1e5);
+    CheckPublic<double>(1e9);
+    CheckPublic<int>(1e8);
+    CheckBounds2();
+    return Tests::Finish();
+}
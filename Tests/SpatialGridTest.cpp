@@ -0,0 +1,204 @@
+#include <random>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include "Check.h"
+#include "Math/SpatialGrid.h"
+
+using namespace Math;
+using Handle = SpatialGrid::Handle;
+using Pairs = std::vector<std::pair<Handle, Handle>>;
+
+namespace {
+    std::mt19937 Rng(20);
+
+    // a uniform spread plus a few dense clusters, so some cells hold long lists
+    std::vector<Vec3F> RandomPoints(size_t count, float extent) {
+        std::uniform_real_distribution<float> pos(-extent, extent), jitter(-0.3f, 0.3f);
+        std::vector<Vec3F> ret;
+        for (auto i = size_t(0); i<count; ++i) {
+            const Vec3F p(pos(Rng), pos(Rng), pos(Rng));
+            ret.push_back(p);
+            if (i%10==0)
+                for (auto j = 0; j<5; ++j) ret.push_back(p+Vec3F(jitter(Rng), jitter(Rng), jitter(Rng)));
+        }
+        return ret;
+    }
+
+    float DistanceSqr(const Vec3F& a, const Vec3F& b) {
+        const auto d = a-b;
+        return d.Dot(d);
+    }
+
+    // the grid's live points by handle, as the test tracks them
+    struct Model {
+        std::vector<Vec3F> Positions;
+        std::vector<uint8_t> Alive;
+
+        void Set(Handle h, const Vec3F& p) {
+            if (h>=Positions.size()) {
+                Positions.resize(h+1);
+                Alive.resize(h+1);
+            }
+            Positions[h] = p;
+            Alive[h] = 1;
+        }
+    };
+
+    Pairs Sorted(Pairs pairs) {
+        for (auto& p : pairs)
+            if (p.first>p.second) std::swap(p.first, p.second);
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    void CheckPairs(const SpatialGrid& grid, const Model& m, float radius) {
+        Pairs found, expected;
+        grid.ForEachPair(radius, [&](Handle a, Handle b) { found.emplace_back(a, b); });
+        for (auto a = Handle(0); a<m.Positions.size(); ++a)
+            for (auto b = a+1; b<m.Positions.size(); ++b)
+                if (m.Alive[a] && m.Alive[b] && DistanceSqr(m.Positions[a], m.Positions[b])<=radius*radius)
+                    expected.emplace_back(a, b);
+        // every pair once, never a point with itself
+        const auto sorted = Sorted(found);
+        MATH_CHECK(std::adjacent_find(sorted.begin(), sorted.end())==sorted.end());
+        MATH_CHECK(std::none_of(sorted.begin(), sorted.end(), [](auto p) { return p.first==p.second; }));
+        MATH_CHECK(sorted==expected);
+    }
+
+    void CheckQueries(const SpatialGrid& grid, const Model& m, float extent) {
+        std::uniform_real_distribution<float> pos(-extent, extent), size(0.0f, 4.0f);
+        auto mismatches = 0;
+        for (auto q = 0; q<50; ++q) {
+            const Vec3F center(pos(Rng), pos(Rng), pos(Rng));
+            const auto radius = size(Rng);
+            std::vector<Handle> found, expected;
+            grid.QueryRadius(center, radius, [&](Handle h, const Vec3F& p) {
+                found.push_back(h);
+                mismatches += !(p==m.Positions[h]);
+            });
+            for (auto h = Handle(0); h<m.Positions.size(); ++h)
+                if (m.Alive[h] && DistanceSqr(m.Positions[h], center)<=radius*radius) expected.push_back(h);
+            std::sort(found.begin(), found.end());
+            mismatches += found!=expected;
+
+            const AABBF box(center, center+Vec3F(size(Rng), size(Rng), size(Rng)));
+            found.clear();
+            expected.clear();
+            grid.QueryBox(box, [&](Handle h, const Vec3F&) { found.push_back(h); });
+            for (auto h = Handle(0); h<m.Positions.size(); ++h)
+                if (m.Alive[h] && box.Contains(m.Positions[h])) expected.push_back(h);
+            std::sort(found.begin(), found.end());
+            mismatches += found!=expected;
+        }
+        MATH_CHECK(mismatches==0);
+
+        auto live = size_t(0), valid = size_t(0);
+        for (auto h = Handle(0); h<m.Positions.size(); ++h) {
+            live += m.Alive[h];
+            valid += grid.Valid(h)==bool(m.Alive[h]);
+        }
+        MATH_CHECK(grid.Size()==live);
+        MATH_CHECK(valid==m.Positions.size());
+    }
+
+    // cell size below 1 and radii spanning one cell to the whole set, which switches ForEachPair to its cell scan
+    void CheckAll(const SpatialGrid& grid, const Model& m, float extent) {
+        CheckQueries(grid, m, extent);
+        for (const auto radius : {0.0f, 0.2f, 0.7f, 2.5f, 4.0f*extent}) CheckPairs(grid, m, radius);
+    }
+
+    void CheckIncremental() {
+        const auto extent = 12.0f;
+        SpatialGrid grid(0.75f);
+        Model m;
+        for (const auto& p : RandomPoints(400, extent)) m.Set(grid.Insert(p), p);
+        CheckAll(grid, m, extent);
+
+        // moves within the cell and across cells, removals, then inserts that reuse the freed handles
+        std::uniform_real_distribution<float> pos(-extent, extent), nudge(-0.01f, 0.01f);
+        for (auto h = Handle(0); h<m.Positions.size(); h += 3) {
+            const auto p = h%2 ? m.Positions[h]+Vec3F(nudge(Rng), nudge(Rng), nudge(Rng))
+                               : Vec3F(pos(Rng), pos(Rng), pos(Rng));
+            grid.Move(h, p);
+            m.Positions[h] = p;
+        }
+        for (auto h = Handle(1); h<m.Positions.size(); h += 5) {
+            grid.Remove(h);
+            m.Alive[h] = 0;
+        }
+        CheckAll(grid, m, extent);
+        const auto before = m.Positions.size();
+        auto reused = 0;
+        for (const auto& p : RandomPoints(60, extent)) {
+            const auto h = grid.Insert(p);
+            reused += h<before;
+            m.Set(h, p);
+        }
+        MATH_CHECK(reused>0);
+        CheckAll(grid, m, extent);
+
+        grid.Clear();
+        MATH_CHECK(grid.Size()==0 && grid.CellCount()==0);
+        auto any = false;
+        grid.ForEachPair(1.0f, [&](Handle, Handle) { any = true; });
+        MATH_CHECK(!any);
+    }
+
+    // Rebuild gives point i handle i and ends in the same state as inserting one by one
+    void CheckRebuild() {
+        const auto extent = 20.0f;
+        const auto points = RandomPoints(5000, extent);
+        SpatialGrid grid(1.5f), inserted(1.5f);
+        grid.Rebuild(points);
+        Model m;
+        for (auto i = size_t(0); i<points.size(); ++i) {
+            m.Set(Handle(i), points[i]);
+            inserted.Insert(points[i]);
+        }
+        MATH_CHECK(grid.CellCount()==inserted.CellCount());
+        CheckQueries(grid, m, extent);
+        CheckPairs(grid, m, 1.0f);
+
+        grid.Remove(7);
+        m.Alive[7] = 0;
+        grid.Move(8, Vec3F(100.0f, 100.0f, 100.0f));
+        m.Positions[8] = Vec3F(100.0f, 100.0f, 100.0f);
+        CheckQueries(grid, m, extent);
+    }
+
+    // coordinates past the int range saturate to the edge cells, and neighbour walks stop at the edge
+    void CheckLimits() {
+        constexpr auto max = std::numeric_limits<int>::max(), min = std::numeric_limits<int>::lowest();
+        SpatialGrid grid(1.0f);
+        MATH_CHECK(grid.Cell(Vec3F(1e10f, -1e10f, 0.5f))==Vec3I(max, min, 0));
+        MATH_CHECK(grid.Cell(Vec3F(-0.5f, INFINITY, -INFINITY))==Vec3I(-1, max, min));
+
+        const std::vector<Vec3F> points = {
+                Vec3F(3e9f, 3e9f, 3e9f), Vec3F(3e9f, 3e9f, 3e9f+256.0f), Vec3F(2.1474836e9f, 3e9f, 3e9f),
+                Vec3F(-3e9f, -3e9f, -3e9f), Vec3F(-3e9f, -3e9f, -3e9f),
+                Vec3F(-2.1474836e9f, -2.1474836e9f, -2.1474836e9f), Vec3F(0.0f, 0.0f, 0.0f),
+                Vec3F(1e20f, 0.0f, -1e20f)};
+        Model m;
+        for (auto i = size_t(0); i<points.size(); ++i) m.Set(grid.Insert(points[i]), points[i]);
+        for (const auto radius : {0.5f, 300.0f, 1e9f, 1e21f}) CheckPairs(grid, m, radius);
+
+        std::vector<Handle> found;
+        grid.QueryRadius(Vec3F(-3e9f, -3e9f, -3e9f), 1.0f, [&](Handle h, const Vec3F&) { found.push_back(h); });
+        std::sort(found.begin(), found.end());
+        MATH_CHECK((found==std::vector<Handle>{3, 4}));
+        found.clear();
+        grid.QueryBox(AABBF(Vec3F(1e9f, 1e9f, 1e9f), Vec3F(INFINITY, INFINITY, INFINITY)),
+                      [&](Handle h, const Vec3F&) { found.push_back(h); });
+        std::sort(found.begin(), found.end());
+        MATH_CHECK((found==std::vector<Handle>{0, 1, 2}));
+    }
+}
+
+int main() {
+    CheckIncremental();
+    CheckRebuild();
+    CheckLimits();
+    return Tests::Finish();
+}
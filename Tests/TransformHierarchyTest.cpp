@@ -0,0 +1,160 @@
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "Check.h"
+#include "Math/TransformHierarchy.h"
+
+using namespace Math;
+using Handle = TransformHierarchy::Handle;
+
+namespace {
+    std::mt19937 Rng(19);
+
+    // signed axis permutations with integer translations compose exactly, so the batched and scalar paths must
+    // produce identical worlds
+    Affine3F RandomLocal() {
+        int axes[3] = {0, 1, 2};
+        std::shuffle(axes, axes+3, Rng);
+        std::uniform_int_distribution<int> sign(0, 1), offset(-20, 20);
+        Affine3F ret;
+        for (auto i = 0; i<3; ++i) {
+            for (auto j = 0; j<3; ++j) ret(i, j) = j==axes[i] ? (sign(Rng) ? 1.0f : -1.0f) : 0.0f;
+            ret(i, 3) = float(offset(Rng));
+        }
+        return ret;
+    }
+
+    // the tree as the test sees it: handle -> local and parent handle
+    struct Model {
+        std::vector<Affine3F> Local;
+        std::vector<Handle> Parent;
+        std::vector<uint8_t> Alive;
+
+        void Set(Handle h, const Affine3F& local, Handle parent) {
+            if (h>=Local.size()) {
+                Local.resize(h+1);
+                Parent.resize(h+1, TransformHierarchy::None);
+                Alive.resize(h+1);
+            }
+            Local[h] = local;
+            Parent[h] = parent;
+            Alive[h] = 1;
+        }
+        bool Live(Handle h) const { return Alive[h] && (Parent[h]==TransformHierarchy::None || Live(Parent[h])); }
+        Affine3F World(Handle h) const {
+            return Parent[h]==TransformHierarchy::None ? Local[h] : World(Parent[h])*Local[h];
+        }
+    };
+
+    Handle Add(TransformHierarchy& h, Model& m, Handle parent) {
+        const auto local = RandomLocal();
+        const auto node = h.Add(local, parent);
+        m.Set(node, local, parent);
+        return node;
+    }
+
+    // worlds against the model, and the documented layout: parents before children, siblings adjacent, levels
+    // contiguous
+    void CheckAgainst(const TransformHierarchy& h, const Model& m) {
+        auto live = size_t(0);
+        auto bad = 0;
+        for (auto n = Handle(0); n<m.Local.size(); ++n) {
+            const auto expected = m.Alive[n] && m.Live(n);
+            bad += h.Valid(n)!=expected;
+            if (!expected) continue;
+            ++live;
+            bad += !(h.World(n)==m.World(n)) || !(h.Local(n)==m.Local[n]) || h.Parent(n)!=m.Parent[n];
+        }
+        MATH_CHECK(bad==0);
+        MATH_CHECK(h.Size()==live);
+
+        const auto parents = h.Parents();
+        const auto handles = h.Handles();
+        const auto starts = h.LevelStarts();
+        MATH_CHECK(!starts.empty() && starts.front()==0 && starts.back()==h.Size());
+        bad = 0;
+        for (auto l = size_t(0); l+1<starts.size(); ++l)
+            for (auto i = starts[l]; i<starts[l+1]; ++i) {
+                bad += h.Level(handles[i])!=l;
+                bad += l==0 ? parents[i]!=TransformHierarchy::None : parents[i]<starts[l-1] || parents[i]>=starts[l];
+                bad += i>starts[l] && parents[i]<parents[i-1];
+            }
+        MATH_CHECK(bad==0);
+    }
+}
+
+int main() {
+    TransformHierarchy h;
+    Model m;
+    MATH_CHECK(h.Size()==0);
+    h.Update();
+
+    // a few roots with wide first levels, so levels span several parallel chunks, then a deeper random forest
+    std::vector<Handle> nodes;
+    for (auto r = 0; r<4; ++r) {
+        const auto root = Add(h, m, TransformHierarchy::None);
+        nodes.push_back(root);
+        for (auto c = 0; c<900; ++c) nodes.push_back(Add(h, m, root));
+    }
+    for (auto i = 0; i<3000; ++i) {
+        const auto parent = i%50==0 ? TransformHierarchy::None : nodes[Rng()%nodes.size()];
+        if (parent==TransformHierarchy::None || h.Level(parent)<6) nodes.push_back(Add(h, m, parent));
+    }
+    h.Update();
+    CheckAgainst(h, m);
+
+    // an Update() with nothing changed keeps everything
+    h.Update();
+    CheckAgainst(h, m);
+
+    // sparse edits: some under unchanged parents, some whole subtrees through the batched path
+    for (auto round = 0; round<5; ++round) {
+        for (auto i = 0; i<200; ++i) {
+            const auto n = nodes[Rng()%nodes.size()];
+            const auto local = RandomLocal();
+            h.SetLocal(n, local);
+            m.Local[n] = local;
+        }
+        h.Update();
+        CheckAgainst(h, m);
+    }
+
+    // removing subtrees frees their handles for reuse; descendants go with them
+    for (auto i = 0; i<40; ++i) {
+        const auto n = nodes[Rng()%nodes.size()];
+        if (!h.Valid(n)) continue;
+        h.Remove(n);
+        m.Alive[n] = 0;
+    }
+    h.Update();
+    CheckAgainst(h, m);
+    std::erase_if(nodes, [&](Handle n) { return !h.Valid(n); });
+
+    const auto before = m.Local.size();
+    auto reused = 0;
+    for (auto i = 0; i<500; ++i) {
+        const auto node = Add(h, m, nodes[Rng()%nodes.size()]);
+        reused += node<before;
+        nodes.push_back(node);
+    }
+    MATH_CHECK(reused>0);
+    h.Update();
+    CheckAgainst(h, m);
+
+    // an edit and an add in the same Update()
+    const auto root = nodes.front();
+    const auto local = RandomLocal();
+    h.SetLocal(root, local);
+    m.Local[root] = local;
+    Add(h, m, root);
+    h.Update();
+    CheckAgainst(h, m);
+
+    // TRS overloads match the Affine3F ones
+    const auto q = QuatF::AxisAngle(Vec3F(0.0f, 0.0f, 1.0f), 0.5f);
+    const auto trs = h.Add(Vec3F(1.0f, 2.0f, 3.0f), q, Vec3F(2.0f, 2.0f, 2.0f), root);
+    h.Update();
+    MATH_CHECK(h.Local(trs)==Affine3F::FromTRS(Vec3F(1.0f, 2.0f, 3.0f), q, Vec3F(2.0f, 2.0f, 2.0f)));
+    MATH_CHECK(Affine3F(h.WorldMat4(trs))==h.World(trs));
+    return Tests::Finish();
+}
@@ -0,0 +1,97 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "Math/VoxelRay.h"
+
+using namespace Math;
+
+namespace {
+    std::mt19937 Rng(3);
+
+    Vec3F RandomVec(float lo, float hi) {
+        std::uniform_real_distribution<float> d(lo, hi);
+        return Vec3F(d(Rng), d(Rng), d(Rng));
+    }
+
+    // consecutive cells share a face, distances never decrease, and the entry point lies on the entered cell
+    template <class T>
+    void CheckWalk(const Vec3<T>& origin, const Vec3<T>& dir, T maxDistance, int& bad, int& steps) {
+        VoxelRay<T> ray(origin, dir, maxDistance);
+        auto previous = ray.Current();
+        bad += previous.Distance!=T(0) || previous.Normal!=Vec3I();
+        for (auto i = 0; i<200 && ray.Valid(); ++i, ++steps) {
+            ray.Next();
+            const auto& s = ray.Current();
+            const auto d = s.Cell-previous.Cell;
+            bad += std::abs(d.X)+std::abs(d.Y)+std::abs(d.Z)!=1 || s.Normal!=-d || s.Distance<previous.Distance;
+            if (s.Distance<std::numeric_limits<T>::infinity())
+                for (auto a = 0; a<3; ++a) {
+                    const auto p = origin.Data[a]+dir.Data[a]*s.Distance;
+                    bad += !(p>=T(s.Cell.Data[a])-T(1e-3) && p<=T(s.Cell.Data[a]+1)+T(1e-3));
+                }
+            previous = s;
+        }
+    }
+
+    void CheckScalar() {
+        auto bad = 0, steps = 0;
+        for (auto i = 0; i<200; ++i) {
+            auto d = RandomVec(-1.0f, 1.0f);
+            if (i%4==0) d.Data[i/4%3] = 0.0f;
+            CheckWalk<float>(RandomVec(-20.0f, 20.0f), d, 30.0f, bad, steps);
+            CheckWalk<double>(Vec3D(d.X*7.0f, d.Y*3.0f, d.Z), Vec3D(d.Y, d.Z, d.X), 30.0, bad, steps);
+        }
+        MATH_CHECK(steps>0);
+        MATH_CHECK(bad==0);
+
+        // along +x from a cell corner: x advances one cell per unit
+        auto x = 0;
+        for (const auto& s : VoxelRay<float>(Vec3F(0.0f, 0.5f, 0.5f), Vec3F(1.0f, 0.0f, 0.0f), 4.0f)) {
+            MATH_CHECK(s.Cell==Vec3I(x, 0, 0) && s.Distance==float(x));
+            ++x;
+        }
+        MATH_CHECK(x==5);
+    }
+
+    // the packet does the scalar float operations lane by lane, so every step matches exactly
+    void CheckPacket() {
+        auto mismatches = 0, compared = 0;
+        for (auto round = 0; round<100; ++round) {
+            std::vector<Vec3F> origins, dirs;
+            const auto used = round%7==0 ? 3 : 8;
+            for (auto i = 0; i<used; ++i) {
+                origins.push_back(RandomVec(-50.0f, 50.0f));
+                auto d = RandomVec(-1.0f, 1.0f);
+                if (i==round%8) d.Data[round%3] = 0.0f;
+                dirs.push_back(d);
+            }
+            VoxelRayPacket8 packet(origins, dirs, 25.0f);
+            std::vector<VoxelRay<float>> rays;
+            for (auto i = 0; i<used; ++i) rays.emplace_back(origins[i], dirs[i], 25.0f);
+            for (auto step = 0; step<150; ++step) {
+                VoxelStep<float> lanes[8];
+                packet.Current(lanes);
+                const auto active = packet.Active();
+                for (auto i = 0; i<8; ++i) {
+                    const auto valid = i<used && rays[i].Valid();
+                    mismatches += valid!=bool(active >> i & 1);
+                    if (!valid) continue;
+                    const auto& s = rays[i].Current();
+                    mismatches += s.Cell!=lanes[i].Cell || s.Normal!=lanes[i].Normal || s.Distance!=lanes[i].Distance;
+                    ++compared;
+                    rays[i].Next();
+                }
+                packet.Next();
+            }
+        }
+        MATH_CHECK(compared>0);
+        MATH_CHECK(mismatches==0);
+    }
+}
+
+int main() {
+    CheckScalar();
+    CheckPacket();
+    return Tests::Finish();
+}